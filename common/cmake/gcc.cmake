@@ -19,7 +19,7 @@ SET(FLAGS_SSSE3 "-mssse3")
 SET(FLAGS_SSE41 "-msse4.1")
 SET(FLAGS_SSE42 "-msse4.2")
 SET(FLAGS_AVX   "-mavx -mvzeroupper")
-SET(FLAGS_AVX2  "-mavx2 -mvzeroupper")
+SET(FLAGS_AVX2  "-mavx2 -mf16c -mvzeroupper")
 
 SET(CMAKE_CXX_COMPILER "g++")
 SET(CMAKE_C_COMPILER "gcc")
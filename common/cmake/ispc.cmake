@@ -79,7 +79,9 @@ MACRO (ispc_compile targets)
     IF (__XEON__)
       IF (${targets} MATCHES ".*,.*")
         FOREACH(target ${target_list})
-          SET(results ${results} "${outdir}/${fname}.dev_${target}.${ISPC_TARGET_EXT}")
+          # ispc names the per target objects after the ISA without the width suffix
+          STRING(REGEX REPLACE "-.*" "" isa ${target})
+          SET(results ${results} "${outdir}/${fname}.dev_${isa}.${ISPC_TARGET_EXT}")
         ENDFOREACH()
       ENDIF()
     ENDIF()
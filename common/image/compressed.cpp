@@ -0,0 +1,244 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#include "image/compressed.h"
+#include "math/vec3.h"
+
+#include <cmath>
+
+namespace embree
+{
+  /*******************************************************************
+                          Endpoint fitting
+  *******************************************************************/
+
+  /*! Fits a line segment to the colors of a block. The segment
+   *  follows the principal axis of the colors, found by power
+   *  iteration, and spans their projections onto it. */
+  static void fitEndpoints(const Vec3f p[16], Vec3f& lo, Vec3f& hi)
+  {
+    Vec3f mean(zero);
+    for (size_t i=0; i<16; i++) mean = mean + p[i];
+    mean = mean*(1.0f/16.0f);
+
+    float cxx = 0, cxy = 0, cxz = 0, cyy = 0, cyz = 0, czz = 0;
+    for (size_t i=0; i<16; i++) {
+      const Vec3f d = p[i]-mean;
+      cxx += d.x*d.x; cxy += d.x*d.y; cxz += d.x*d.z;
+      cyy += d.y*d.y; cyz += d.y*d.z; czz += d.z*d.z;
+    }
+
+    Vec3f axis(1.0f,1.0f,1.0f);
+    for (size_t k=0; k<8; k++) {
+      axis = Vec3f(cxx*axis.x+cxy*axis.y+cxz*axis.z,
+                   cxy*axis.x+cyy*axis.y+cyz*axis.z,
+                   cxz*axis.x+cyz*axis.y+czz*axis.z);
+      const float len = reduce_max(abs(axis));
+      if (len == 0.0f) { lo = hi = mean; return; }
+      axis = axis*(1.0f/len);
+    }
+    axis = normalize(axis);
+
+    float tmin = pos_inf, tmax = neg_inf;
+    for (size_t i=0; i<16; i++) {
+      const float t = dot(p[i]-mean,axis);
+      tmin = min(tmin,t); tmax = max(tmax,t);
+    }
+    lo = mean + tmin*axis;
+    hi = mean + tmax*axis;
+  }
+
+  /*! Returns the palette entry closest to some color. */
+  static size_t closest(const Vec3f& p, const Vec3f* palette, size_t n)
+  {
+    size_t best = 0; float bestDist = pos_inf;
+    for (size_t i=0; i<n; i++) {
+      const Vec3f d = p-palette[i];
+      const float dist = dot(d,d);
+      if (dist < bestDist) { bestDist = dist; best = i; }
+    }
+    return best;
+  }
+
+  /*******************************************************************
+                               BC1
+  *******************************************************************/
+
+  static __forceinline unsigned short encodeRGB565(const Vec3f& c) {
+    return (unsigned short)((int(clamp(c.x)*31.0f+0.5f) << 11) | (int(clamp(c.y)*63.0f+0.5f) << 5) | int(clamp(c.z)*31.0f+0.5f));
+  }
+
+  static __forceinline Vec3f decodeRGB565(unsigned short c) {
+    return Vec3f(float(c >> 11)*(1.0f/31.0f),float((c >> 5) & 63)*(1.0f/63.0f),float(c & 31)*(1.0f/31.0f));
+  }
+
+  Color4 BlockBC1::decodeColor(size_t i, bool threeColorMode) const
+  {
+    const Vec3f e0 = decodeRGB565(c0), e1 = decodeRGB565(c1);
+    const size_t k = (indices >> (2*i)) & 3;
+    Vec3f c;
+    if (threeColorMode && c0 <= c1) {
+      if      (k == 0) c = e0;
+      else if (k == 1) c = e1;
+      else if (k == 2) c = 0.5f*(e0+e1);
+      else return Color4(0.0f,0.0f,0.0f,0.0f);
+    }
+    else {
+      if      (k == 0) c = e0;
+      else if (k == 1) c = e1;
+      else if (k == 2) c = (2.0f/3.0f)*e0 + (1.0f/3.0f)*e1;
+      else             c = (1.0f/3.0f)*e0 + (2.0f/3.0f)*e1;
+    }
+    return Color4(c.x,c.y,c.z,1.0f);
+  }
+
+  void BlockBC1::encodeColor(const Color4 texels[16])
+  {
+    Vec3f p[16];
+    for (size_t i=0; i<16; i++) p[i] = Vec3f(clamp(texels[i].r),clamp(texels[i].g),clamp(texels[i].b));
+    Vec3f lo, hi; fitEndpoints(p,lo,hi);
+
+    c0 = encodeRGB565(hi); c1 = encodeRGB565(lo);
+    if (c0 < c1) std::swap(c0,c1);
+    const Vec3f e0 = decodeRGB565(c0), e1 = decodeRGB565(c1);
+    const Vec3f palette[4] = { e0, e1, (2.0f/3.0f)*e0 + (1.0f/3.0f)*e1, (1.0f/3.0f)*e0 + (2.0f/3.0f)*e1 };
+
+    indices = 0;
+    for (size_t i=0; i<16; i++)
+      indices |= (unsigned int)closest(p[i],palette,4) << (2*i);
+  }
+
+  /*******************************************************************
+                               BC3
+  *******************************************************************/
+
+  Color4 BlockBC3::decode(size_t i) const
+  {
+    const size_t bit = 3*i;
+    const unsigned int bits = ai[bit/8] | (bit/8+1 < 6 ? ai[bit/8+1] << 8 : 0);
+    const size_t k = (bits >> (bit%8)) & 7;
+
+    float a;
+    if      (k == 0) a = a0;
+    else if (k == 1) a = a1;
+    else if (a0 > a1) a = (float(8-k)*a0 + float(k-1)*a1)*(1.0f/7.0f);
+    else if (k < 6)   a = (float(6-k)*a0 + float(k-1)*a1)*(1.0f/5.0f);
+    else a = k == 6 ? 0.0f : 255.0f;
+
+    Color4 c = color.decodeColor(i,false);
+    c.a = a*(1.0f/255.0f);
+    return c;
+  }
+
+  void BlockBC3::encode(const Color4 texels[16])
+  {
+    color.encodeColor(texels);
+
+    float amin = pos_inf, amax = neg_inf;
+    for (size_t i=0; i<16; i++) {
+      amin = min(amin,clamp(texels[i].a));
+      amax = max(amax,clamp(texels[i].a));
+    }
+    a0 = (unsigned char)(amax*255.0f+0.5f);
+    a1 = (unsigned char)(amin*255.0f+0.5f);
+
+    /* 8 alpha values if a0 > a1, a single value otherwise */
+    unsigned long long bits = 0;
+    if (a0 > a1) {
+      float palette[8];
+      palette[0] = a0; palette[1] = a1;
+      for (size_t k=2; k<8; k++) palette[k] = (float(8-k)*a0 + float(k-1)*a1)*(1.0f/7.0f);
+      for (size_t i=0; i<16; i++) {
+        const float a = clamp(texels[i].a)*255.0f;
+        size_t best = 0;
+        for (size_t k=1; k<8; k++) if (abs(palette[k]-a) < abs(palette[best]-a)) best = k;
+        bits |= (unsigned long long)best << (3*i);
+      }
+    }
+    for (size_t i=0; i<6; i++) ai[i] = (unsigned char)(bits >> (8*i));
+  }
+
+  /*******************************************************************
+                               BCH
+  *******************************************************************/
+
+  /*! encodes a color with shared exponent, 9 bit mantissas and a 5 bit exponent */
+  static unsigned int encodeRGB9E5(const Vec3f& c)
+  {
+    const float maxValue = 65408.0f;
+    const float r = clamp(c.x,0.0f,maxValue), g = clamp(c.y,0.0f,maxValue), b = clamp(c.z,0.0f,maxValue);
+    const float maxc = max(r,max(g,b));
+    if (maxc < ldexpf(1.0f,-24)) return 0;
+
+    int e; frexpf(maxc,&e);
+    int exp = max(-16,e-1) + 16;
+    float scale = ldexpf(1.0f,exp-24);
+    if (int(maxc/scale+0.5f) == 512) { scale *= 2.0f; exp++; }
+    const unsigned int rm = min(511,int(r/scale+0.5f));
+    const unsigned int gm = min(511,int(g/scale+0.5f));
+    const unsigned int bm = min(511,int(b/scale+0.5f));
+    return rm | (gm << 9) | (bm << 18) | ((unsigned int)exp << 27);
+  }
+
+  static __forceinline Vec3f decodeRGB9E5(unsigned int v) {
+    const float scale = ldexpf(1.0f,int(v >> 27)-24);
+    return Vec3f(float(v & 511)*scale,float((v >> 9) & 511)*scale,float((v >> 18) & 511)*scale);
+  }
+
+  Color4 BlockBCH::decode(size_t i) const
+  {
+    const Vec3f c0 = decodeRGB9E5(e0), c1 = decodeRGB9E5(e1);
+    const float t = float((indices[i/8] >> (4*(i%8))) & 15)*(1.0f/15.0f);
+    const Vec3f c = (1.0f-t)*c0 + t*c1;
+    return Color4(c.x,c.y,c.z,1.0f);
+  }
+
+  void BlockBCH::encode(const Color4 texels[16])
+  {
+    Vec3f p[16];
+    for (size_t i=0; i<16; i++) p[i] = Vec3f(max(texels[i].r,0.0f),max(texels[i].g,0.0f),max(texels[i].b,0.0f));
+    Vec3f lo, hi; fitEndpoints(p,lo,hi);
+
+    e0 = encodeRGB9E5(lo); e1 = encodeRGB9E5(hi);
+    const Vec3f c0 = decodeRGB9E5(e0), c1 = decodeRGB9E5(e1);
+    const Vec3f d = c1-c0;
+    const float len2 = dot(d,d);
+
+    indices[0] = indices[1] = 0;
+    if (len2 == 0.0f) return;
+    for (size_t i=0; i<16; i++) {
+      const float t = clamp(dot(p[i]-c0,d)/len2);
+      indices[i/8] |= (unsigned int)(t*15.0f+0.5f) << (4*(i%8));
+    }
+  }
+
+  /*******************************************************************
+                             Compression
+  *******************************************************************/
+
+  Ref<Image> compressImage(const Ref<Image>& image)
+  {
+    if (dynamic_cast<Image3c*>(image.ptr)) return new ImageBC1(image);
+    if (dynamic_cast<Image4c*>(image.ptr)) {
+      for (size_t y=0; y<image->height; y++)
+        for (size_t x=0; x<image->width; x++)
+          if (image->get(x,y).a < 1.0f) return new ImageBC3(image);
+      return new ImageBC1(image);
+    }
+    return new ImageBCH(image);
+  }
+}
@@ -0,0 +1,145 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#ifndef __EMBREE_COMPRESSED_IMAGE_H__
+#define __EMBREE_COMPRESSED_IMAGE_H__
+
+#include "image/image.h"
+
+namespace embree
+{
+  /*! 4x4 texel block in BC1 layout: two RGB565 endpoints followed by
+   *  2 bit palette indices. Blocks with c0 <= c1 use a 3 color
+   *  palette plus transparent black. */
+  struct BlockBC1
+  {
+    static const char* type() { return "BC1"; }
+    Color4 decode(size_t i) const { return decodeColor(i,true); }
+    void encode(const Color4 texels[16]) { encodeColor(texels); }
+
+    /*! Decodes texel i of the block, allowing the 3 color palette if requested. */
+    Color4 decodeColor(size_t i, bool threeColorMode) const;
+
+    /*! Encodes the colors of the texels, always in 4 color mode. */
+    void encodeColor(const Color4 texels[16]);
+
+  public:
+    unsigned short c0, c1;  //!< Endpoints in RGB565 format.
+    unsigned int indices;   //!< 2 bit palette index for each texel.
+  };
+
+  /*! 4x4 texel block in BC3 layout: 8 bit alpha endpoints with 3 bit
+   *  indices followed by a BC1 color block in 4 color mode. */
+  struct BlockBC3
+  {
+    static const char* type() { return "BC3"; }
+    Color4 decode(size_t i) const;
+    void encode(const Color4 texels[16]);
+
+  public:
+    unsigned char a0, a1;   //!< Alpha endpoints.
+    unsigned char ai[6];    //!< 3 bit alpha palette index for each texel.
+    BlockBC1 color;         //!< Color part of the block.
+  };
+
+  /*! 4x4 texel block for HDR data in the spirit of BC6H: two RGB9E5
+   *  shared exponent endpoints and 4 bit indices into 16 evenly spaced
+   *  colors between them. The layout is not bitstream compatible with
+   *  BC6H, but has the same size of one byte per texel. */
+  struct BlockBCH
+  {
+    static const char* type() { return "BCH"; }
+    Color4 decode(size_t i) const;
+    void encode(const Color4 texels[16]);
+
+  public:
+    unsigned int e0, e1;       //!< Endpoints in RGB9E5 format.
+    unsigned int indices[2];   //!< 4 bit palette index for each texel.
+  };
+
+  /*! Read-only image stored as compressed 4x4 texel blocks. */
+  template<typename Block>
+    class ImageBC : public Image
+  {
+  public:
+
+    /*! create image from compressed blocks */
+    ImageBC (size_t width, size_t height, const void* data, const bool copy = true, const std::string& name = "")
+      : Image(width,height,name), blocksX((width+3)/4), blocksY((height+3)/4)
+    {
+      if (copy) {
+        blocks = (Block*) malloc(bytes());
+        memcpy(blocks,data,bytes());
+      }
+      else blocks = (Block*) data;
+    }
+
+    /*! create image by compressing another image */
+    ImageBC (const Ref<Image>& image)
+      : Image(image->width,image->height,image->name), blocksX((width+3)/4), blocksY((height+3)/4)
+    {
+      blocks = (Block*) malloc(bytes());
+      Color4 texels[16];
+      for (size_t by=0; by<blocksY; by++) {
+        for (size_t bx=0; bx<blocksX; bx++) {
+          /* border blocks replicate the last row and column */
+          for (size_t i=0; i<16; i++)
+            texels[i] = image->get(min(4*bx+(i&3),width-1),min(4*by+(i>>2),height-1));
+          blocks[by*blocksX+bx].encode(texels);
+        }
+      }
+    }
+
+    /*! image destruction */
+    virtual ~ImageBC() { if (blocks) free(blocks); }
+
+    /*! returns pointer to compressed blocks */
+    __forceinline const void* ptr() const { return blocks; }
+
+    /*! returns size of compressed blocks in bytes */
+    __forceinline size_t bytes() const { return blocksX*blocksY*sizeof(Block); }
+
+    /*! returns the type name of the compressed blocks */
+    __forceinline const char* type() const { return Block::type(); }
+
+    /*! decodes pixel */
+    __forceinline Color4 get(size_t x, size_t y) const {
+      return blocks[(y>>2)*blocksX+(x>>2)].decode(((y&3)<<2)|(x&3));
+    }
+
+    /*! compressed images are read only */
+    void set(size_t x, size_t y, const Color4& c) {
+      throw std::runtime_error("compressed images are read only");
+    }
+
+  protected:
+    Block* blocks;    //!< Compressed blocks in row major order.
+    size_t blocksX;   //!< Number of blocks per row.
+    size_t blocksY;   //!< Number of block rows.
+  };
+
+  /*! Shortcuts for compressed image types. */
+  typedef ImageBC<BlockBC1> ImageBC1;
+  typedef ImageBC<BlockBC3> ImageBC3;
+  typedef ImageBC<BlockBCH> ImageBCH;
+
+  /*! Compresses an image. 8 bit images without alpha use BC1, 8 bit
+   *  images with alpha BC3, and float images BCH. */
+  Ref<Image> compressImage(const Ref<Image>& image);
+}
+
+#endif
@@ -42,6 +42,7 @@ namespace embree
 #endif
     if (ext == "pfm" ) return loadPFM(fileName);
     if (ext == "ppm" ) return loadPPM(fileName);
+    if (ext == "tiled") return loadTiled(fileName);
     throw std::runtime_error("image format " + ext + " not supported");
   }
   catch (const std::exception& e) {
@@ -83,6 +84,7 @@ namespace embree
     if (ext == "pfm" ) { storePFM(img, fileName);  return; }
     if (ext == "ppm" ) { storePPM(img, fileName);  return; }
     if (ext == "tga" ) { storeTga(img, fileName);  return; }
+    if (ext == "tiled") { storeTiled(img, fileName);  return; }
     throw std::runtime_error("image format " + ext + " not supported");
   }
   catch (const std::exception& e) {
@@ -136,6 +136,9 @@ namespace embree
 
   /*! Loads image from TIFF file. */
 //Ref<Image> loadTIFF(const FileName& fileName);
+
+  /*! Opens tiled mip pyramid, or uncompressed PFM or PPM file, tiles are read on demand. */
+  Ref<Image> loadTiled(const FileName& fileName);
   
   /*! Store image to EXR file. */
   void storeExr(const Ref<Image>& img, const FileName& fileName);
@@ -164,4 +167,7 @@ namespace embree
   /*! Store image to TIFF file. */
 //void storeTIFF(const Ref<Image>& img, const FileName& fileName);
 
+  /*! Store image as tiled mip pyramid. */
+  void storeTiled(const Ref<Image>& img, const FileName& fileName);
+
 }
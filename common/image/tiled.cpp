@@ -0,0 +1,448 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#include "image/tiled.h"
+#include "sys/thread.h"
+#include "sys/sync/atomic.h"
+
+#include <iostream>
+#include <cstring>
+
+/*! Layout of tiled files: an 8 byte magic, the texel format (0 for
+ *  RGBA8, 1 for RGBA_FLOAT32), the tile size, the number of levels,
+ *  width and height of each level as 32 bit integers, followed by
+ *  the tiles of all levels in row major order. Tiles at the right and
+ *  bottom border are padded to the full tile size. */
+
+namespace embree
+{
+  static const char tiledMagic[8] = { 'E','M','B','T','I','L','E','D' };
+
+  /*! seeks to a 64 bit offset */
+  static void seek(FILE* file, size_t offset)
+  {
+#if defined(__WIN32__)
+    _fseeki64(file,(__int64)offset,SEEK_SET);
+#else
+    fseeko(file,(off_t)offset,SEEK_SET);
+#endif
+  }
+
+  static void write32(FILE* file, size_t v) { unsigned int i = (unsigned int)v; fwrite(&i,sizeof(i),1,file); }
+  static size_t read32(FILE* file) {
+    unsigned int i = 0;
+    if (fread(&i,sizeof(i),1,file) != 1) throw std::runtime_error("error reading tiled image header");
+    return i;
+  }
+
+  /*******************************************************************
+                           Tile Cache
+  *******************************************************************/
+
+  TileCache::TileCache ()
+    : budget(512*1024*1024) {}
+
+  TileCache& TileCache::instance()
+  {
+    static TileCache cache;
+    return cache;
+  }
+
+  void TileCache::setBudget(size_t bytes)
+  {
+    budget = bytes;
+    for (size_t i=0; i<NUM_SHARDS; i++) {
+      Lock<MutexSys> lock(shards[i].mutex);
+      evict(shards[i]);
+    }
+  }
+
+  TileCache::Shard& TileCache::shard(const void* owner, size_t index) {
+    const size_t hash = (size_t(owner) >> 4)*0x9E3779B1u + index;
+    return shards[(hash ^ (hash >> 7)) % NUM_SHARDS];
+  }
+
+  Ref<Tile> TileCache::lookup(const void* owner, size_t index)
+  {
+    Shard& s = shard(owner,index);
+    Lock<MutexSys> lock(s.mutex);
+    std::map<Key,LRUList::iterator>::iterator i = s.tiles.find(Key(owner,index));
+    if (i == s.tiles.end()) { s.misses++; return null; }
+    s.lru.splice(s.lru.begin(),s.lru,i->second);
+    s.hits++;
+    return i->second->second;
+  }
+
+  void TileCache::insert(const void* owner, size_t index, const Ref<Tile>& tile)
+  {
+    Shard& s = shard(owner,index);
+    Lock<MutexSys> lock(s.mutex);
+    const Key key(owner,index);
+    if (s.tiles.find(key) != s.tiles.end()) return; // another thread read the same tile
+    s.lru.push_front(std::make_pair(key,tile));
+    s.tiles[key] = s.lru.begin();
+    s.bytes += tile->bytes;
+    evict(s);
+  }
+
+  void TileCache::flush(const void* owner)
+  {
+    for (size_t j=0; j<NUM_SHARDS; j++)
+    {
+      Shard& s = shards[j];
+      Lock<MutexSys> lock(s.mutex);
+      for (LRUList::iterator i=s.lru.begin(); i!=s.lru.end(); ) {
+        if (i->first.first != owner) { i++; continue; }
+        s.bytes -= i->second->bytes;
+        s.tiles.erase(i->first);
+        i = s.lru.erase(i);
+      }
+    }
+  }
+
+  void TileCache::evict(Shard& s)
+  {
+    /* the most recent tile is kept even if it exceeds the budget on its own */
+    const size_t pinnedBytes = size_t(max(atomic_t(pinned),atomic_t(0)));
+    const size_t shardBudget = budget > pinnedBytes ? (budget-pinnedBytes)/NUM_SHARDS : 0;
+    while (s.bytes > shardBudget && s.lru.size() > 1) {
+      s.bytes -= s.lru.back().second->bytes;
+      s.tiles.erase(s.lru.back().first);
+      s.lru.pop_back();
+    }
+  }
+
+  void TileCache::print()
+  {
+    size_t numTiles = 0, bytes = 0, hits = 0, misses = 0;
+    for (size_t i=0; i<NUM_SHARDS; i++) {
+      Lock<MutexSys> lock(shards[i].mutex);
+      numTiles += shards[i].lru.size();
+      bytes += shards[i].bytes;
+      hits += shards[i].hits;
+      misses += shards[i].misses;
+    }
+    const size_t lookups = hits+misses;
+    std::cout << "tile cache: " << numTiles << " tiles, " << bytes/(1024*1024) << " of " << budget/(1024*1024) << " MB, "
+              << atomic_t(pinned)/(1024*1024) << " MB pinned by threads, "
+              << "hit rate " << (lookups ? 100.0*double(hits)/double(lookups) : 0.0) << "%" << std::endl;
+  }
+
+  /*******************************************************************
+                         Per Thread Tiles
+  *******************************************************************/
+
+  /*! Tiles a thread used last, found without locking. The entries
+   *  keep their tiles alive, thus they stay valid after eviction from
+   *  the shared cache. Their memory is pinned in the cache and
+   *  released when the thread exits. Files are identified by their
+   *  unique ID. */
+  struct ThreadTiles
+  {
+    enum { SIZE = 16 };
+    ThreadTiles () : bytes(0) { for (size_t i=0; i<SIZE; i++) { file[i] = 0; index[i] = 0; } }
+    ~ThreadTiles () { TileCache::instance().pin(-ssize_t(bytes)); }
+
+    /*! Replaces the tile of some entry. */
+    void set(size_t slot, size_t fileID, size_t tileIndex, const Ref<Tile>& t)
+    {
+      const size_t oldBytes = tile[slot] ? tile[slot]->bytes : 0;
+      TileCache::instance().pin(ssize_t(t->bytes)-ssize_t(oldBytes));
+      bytes += t->bytes; bytes -= oldBytes;
+      tile[slot] = t; file[slot] = fileID; index[slot] = tileIndex;
+    }
+
+  public:
+    size_t file[SIZE];     //!< ID of the file of each entry, 0 marks an empty entry.
+    size_t index[SIZE];    //!< Index of the tile of each entry.
+    Ref<Tile> tile[SIZE];  //!< Tile of each entry.
+    size_t bytes;          //!< Memory of the tiles of all entries.
+  };
+
+  static void deleteThreadTiles(void* ptr) {
+    delete (ThreadTiles*) ptr;
+  }
+
+  static tls_t threadTiles = createTls(deleteThreadTiles);
+  static Atomic nextFileID(1);
+
+  static __forceinline ThreadTiles* getThreadTiles()
+  {
+    ThreadTiles* tiles = (ThreadTiles*) getTls(threadTiles);
+    if (unlikely(!tiles)) {
+      tiles = new ThreadTiles;
+      setTls(threadTiles,tiles);
+    }
+    return tiles;
+  }
+
+  /*******************************************************************
+                           Tiled Image
+  *******************************************************************/
+
+  /*! read a single comment line starting with #, or read a space */
+  static bool readCommentLine(FILE* file)
+  {
+    int c = fgetc(file);
+    if (isspace(c)) return true;
+    if (c != '#') {
+      ungetc(c, file);
+      return false;
+    }
+    char line[1024];
+    if (fgets(line, sizeof(line), file) == NULL)
+      throw std::runtime_error("error reading raw image header");
+    return true;
+  }
+
+  TiledImage::File::File (const FileName& fileName)
+    : id(nextFileID++), fileName(fileName), file(NULL), raw(false), flipY(false), scale(1.0f)
+  {
+    file = fopen(fileName.c_str(),"rb");
+    if (!file) throw std::runtime_error("cannot open " + fileName.str());
+
+    try {
+      char magic[8];
+      if (fread(magic,sizeof(magic),1,file) == 1 && !memcmp(magic,tiledMagic,sizeof(magic))) openTiled();
+      else openRaw();
+    }
+    catch (...) {
+      fclose(file);
+      throw;
+    }
+  }
+
+  void TiledImage::File::openTiled()
+  {
+    hdr = read32(file) != 0;
+    texelBytes = hdr ? sizeof(Col4f) : sizeof(Col4c);
+    tileSize = read32(file);
+    size_t numLevels = read32(file);
+    size_t numTiles = 0;
+    for (size_t i=0; i<numLevels; i++) {
+      width.push_back(read32(file));
+      height.push_back(read32(file));
+      firstTile.push_back(numTiles);
+      numTiles += ((width[i]+tileSize-1)/tileSize)*((height[i]+tileSize-1)/tileSize);
+    }
+    dataOffset = 5*4+8*numLevels;
+  }
+
+  /*! little endian PFM files store their rows top down, 8 bit binary PPM files bottom up */
+  void TiledImage::File::openRaw()
+  {
+    rewind(file);
+    char type[8];
+    if (fscanf(file, "%7s", type) != 1)
+      throw std::runtime_error(fileName.str() + " is not a tiled image");
+    while (readCommentLine(file)) {};
+
+    int w, h; float maxColor;
+    if (fscanf(file, "%i %i %f", &w, &h, &maxColor) != 3 || w <= 0 || h <= 0)
+      throw std::runtime_error("error reading " + fileName.str());
+    fgetc(file);
+
+    if (!strcmp(type,"PF") && maxColor < 0.0f) { hdr = true; flipY = false; scale = -1.0f/maxColor; }
+    else if (!strcmp(type,"P6") && maxColor > 0.0f && maxColor <= 255.0f) { hdr = false; flipY = true; scale = 1.0f/maxColor; }
+    else throw std::runtime_error(fileName.str() + " cannot be paged");
+
+    raw = true;
+    texelBytes = hdr ? sizeof(Col4f) : sizeof(Col4c);
+    tileSize = 64;
+    width.push_back(w);
+    height.push_back(h);
+    firstTile.push_back(0);
+    dataOffset = size_t(ftell(file));
+  }
+
+  TiledImage::File::~File ()
+  {
+    TileCache::instance().flush(this);
+    if (file) fclose(file);
+  }
+
+  Ref<Tile> TiledImage::File::getTile(size_t index) const
+  {
+    Ref<Tile> tile = TileCache::instance().lookup(this,index);
+    if (tile) return tile;
+
+    const size_t tileBytes = tileSize*tileSize*texelBytes;
+    tile = new Tile(tileBytes);
+    if (raw) readRawTile(index,tile.ptr);
+    else {
+      Lock<MutexSys> lock(mutex);
+      seek(file,dataOffset+index*tileBytes);
+      if (fread(tile->data,tileBytes,1,file) != 1)
+        throw std::runtime_error("error reading tile from " + fileName.str());
+    }
+    TileCache::instance().insert(this,index,tile);
+    return tile;
+  }
+
+  /*! reads the row segments covered by a tile, texels outside the image are zero */
+  void TiledImage::File::readRawTile(size_t index, Tile* tile) const
+  {
+    const size_t tilesX = (width[0]+tileSize-1)/tileSize;
+    const size_t x0 = (index%tilesX)*tileSize, y0 = (index/tilesX)*tileSize;
+    const size_t x1 = min(x0+tileSize,width[0]), y1 = min(y0+tileSize,height[0]);
+    const size_t rawBytes = hdr ? 3*sizeof(float) : 3;
+    std::vector<char> row((x1-x0)*rawBytes);
+    memset(tile->data,0,tile->bytes);
+
+    Lock<MutexSys> lock(mutex);
+    for (size_t y=y0; y<y1; y++)
+    {
+      const size_t fy = flipY ? height[0]-1-y : y;
+      seek(file,dataOffset+(fy*width[0]+x0)*rawBytes);
+      if (fread(&row[0],row.size(),1,file) != 1)
+        throw std::runtime_error("error reading tile from " + fileName.str());
+      for (size_t x=x0; x<x1; x++) {
+        const size_t i = (y-y0)*tileSize + x-x0;
+        if (hdr) {
+          const float* rgb = (const float*)&row[(x-x0)*rawBytes];
+          Color4(rgb[0]*scale,rgb[1]*scale,rgb[2]*scale,1.0f).set(((Col4f*)tile->data)[i]);
+        } else {
+          const unsigned char* rgb = (const unsigned char*)&row[(x-x0)*rawBytes];
+          Color4(float(rgb[0])*scale,float(rgb[1])*scale,float(rgb[2])*scale,1.0f).set(((Col4c*)tile->data)[i]);
+        }
+      }
+    }
+  }
+
+  TiledImage::TiledImage (const Ref<File>& file, size_t level)
+    : Image(file->width[level],file->height[level],file->fileName), file(file), level(level) {}
+
+  Ref<Image> TiledImage::getLevel(size_t level) const {
+    return new TiledImage(file,level);
+  }
+
+  Color4 TiledImage::get(size_t x, size_t y) const
+  {
+    /*! texel fetches of a thread mostly hit its last tiles, which
+     *  are found without locking the shared cache */
+    const size_t tileSize = file->tileSize;
+    const size_t index = file->tileIndex(level,x/tileSize,y/tileSize);
+    ThreadTiles* tiles = getThreadTiles();
+    const size_t slot = (index + file->id*7) % ThreadTiles::SIZE;
+    if (tiles->file[slot] != file->id || tiles->index[slot] != index)
+      tiles->set(slot,file->id,index,file->getTile(index));
+    const Tile* tile = tiles->tile[slot].ptr;
+    const size_t i = (y%tileSize)*tileSize + x%tileSize;
+    if (file->hdr) return Color4(((Col4f*)tile->data)[i]);
+    else           return Color4(((Col4c*)tile->data)[i]);
+  }
+
+  void TiledImage::set(size_t x, size_t y, const Color4& c) {
+    throw std::runtime_error("tiled images are read only");
+  }
+
+  /*******************************************************************
+                        Loading and Storing
+  *******************************************************************/
+
+  /*! opens a tiled image or pages an uncompressed PFM or PPM file, the returned image is the finest level */
+  Ref<Image> loadTiled(const FileName& fileName) {
+    return new TiledImage(new TiledImage::File(fileName),0);
+  }
+
+  /*! stores an image as tiled mip pyramid, levels are computed by 2x2
+   *  box filtering. The finest level is read tile by tile from the
+   *  image and each coarser level from the tiles of the previous level
+   *  already written to the file, thus paged images are converted
+   *  without loading them completely. */
+  void storeTiled(const Ref<Image>& img, const FileName& fileName)
+  {
+    const size_t tileSize = 64;
+    const TiledImage* tiled = dynamic_cast<TiledImage*>(img.ptr);
+    const bool hdr = tiled ? tiled->hdr() : !dynamic_cast<Image3c*>(img.ptr) && !dynamic_cast<Image4c*>(img.ptr);
+    const size_t texelBytes = hdr ? sizeof(Col4f) : sizeof(Col4c);
+    const size_t tileBytes = tileSize*tileSize*texelBytes;
+
+    FILE* file = fopen(fileName.c_str(),"w+b");
+    if (!file) throw std::runtime_error("cannot open " + fileName.str());
+
+    /* write header */
+    std::vector<size_t> width, height, firstTile;
+    size_t numTiles = 0;
+    for (size_t w=img->width, h=img->height; ; w=max(w/2,size_t(1)), h=max(h/2,size_t(1))) {
+      width.push_back(w); height.push_back(h); firstTile.push_back(numTiles);
+      numTiles += ((w+tileSize-1)/tileSize)*((h+tileSize-1)/tileSize);
+      if (w == 1 && h == 1) break;
+    }
+    const size_t numLevels = width.size();
+    const size_t dataOffset = 5*4+8*numLevels;
+    fwrite(tiledMagic,sizeof(tiledMagic),1,file);
+    write32(file,hdr);
+    write32(file,tileSize);
+    write32(file,numLevels);
+    for (size_t i=0; i<numLevels; i++) {
+      write32(file,width[i]); write32(file,height[i]);
+    }
+
+    /* write tiles level by level */
+    std::vector<char> tile(tileBytes), prev(4*tileBytes);
+    for (size_t l=0; l<numLevels; l++)
+    {
+      const size_t tilesX = (width[l]+tileSize-1)/tileSize, tilesY = (height[l]+tileSize-1)/tileSize;
+      for (size_t ty=0; ty<tilesY; ty++) {
+        for (size_t tx=0; tx<tilesX; tx++)
+        {
+          /* read the up to 2x2 tiles of the previous level covered by this tile */
+          if (l > 0) {
+            const size_t prevTilesX = (width[l-1]+tileSize-1)/tileSize, prevTilesY = (height[l-1]+tileSize-1)/tileSize;
+            for (size_t j=0; j<2 && 2*ty+j<prevTilesY; j++) {
+              for (size_t i=0; i<2 && 2*tx+i<prevTilesX; i++) {
+                seek(file,dataOffset+(firstTile[l-1]+(2*ty+j)*prevTilesX+2*tx+i)*tileBytes);
+                if (fread(&prev[(2*j+i)*tileBytes],tileBytes,1,file) != 1) {
+                  fclose(file);
+                  throw std::runtime_error("error reading tile from " + fileName.str());
+                }
+              }
+            }
+          }
+
+          memset(&tile[0],0,tile.size());
+          for (size_t y=ty*tileSize; y<min((ty+1)*tileSize,height[l]); y++) {
+            for (size_t x=tx*tileSize; x<min((tx+1)*tileSize,width[l]); x++)
+            {
+              Color4 c;
+              if (l == 0) c = img->get(x,y);
+              else {
+                const size_t y0 = min(2*y,height[l-1]-1), y1 = min(2*y+1,height[l-1]-1);
+                const size_t x0 = min(2*x,width[l-1]-1), x1 = min(2*x+1,width[l-1]-1);
+                const size_t px[4] = { x0, x1, x0, x1 }, py[4] = { y0, y0, y1, y1 };
+                c = Color4(0.0f,0.0f,0.0f,0.0f);
+                for (size_t k=0; k<4; k++) {
+                  const size_t i = px[k]/tileSize-2*tx, j = py[k]/tileSize-2*ty;
+                  const size_t t = (2*j+i)*tileSize*tileSize + (py[k]%tileSize)*tileSize + px[k]%tileSize;
+                  const Color4 p = hdr ? Color4(((Col4f*)&prev[0])[t]) : Color4(((Col4c*)&prev[0])[t]);
+                  c = Color4(c.r+0.25f*p.r,c.g+0.25f*p.g,c.b+0.25f*p.b,c.a+0.25f*p.a);
+                }
+              }
+              const size_t i = (y-ty*tileSize)*tileSize+(x-tx*tileSize);
+              if (hdr) c.set(((Col4f*)&tile[0])[i]);
+              else     c.set(((Col4c*)&tile[0])[i]);
+            }
+          }
+          seek(file,dataOffset+(firstTile[l]+ty*tilesX+tx)*tileBytes);
+          fwrite(&tile[0],tile.size(),1,file);
+        }
+      }
+    }
+    fclose(file);
+  }
+}
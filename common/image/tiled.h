@@ -0,0 +1,172 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#ifndef __EMBREE_TILED_IMAGE_H__
+#define __EMBREE_TILED_IMAGE_H__
+
+#include "image/image.h"
+#include "sys/sync/mutex.h"
+#include "sys/sync/atomic.h"
+
+#include <cstdio>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace embree
+{
+  /*! Block of texels of a tiled image held in memory. */
+  struct Tile : public RefCount
+  {
+    Tile (size_t bytes) : data(new char[bytes]), bytes(bytes) {}
+    ~Tile () { delete[] data; }
+  public:
+    char* data;    //!< Texels of the tile.
+    size_t bytes;  //!< Size of the tile in bytes.
+  };
+
+  /*! Cache of tiles shared by all tiled images. The cache is split
+   *  into shards with their own lock, each shard evicts tiles in least
+   *  recently used order once its share of the memory budget is
+   *  exceeded. Evicted tiles stay valid as long as some lookup still
+   *  references them, tiles kept by threads outside of the cache are
+   *  reported as pinned and reduce the budget of the shards. All
+   *  methods are thread safe. */
+  class TileCache
+  {
+  public:
+
+    /*! Returns the cache shared by all tiled images. */
+    static TileCache& instance();
+
+    /*! Sets the memory budget in bytes and evicts tiles if needed. */
+    void setBudget(size_t bytes);
+
+    /*! Returns a cached tile and marks it as most recently used, or NULL on a miss. */
+    Ref<Tile> lookup(const void* owner, size_t index);
+
+    /*! Adds a tile and evicts the least recently used tiles beyond the budget. */
+    void insert(const void* owner, size_t index, const Ref<Tile>& tile);
+
+    /*! Removes all tiles of some owner. */
+    void flush(const void* owner);
+
+    /*! Accounts for tiles kept alive outside of the cache, a negative size releases them. */
+    void pin(ssize_t bytes) { pinned.add(bytes); }
+
+    /*! Returns the memory of the tiles kept alive outside of the cache. */
+    size_t pinnedBytes() const { return size_t(atomic_t(pinned)); }
+
+    /*! Prints the cache statistics. */
+    void print();
+
+  private:
+    typedef std::pair<const void*,size_t> Key;
+    typedef std::list<std::pair<Key,Ref<Tile> > > LRUList;
+
+    /*! Independently locked part of the cache. */
+    struct Shard
+    {
+      Shard () : bytes(0), hits(0), misses(0) {}
+    public:
+      MutexSys mutex;                           //!< Protects the shard.
+      LRUList lru;                              //!< Cached tiles, most recently used first.
+      std::map<Key,LRUList::iterator> tiles;    //!< Maps owner and tile index to cached tile.
+      size_t bytes;                             //!< Memory used by the cached tiles.
+      size_t hits;                              //!< Number of lookups that found their tile.
+      size_t misses;                            //!< Number of lookups that had to read their tile.
+    };
+
+    enum { NUM_SHARDS = 16 };
+
+    TileCache ();
+    Shard& shard(const void* owner, size_t index);
+    void evict(Shard& shard);
+
+  private:
+    Shard shards[NUM_SHARDS];                   //!< Shards selected by a hash of owner and tile index.
+    size_t budget;                              //!< Memory budget in bytes, shared equally by the shards.
+    Atomic pinned;                              //!< Memory of the tiles kept alive outside of the cache.
+  };
+
+  /*! Mip pyramid stored as tiles on disk. Each level of the pyramid
+   *  is accessed as a separate image, tiles are read on demand through
+   *  the tile cache. Uncompressed PFM and PPM files are paged the same
+   *  way, their tiles are cut from the rows of the file and they
+   *  provide only the finest level. */
+  class TiledImage : public Image
+  {
+  public:
+
+    /*! Open file shared by all levels of the pyramid. */
+    struct File : public RefCount
+    {
+      File (const FileName& fileName);
+      ~File ();
+
+      /*! Returns the index of a tile of some level. */
+      __forceinline size_t tileIndex(size_t level, size_t tx, size_t ty) const {
+        return firstTile[level] + ty*((width[level]+tileSize-1)/tileSize) + tx;
+      }
+
+      /*! Returns a tile of some level, reading it from disk on a cache miss. */
+      Ref<Tile> getTile(size_t index) const;
+
+    private:
+      void openTiled();
+      void openRaw();
+      void readRawTile(size_t index, Tile* tile) const;
+
+    public:
+      size_t id;                          //!< Unique ID of the file, unlike its address never reused.
+      FileName fileName;                  //!< Name of the tiled file.
+      FILE* file;                         //!< Handle of the open file.
+      mutable MutexSys mutex;             //!< Serializes reads from the file.
+      bool hdr;                           //!< Texels are stored as floats instead of 8 bit.
+      size_t texelBytes;                  //!< Size of a texel in bytes.
+      size_t tileSize;                    //!< Width and height of the tiles in texels.
+      std::vector<size_t> width;          //!< Width of each level.
+      std::vector<size_t> height;         //!< Height of each level.
+      std::vector<size_t> firstTile;      //!< Index of the first tile of each level.
+      size_t dataOffset;                  //!< Offset of the first tile in the file.
+      bool raw;                           //!< Tiles are cut from the rows of a PFM or PPM file.
+      bool flipY;                         //!< Rows of the raw file are stored bottom up.
+      float scale;                        //!< Scale of the texel values of the raw file.
+    };
+
+    /*! Construction of some level of an opened file. */
+    TiledImage (const Ref<File>& file, size_t level);
+
+    /*! Number of levels of the pyramid. */
+    size_t numLevels() const { return file->width.size(); }
+
+    /*! Texels are stored as floats instead of 8 bit. */
+    bool hdr() const { return file->hdr; }
+
+    /*! Returns some level of the pyramid. */
+    Ref<Image> getLevel(size_t level) const;
+
+    Color4 get(size_t x, size_t y) const;
+    void set(size_t x, size_t y, const Color4& c);
+
+  private:
+    Ref<File> file;   //!< File storing the pyramid.
+    size_t level;     //!< Level of the pyramid accessed by this image.
+  };
+}
+
+#endif
@@ -0,0 +1,102 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#ifndef __EMBREE_HALF_H__
+#define __EMBREE_HALF_H__
+
+#include "sys/platform.h"
+#include "sys/intrinsics.h"
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace embree
+{
+  /*! IEEE 754 half precision floating point number, stored as raw
+   *  bits. Conversions use the F16C instructions when compiled for
+   *  them and an equivalent round-to-nearest-even fallback otherwise. */
+  typedef unsigned short half;
+
+  /*! converts a float to half precision */
+  __forceinline half float_to_half(const float f)
+  {
+#if defined(__F16C__)
+    return (half) _mm_extract_epi16(_mm_cvtps_ph(_mm_set_ss(f),0),0);
+#else
+    union { float f; unsigned int u; } v; v.f = f;
+    const unsigned int sign = v.u & 0x80000000; v.u ^= sign;
+    unsigned int o;
+    if (v.u >= (143u << 23))                     // overflow, infinity, and NaN
+      o = v.u > (255u << 23) ? 0x7e00 : 0x7c00;
+    else if (v.u < (113u << 23)) {               // denormals and zero
+      union { float f; unsigned int u; } magic; magic.u = 126u << 23;
+      v.f += magic.f;
+      o = v.u - magic.u;
+    }
+    else {                                       // normalized numbers, rounded to nearest even
+      const unsigned int odd = (v.u >> 13) & 1;
+      v.u += (unsigned int)(15-127) << 23;
+      v.u += 0xfff + odd;
+      o = v.u >> 13;
+    }
+    return (half) (o | (sign >> 16));
+#endif
+  }
+
+  /*! converts a half precision number to float */
+  __forceinline float half_to_float(const half h)
+  {
+#if defined(__F16C__)
+    return _mm_cvtss_f32(_mm_cvtph_ps(_mm_cvtsi32_si128(h)));
+#else
+    union { float f; unsigned int u; } o; o.u = (unsigned int)(h & 0x7fff) << 13;
+    const unsigned int exp = o.u & (0x7c00 << 13);
+    o.u += (127-15) << 23;
+    if (exp == (0x7c00 << 13)) o.u += (128-16) << 23;   // infinity and NaN
+    else if (exp == 0) {                                // denormals and zero
+      union { float f; unsigned int u; } magic; magic.u = 113u << 23;
+      o.u += 1 << 23;
+      o.f -= magic.f;
+    }
+    o.u |= (unsigned int)(h & 0x8000) << 16;
+    return o.f;
+#endif
+  }
+
+  /*! converts 4 floats to 4 halfs */
+  __forceinline void float4_to_half4(const float* in, half* out)
+  {
+#if defined(__F16C__)
+    _mm_storel_epi64((__m128i*)out,_mm_cvtps_ph(_mm_loadu_ps(in),0));
+#else
+    for (size_t i=0; i<4; i++) out[i] = float_to_half(in[i]);
+#endif
+  }
+
+  /*! converts 4 halfs to 4 floats */
+  __forceinline void half4_to_float4(const half* in, float* out)
+  {
+#if defined(__F16C__)
+    _mm_storeu_ps(out,_mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)in)));
+#else
+    for (size_t i=0; i<4; i++) out[i] = half_to_float(in[i]);
+#endif
+  }
+}
+
+#endif
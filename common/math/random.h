@@ -76,6 +76,32 @@ namespace embree
     int state;
     int table[32];
   };
+
+  /*! Logical right shift of a scalar, the SIMD integer types provide their own. */
+  __forceinline uint32 srl(const uint32 a, const int b) { return a >> b; }
+
+  /*! Integer hash with good avalanche behaviour. Works for uint32 and
+   *  the ssei and avxi SIMD types, which hash each lane like the
+   *  scalar version. */
+  template<typename T> __forceinline const T randomHash(const T& a)
+  {
+    T x = a;
+    x = x ^ srl(x,16); x = x * T(int32(0x7feb352du));
+    x = x ^ srl(x,15); x = x * T(int32(0x846ca68bu));
+    x = x ^ srl(x,16);
+    return x;
+  }
+
+  /*! Counter based random number generator. A random number is the hash
+   *  of a key, e.g. pixel, sample, and dimension, thus no state has to
+   *  be seeded and the result does not depend on the order in which
+   *  tiles are rendered. */
+  template<typename T> __forceinline const T randomHash(const T& a, const T& b, const T& c) {
+    return randomHash(c ^ randomHash(b ^ randomHash(a)));
+  }
+
+  /*! Maps a random integer to a float in [0,1). */
+  __forceinline float randomFloat(const uint32 a) { return float(a >> 8) * (1.0f/16777216.0f); }
 }
 
 #endif
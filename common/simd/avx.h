@@ -25,12 +25,6 @@
 #include "immintrin_emu.h"
 #endif
 
-#if defined (__AVX_I__)
-#endif
-
-#if defined (__AVX2__)
-#endif
-
 namespace embree 
 {
   struct avxb;
@@ -39,7 +33,7 @@ namespace embree
 }
 
 #include "simd/avxb.h"
-#if defined (__AVX_I__)
+#if defined (__AVX_I__) || defined (__AVX2__)
 #include "simd/avxi.h"
 #else
 #include "simd/avxi_emu.h"
@@ -0,0 +1,50 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#ifndef __EMBREE_AVX512_H__
+#define __EMBREE_AVX512_H__
+
+#include "simd/avx.h"
+
+#include <immintrin.h>
+
+namespace embree 
+{
+  struct avx512b;
+  struct avx512i;
+  struct avx512f;
+}
+
+#include "simd/avx512b.h"
+#include "simd/avx512i.h"
+#include "simd/avx512f.h"
+
+namespace embree 
+{
+  typedef avx512b avx512b_t;
+  typedef avx512i avx512i_t;
+  typedef avx512f avx512f_t;
+}
+
+#define BEGIN_ITERATE_AVX512B(valid_i,id_o) { \
+  int _valid_t = movemask(valid_i);                       \
+  while (_valid_t) {                                      \
+    int id_o = __bsf(_valid_t);                            \
+    _valid_t = __btc(_valid_t,id_o);
+#define END_ITERATE_AVX512B } }
+
+#endif
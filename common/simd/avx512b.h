@@ -0,0 +1,111 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#ifndef __EMBREE_AVX512B_H__
+#define __EMBREE_AVX512B_H__
+
+namespace embree
+{
+  /*! 16-wide AVX-512 bool type. */
+  struct avx512b
+  {
+    typedef avx512b Mask;      // mask type for us
+    enum   { size = 16 };      // number of SIMD elements
+    __mmask16 v;               // data
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructors, Assignment & Cast Operators
+    ////////////////////////////////////////////////////////////////////////////////
+
+    __forceinline avx512b           () {}
+    __forceinline avx512b           ( const avx512b& a ) { v = a.v; }
+    __forceinline avx512b& operator=( const avx512b& a ) { v = a.v; return *this; }
+
+    __forceinline avx512b( const __mmask16 a ) : v(a) {}
+    __forceinline operator const __mmask16&( void ) const { return v; }
+
+    __forceinline avx512b ( bool a ) : v(a ? 0xffff : 0x0000) {}
+    __forceinline avx512b ( const avxb& a, const avxb& b ) : v((__mmask16)(movemask(a) | (movemask(b) << 8))) {}
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constants
+    ////////////////////////////////////////////////////////////////////////////////
+
+    __forceinline avx512b( FalseTy ) : v(0x0000) {}
+    __forceinline avx512b( TrueTy  ) : v(0xffff) {}
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Array Access
+    ////////////////////////////////////////////////////////////////////////////////
+
+    __forceinline bool operator []( const size_t i ) const { assert(i < 16); return (v >> i) & 1; }
+  };
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Unary Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline const avx512b operator !( const avx512b& a ) { return _mm512_knot(a); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Binary Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline const avx512b operator &( const avx512b& a, const avx512b& b ) { return _mm512_kand(a, b); }
+  __forceinline const avx512b operator |( const avx512b& a, const avx512b& b ) { return _mm512_kor (a, b); }
+  __forceinline const avx512b operator ^( const avx512b& a, const avx512b& b ) { return _mm512_kxor(a, b); }
+
+  __forceinline avx512b operator &=( avx512b& a, const avx512b& b ) { return a = a & b; }
+  __forceinline avx512b operator |=( avx512b& a, const avx512b& b ) { return a = a | b; }
+  __forceinline avx512b operator ^=( avx512b& a, const avx512b& b ) { return a = a ^ b; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Comparison Operators + Select
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline const avx512b operator !=( const avx512b& a, const avx512b& b ) { return _mm512_kxor (a, b); }
+  __forceinline const avx512b operator ==( const avx512b& a, const avx512b& b ) { return _mm512_kxnor(a, b); }
+
+  __forceinline const avx512b select( const avx512b& mask, const avx512b& t, const avx512b& f ) { 
+    return _mm512_kor(_mm512_kand(mask,t),_mm512_kandn(mask,f)); 
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Reduction Operations
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline size_t popcnt( const avx512b& a ) { return __popcnt((unsigned int)a.v); }
+  __forceinline bool reduce_and( const avx512b& a ) { return a.v == 0xffff; }
+  __forceinline bool reduce_or ( const avx512b& a ) { return a.v != 0; }
+  __forceinline bool all       ( const avx512b& a ) { return a.v == 0xffff; }
+  __forceinline bool none      ( const avx512b& a ) { return a.v == 0; }
+  __forceinline bool any       ( const avx512b& a ) { return a.v != 0; }
+
+  __forceinline size_t movemask( const avx512b& a ) { return a.v; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Output Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  inline std::ostream& operator<<(std::ostream& cout, const avx512b& a) {
+    cout << "<" << a[0];
+    for (size_t i=1; i<16; i++) cout << ", " << a[i];
+    return cout << ">";
+  }
+}
+
+#endif
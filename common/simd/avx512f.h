@@ -0,0 +1,253 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#ifndef __EMBREE_AVX512F_H__
+#define __EMBREE_AVX512F_H__
+
+namespace embree
+{
+  /*! 16-wide AVX-512 float type. */
+  struct avx512f
+  {
+    typedef avx512b Mask;    // mask type for us
+    typedef avx512i Int ;    // int type for us
+    enum   { size = 16 };    // number of SIMD elements
+    union { __m512 m512; float v[16]; }; // data
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructors, Assignment & Cast Operators
+    ////////////////////////////////////////////////////////////////////////////////
+
+    __forceinline avx512f           ( ) {}
+    __forceinline avx512f           ( const avx512f& other ) { m512 = other.m512; }
+    __forceinline avx512f& operator=( const avx512f& other ) { m512 = other.m512; return *this; }
+
+    __forceinline avx512f( const __m512  a ) : m512(a) {}
+    __forceinline operator const __m512&( void ) const { return m512; }
+    __forceinline operator       __m512&( void )       { return m512; }
+
+    __forceinline avx512f( const avxf& a, const avxf& b ) 
+      : m512(_mm512_castpd_ps(_mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(a)),_mm256_castps_pd(b),1))) {}
+
+    static __forceinline avx512f load( const void* const ptr ) { return _mm512_load_ps(ptr); }
+
+    __forceinline explicit avx512f( const char* const a ) : m512(_mm512_loadu_ps((const float*)a)) {}
+    __forceinline          avx512f( const float&       a ) : m512(_mm512_set1_ps(a)) {}
+
+    __forceinline explicit avx512f( const __m512i a ) : m512(_mm512_cvtepi32_ps(a)) {}
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constants
+    ////////////////////////////////////////////////////////////////////////////////
+
+    __forceinline avx512f( ZeroTy   ) : m512(_mm512_setzero_ps()) {}
+    __forceinline avx512f( OneTy    ) : m512(_mm512_set1_ps(1.0f)) {}
+    __forceinline avx512f( PosInfTy ) : m512(_mm512_set1_ps(pos_inf)) {}
+    __forceinline avx512f( NegInfTy ) : m512(_mm512_set1_ps(neg_inf)) {}
+    __forceinline avx512f( StepTy   ) : m512(_mm512_set_ps(15.0f,14.0f,13.0f,12.0f,11.0f,10.0f,9.0f,8.0f,7.0f,6.0f,5.0f,4.0f,3.0f,2.0f,1.0f,0.0f)) {}
+    __forceinline avx512f( NaNTy    ) : m512(_mm512_set1_ps(nan)) {}
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Array Access
+    ////////////////////////////////////////////////////////////////////////////////
+
+    __forceinline const float& operator []( const size_t i ) const { assert(i < 16); return v[i]; }
+    __forceinline       float& operator []( const size_t i )       { assert(i < 16); return v[i]; }
+  };
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Unary Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  /* AVX-512F has no logic operations on floats, thus these go through the integer domain */
+  __forceinline const avx512f operator +( const avx512f& a ) { return a; }
+  __forceinline const avx512f operator -( const avx512f& a ) { 
+    return _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(a.m512), _mm512_set1_epi32(0x80000000))); 
+  }
+  __forceinline const avx512f abs  ( const avx512f& a ) { 
+    return _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a.m512), _mm512_set1_epi32(0x7fffffff))); 
+  }
+  __forceinline const avx512f sign    ( const avx512f& a ) { return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, avx512f(zero), _CMP_NGE_UQ), avx512f(one), -avx512f(one)); }
+  __forceinline const avx512f signmsk ( const avx512f& a ) { 
+    return _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a.m512), _mm512_set1_epi32(0x80000000))); 
+  }
+
+  __forceinline const avx512f rcp  ( const avx512f& a ) { 
+    const avx512f r = _mm512_rcp14_ps(a.m512); 
+    return _mm512_sub_ps(_mm512_add_ps(r, r), _mm512_mul_ps(_mm512_mul_ps(r, r), a)); 
+  }
+  __forceinline const avx512f sqr  ( const avx512f& a ) { return _mm512_mul_ps(a,a); }
+  __forceinline const avx512f sqrt ( const avx512f& a ) { return _mm512_sqrt_ps(a.m512); }
+  __forceinline const avx512f rsqrt( const avx512f& a ) { 
+    const avx512f r = _mm512_rsqrt14_ps(a.m512);
+    return _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(1.5f), r), _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(a, _mm512_set1_ps(-0.5f)), r), _mm512_mul_ps(r, r))); 
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Binary Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline const avx512f operator +( const avx512f& a, const avx512f& b ) { return _mm512_add_ps(a.m512, b.m512); }
+  __forceinline const avx512f operator +( const avx512f& a, const float    b ) { return a + avx512f(b); }
+  __forceinline const avx512f operator +( const float    a, const avx512f& b ) { return avx512f(a) + b; }
+
+  __forceinline const avx512f operator -( const avx512f& a, const avx512f& b ) { return _mm512_sub_ps(a.m512, b.m512); }
+  __forceinline const avx512f operator -( const avx512f& a, const float    b ) { return a - avx512f(b); }
+  __forceinline const avx512f operator -( const float    a, const avx512f& b ) { return avx512f(a) - b; }
+
+  __forceinline const avx512f operator *( const avx512f& a, const avx512f& b ) { return _mm512_mul_ps(a.m512, b.m512); }
+  __forceinline const avx512f operator *( const avx512f& a, const float    b ) { return a * avx512f(b); }
+  __forceinline const avx512f operator *( const float    a, const avx512f& b ) { return avx512f(a) * b; }
+
+  __forceinline const avx512f operator /( const avx512f& a, const avx512f& b ) { return a * rcp(b); }
+  __forceinline const avx512f operator /( const avx512f& a, const float    b ) { return a * rcp(avx512f(b)); }
+  __forceinline const avx512f operator /( const float    a, const avx512f& b ) { return a * rcp(b); }
+
+  __forceinline const avx512f operator^( const avx512f& a, const avx512f& b ) { return _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(a.m512),_mm512_castps_si512(b.m512))); }
+  __forceinline const avx512f operator^( const avx512f& a, const avx512i& b ) { return _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(a.m512),b.m512)); }
+
+  __forceinline const avx512f min( const avx512f& a, const avx512f& b ) { return _mm512_min_ps(a.m512, b.m512); }
+  __forceinline const avx512f min( const avx512f& a, const float    b ) { return _mm512_min_ps(a.m512, avx512f(b)); }
+  __forceinline const avx512f min( const float    a, const avx512f& b ) { return _mm512_min_ps(avx512f(a), b.m512); }
+
+  __forceinline const avx512f max( const avx512f& a, const avx512f& b ) { return _mm512_max_ps(a.m512, b.m512); }
+  __forceinline const avx512f max( const avx512f& a, const float    b ) { return _mm512_max_ps(a.m512, avx512f(b)); }
+  __forceinline const avx512f max( const float    a, const avx512f& b ) { return _mm512_max_ps(avx512f(a), b.m512); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Ternary Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline const avx512f madd  ( const avx512f& a, const avx512f& b, const avx512f& c) { return _mm512_fmadd_ps(a,b,c); }
+  __forceinline const avx512f msub  ( const avx512f& a, const avx512f& b, const avx512f& c) { return _mm512_fmsub_ps(a,b,c); }
+  __forceinline const avx512f nmadd ( const avx512f& a, const avx512f& b, const avx512f& c) { return _mm512_fnmadd_ps(a,b,c); }
+  __forceinline const avx512f nmsub ( const avx512f& a, const avx512f& b, const avx512f& c) { return _mm512_fnmsub_ps(a,b,c); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Assignment Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline avx512f& operator +=( avx512f& a, const avx512f& b ) { return a = a + b; }
+  __forceinline avx512f& operator +=( avx512f& a, const float    b ) { return a = a + b; }
+
+  __forceinline avx512f& operator -=( avx512f& a, const avx512f& b ) { return a = a - b; }
+  __forceinline avx512f& operator -=( avx512f& a, const float    b ) { return a = a - b; }
+
+  __forceinline avx512f& operator *=( avx512f& a, const avx512f& b ) { return a = a * b; }
+  __forceinline avx512f& operator *=( avx512f& a, const float    b ) { return a = a * b; }
+
+  __forceinline avx512f& operator /=( avx512f& a, const avx512f& b ) { return a = a / b; }
+  __forceinline avx512f& operator /=( avx512f& a, const float    b ) { return a = a / b; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Comparison Operators + Select
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline const avx512b operator ==( const avx512f& a, const avx512f& b ) { return _mm512_cmp_ps_mask(a.m512, b.m512, _CMP_EQ_UQ ); }
+  __forceinline const avx512b operator ==( const avx512f& a, const float    b ) { return a == avx512f(b); }
+  __forceinline const avx512b operator ==( const float    a, const avx512f& b ) { return avx512f(a) == b; }
+
+  __forceinline const avx512b operator !=( const avx512f& a, const avx512f& b ) { return _mm512_cmp_ps_mask(a.m512, b.m512, _CMP_NEQ_UQ); }
+  __forceinline const avx512b operator !=( const avx512f& a, const float    b ) { return a != avx512f(b); }
+  __forceinline const avx512b operator !=( const float    a, const avx512f& b ) { return avx512f(a) != b; }
+
+  __forceinline const avx512b operator < ( const avx512f& a, const avx512f& b ) { return _mm512_cmp_ps_mask(a.m512, b.m512, _CMP_NGE_UQ ); }
+  __forceinline const avx512b operator < ( const avx512f& a, const float    b ) { return a <  avx512f(b); }
+  __forceinline const avx512b operator < ( const float    a, const avx512f& b ) { return avx512f(a) <  b; }
+
+  __forceinline const avx512b operator >=( const avx512f& a, const avx512f& b ) { return _mm512_cmp_ps_mask(a.m512, b.m512, _CMP_NLT_UQ); }
+  __forceinline const avx512b operator >=( const avx512f& a, const float    b ) { return a >= avx512f(b); }
+  __forceinline const avx512b operator >=( const float    a, const avx512f& b ) { return avx512f(a) >= b; }
+
+  __forceinline const avx512b operator > ( const avx512f& a, const avx512f& b ) { return _mm512_cmp_ps_mask(a.m512, b.m512, _CMP_NLE_UQ); }
+  __forceinline const avx512b operator > ( const avx512f& a, const float    b ) { return a >  avx512f(b); }
+  __forceinline const avx512b operator > ( const float    a, const avx512f& b ) { return avx512f(a) >  b; }
+
+  __forceinline const avx512b operator <=( const avx512f& a, const avx512f& b ) { return _mm512_cmp_ps_mask(a.m512, b.m512, _CMP_NGT_UQ ); }
+  __forceinline const avx512b operator <=( const avx512f& a, const float    b ) { return a <= avx512f(b); }
+  __forceinline const avx512b operator <=( const float    a, const avx512f& b ) { return avx512f(a) <= b; }
+  
+  __forceinline const avx512f select( const avx512b& mask, const avx512f& t, const avx512f& f ) { 
+    return _mm512_mask_blend_ps(mask, f, t); 
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Rounding Functions
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline const avx512f round_even( const avx512f& a ) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT); }
+  __forceinline const avx512f round_down( const avx512f& a ) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF    ); }
+  __forceinline const avx512f round_up  ( const avx512f& a ) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_POS_INF    ); }
+  __forceinline const avx512f round_zero( const avx512f& a ) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_ZERO       ); }
+  __forceinline const avx512f floor     ( const avx512f& a ) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF    ); }
+  __forceinline const avx512f ceil      ( const avx512f& a ) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_POS_INF    ); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Movement/Shifting/Shuffling Functions
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline avx512f unpacklo( const avx512f& a, const avx512f& b ) { return _mm512_unpacklo_ps(a.m512, b.m512); }
+  __forceinline avx512f unpackhi( const avx512f& a, const avx512f& b ) { return _mm512_unpackhi_ps(a.m512, b.m512); }
+
+  template<size_t i0, size_t i1, size_t i2, size_t i3> __forceinline const avx512f shuffle( const avx512f& a ) {
+    return _mm512_permute_ps(a, _MM_SHUFFLE(i3, i2, i1, i0));
+  }
+
+  template<size_t i0, size_t i1, size_t i2, size_t i3> __forceinline const avx512f shuffle( const avx512f& a, const avx512f& b ) {
+    return _mm512_shuffle_ps(a, b, _MM_SHUFFLE(i3, i2, i1, i0));
+  }
+
+  template<size_t i> __forceinline const avx512f insert (const avx512f& a, const avxf& b) { 
+    return _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castps_pd(a),_mm256_castps_pd(b),i)); 
+  }
+  template<size_t i> __forceinline const avxf    extract(const avx512f& a               ) { 
+    return _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(a),i)); 
+  }
+
+  /*! gathers 16 floats from ptr at the given element offsets */
+  __forceinline const avx512f gather(const float* ptr, const avx512i& index) { return _mm512_i32gather_ps(index, ptr, 4); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Reductions
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline float reduce_min(const avx512f& v) { return _mm512_reduce_min_ps(v); }
+  __forceinline float reduce_max(const avx512f& v) { return _mm512_reduce_max_ps(v); }
+  __forceinline float reduce_add(const avx512f& v) { return _mm512_reduce_add_ps(v); }
+
+  __forceinline const avx512f vreduce_min(const avx512f& v) { return avx512f(reduce_min(v)); }
+  __forceinline const avx512f vreduce_max(const avx512f& v) { return avx512f(reduce_max(v)); }
+  __forceinline const avx512f vreduce_add(const avx512f& v) { return avx512f(reduce_add(v)); }
+
+  __forceinline size_t select_min(const avx512f& v) { return __bsf(movemask(v == vreduce_min(v))); }
+  __forceinline size_t select_max(const avx512f& v) { return __bsf(movemask(v == vreduce_max(v))); }
+
+  __forceinline size_t select_min(const avx512b& valid, const avx512f& v) { const avx512f a = select(valid,v,avx512f(pos_inf)); return __bsf(movemask(valid & (a == vreduce_min(a)))); }
+  __forceinline size_t select_max(const avx512b& valid, const avx512f& v) { const avx512f a = select(valid,v,avx512f(neg_inf)); return __bsf(movemask(valid & (a == vreduce_max(a)))); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Output Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  inline std::ostream& operator<<(std::ostream& cout, const avx512f& a) {
+    cout << "<" << a[0];
+    for (size_t i=1; i<16; i++) cout << ", " << a[i];
+    return cout << ">";
+  }
+}
+
+#endif
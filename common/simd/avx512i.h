@@ -0,0 +1,222 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#ifndef __EMBREE_AVX512I_H__
+#define __EMBREE_AVX512I_H__
+
+namespace embree
+{
+  /*! 16-wide AVX-512 integer type. */
+  struct avx512i
+  {
+    typedef avx512b Mask;                 // mask type for us
+    enum   { size = 16 };                 // number of SIMD elements
+    union  {                              // data
+      __m512i m512; 
+      int32 v[16]; 
+    }; 
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constructors, Assignment & Cast Operators
+    ////////////////////////////////////////////////////////////////////////////////
+
+    __forceinline avx512i           ( ) {}
+    __forceinline avx512i           ( const avx512i& a ) { m512 = a.m512; }
+    __forceinline avx512i& operator=( const avx512i& a ) { m512 = a.m512; return *this; }
+
+    __forceinline avx512i( const __m512i a ) : m512(a) {}
+    __forceinline operator const __m512i&( void ) const { return m512; }
+    __forceinline operator       __m512i&( void )       { return m512; }
+
+    __forceinline avx512i( const avxi& a, const avxi& b ) : m512(_mm512_inserti64x4(_mm512_castsi256_si512(a),b,1)) {}
+
+    static __forceinline avx512i load( const void* const ptr ) { return _mm512_load_si512(ptr); }
+
+    __forceinline explicit avx512i  ( const int32* const a ) : m512(_mm512_loadu_si512(a)) {}
+    __forceinline avx512i           ( int32  a ) : m512(_mm512_set1_epi32(a)) {}
+
+    __forceinline explicit avx512i( const __m512 a ) : m512(_mm512_cvtps_epi32(a)) {}
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Constants
+    ////////////////////////////////////////////////////////////////////////////////
+
+    __forceinline avx512i( ZeroTy   ) : m512(_mm512_setzero_si512()) {}
+    __forceinline avx512i( OneTy    ) : m512(_mm512_set1_epi32(1)) {}
+    __forceinline avx512i( PosInfTy ) : m512(_mm512_set1_epi32(pos_inf)) {}
+    __forceinline avx512i( NegInfTy ) : m512(_mm512_set1_epi32(neg_inf)) {}
+    __forceinline avx512i( StepTy   ) : m512(_mm512_set_epi32(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0)) {}
+
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Array Access
+    ////////////////////////////////////////////////////////////////////////////////
+
+    __forceinline const int32& operator []( const size_t i ) const { assert(i < 16); return v[i]; }
+    __forceinline       int32& operator []( const size_t i )       { assert(i < 16); return v[i]; }
+  };
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Unary Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline const avx512i operator +( const avx512i& a ) { return a; }
+  __forceinline const avx512i operator -( const avx512i& a ) { return _mm512_sub_epi32(_mm512_setzero_si512(), a.m512); }
+  __forceinline const avx512i abs       ( const avx512i& a ) { return _mm512_abs_epi32(a.m512); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Binary Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline const avx512i operator +( const avx512i& a, const avx512i& b ) { return _mm512_add_epi32(a.m512, b.m512); }
+  __forceinline const avx512i operator +( const avx512i& a, const int32    b ) { return a + avx512i(b); }
+  __forceinline const avx512i operator +( const int32    a, const avx512i& b ) { return avx512i(a) + b; }
+
+  __forceinline const avx512i operator -( const avx512i& a, const avx512i& b ) { return _mm512_sub_epi32(a.m512, b.m512); }
+  __forceinline const avx512i operator -( const avx512i& a, const int32    b ) { return a - avx512i(b); }
+  __forceinline const avx512i operator -( const int32    a, const avx512i& b ) { return avx512i(a) - b; }
+
+  __forceinline const avx512i operator *( const avx512i& a, const avx512i& b ) { return _mm512_mullo_epi32(a.m512, b.m512); }
+  __forceinline const avx512i operator *( const avx512i& a, const int32    b ) { return a * avx512i(b); }
+  __forceinline const avx512i operator *( const int32    a, const avx512i& b ) { return avx512i(a) * b; }
+
+  __forceinline const avx512i operator &( const avx512i& a, const avx512i& b ) { return _mm512_and_epi32(a.m512, b.m512); }
+  __forceinline const avx512i operator &( const avx512i& a, const int32    b ) { return a & avx512i(b); }
+  __forceinline const avx512i operator &( const int32    a, const avx512i& b ) { return avx512i(a) & b; }
+
+  __forceinline const avx512i operator |( const avx512i& a, const avx512i& b ) { return _mm512_or_epi32(a.m512, b.m512); }
+  __forceinline const avx512i operator |( const avx512i& a, const int32    b ) { return a | avx512i(b); }
+  __forceinline const avx512i operator |( const int32    a, const avx512i& b ) { return avx512i(a) | b; }
+
+  __forceinline const avx512i operator ^( const avx512i& a, const avx512i& b ) { return _mm512_xor_epi32(a.m512, b.m512); }
+  __forceinline const avx512i operator ^( const avx512i& a, const int32    b ) { return a ^ avx512i(b); }
+  __forceinline const avx512i operator ^( const int32    a, const avx512i& b ) { return avx512i(a) ^ b; }
+
+  __forceinline const avx512i operator <<( const avx512i& a, const int32 n ) { return _mm512_slli_epi32(a.m512, n); }
+  __forceinline const avx512i operator >>( const avx512i& a, const int32 n ) { return _mm512_srai_epi32(a.m512, n); }
+
+  __forceinline const avx512i sra ( const avx512i& a, const int32 b ) { return _mm512_srai_epi32(a.m512, b); }
+  __forceinline const avx512i srl ( const avx512i& a, const int32 b ) { return _mm512_srli_epi32(a.m512, b); }
+  
+  __forceinline const avx512i min( const avx512i& a, const avx512i& b ) { return _mm512_min_epi32(a.m512, b.m512); }
+  __forceinline const avx512i min( const avx512i& a, const int32    b ) { return min(a,avx512i(b)); }
+  __forceinline const avx512i min( const int32    a, const avx512i& b ) { return min(avx512i(a),b); }
+
+  __forceinline const avx512i max( const avx512i& a, const avx512i& b ) { return _mm512_max_epi32(a.m512, b.m512); }
+  __forceinline const avx512i max( const avx512i& a, const int32    b ) { return max(a,avx512i(b)); }
+  __forceinline const avx512i max( const int32    a, const avx512i& b ) { return max(avx512i(a),b); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Assignment Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline avx512i& operator +=( avx512i& a, const avx512i& b ) { return a = a + b; }
+  __forceinline avx512i& operator +=( avx512i& a, const int32    b ) { return a = a + b; }
+  
+  __forceinline avx512i& operator -=( avx512i& a, const avx512i& b ) { return a = a - b; }
+  __forceinline avx512i& operator -=( avx512i& a, const int32    b ) { return a = a - b; }
+  
+  __forceinline avx512i& operator *=( avx512i& a, const avx512i& b ) { return a = a * b; }
+  __forceinline avx512i& operator *=( avx512i& a, const int32    b ) { return a = a * b; }
+  
+  __forceinline avx512i& operator &=( avx512i& a, const avx512i& b ) { return a = a & b; }
+  __forceinline avx512i& operator &=( avx512i& a, const int32    b ) { return a = a & b; }
+  
+  __forceinline avx512i& operator |=( avx512i& a, const avx512i& b ) { return a = a | b; }
+  __forceinline avx512i& operator |=( avx512i& a, const int32    b ) { return a = a | b; }
+  
+  __forceinline avx512i& operator <<=( avx512i& a, const int32  b ) { return a = a << b; }
+  __forceinline avx512i& operator >>=( avx512i& a, const int32  b ) { return a = a >> b; }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Comparison Operators + Select
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline const avx512b operator ==( const avx512i& a, const avx512i& b ) { return _mm512_cmpeq_epi32_mask (a.m512, b.m512); }
+  __forceinline const avx512b operator ==( const avx512i& a, const int32    b ) { return a == avx512i(b); }
+  __forceinline const avx512b operator ==( const int32    a, const avx512i& b ) { return avx512i(a) == b; }
+  
+  __forceinline const avx512b operator !=( const avx512i& a, const avx512i& b ) { return _mm512_cmpneq_epi32_mask(a.m512, b.m512); }
+  __forceinline const avx512b operator !=( const avx512i& a, const int32    b ) { return a != avx512i(b); }
+  __forceinline const avx512b operator !=( const int32    a, const avx512i& b ) { return avx512i(a) != b; }
+  
+  __forceinline const avx512b operator < ( const avx512i& a, const avx512i& b ) { return _mm512_cmplt_epi32_mask (a.m512, b.m512); }
+  __forceinline const avx512b operator < ( const avx512i& a, const int32    b ) { return a <  avx512i(b); }
+  __forceinline const avx512b operator < ( const int32    a, const avx512i& b ) { return avx512i(a) <  b; }
+  
+  __forceinline const avx512b operator >=( const avx512i& a, const avx512i& b ) { return _mm512_cmpge_epi32_mask (a.m512, b.m512); }
+  __forceinline const avx512b operator >=( const avx512i& a, const int32    b ) { return a >= avx512i(b); }
+  __forceinline const avx512b operator >=( const int32    a, const avx512i& b ) { return avx512i(a) >= b; }
+
+  __forceinline const avx512b operator > ( const avx512i& a, const avx512i& b ) { return _mm512_cmpgt_epi32_mask (a.m512, b.m512); }
+  __forceinline const avx512b operator > ( const avx512i& a, const int32    b ) { return a >  avx512i(b); }
+  __forceinline const avx512b operator > ( const int32    a, const avx512i& b ) { return avx512i(a) >  b; }
+
+  __forceinline const avx512b operator <=( const avx512i& a, const avx512i& b ) { return _mm512_cmple_epi32_mask (a.m512, b.m512); }
+  __forceinline const avx512b operator <=( const avx512i& a, const int32    b ) { return a <= avx512i(b); }
+  __forceinline const avx512b operator <=( const int32    a, const avx512i& b ) { return avx512i(a) <= b; }
+
+  __forceinline const avx512i select( const avx512b& m, const avx512i& t, const avx512i& f ) { 
+    return _mm512_mask_blend_epi32(m, f, t); 
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Movement/Shifting/Shuffling Functions
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline avx512i unpacklo( const avx512i& a, const avx512i& b ) { return _mm512_unpacklo_epi32(a.m512, b.m512); }
+  __forceinline avx512i unpackhi( const avx512i& a, const avx512i& b ) { return _mm512_unpackhi_epi32(a.m512, b.m512); }
+
+  template<size_t i0, size_t i1, size_t i2, size_t i3> __forceinline const avx512i shuffle( const avx512i& a ) {
+    return _mm512_shuffle_epi32(a, (_MM_PERM_ENUM)_MM_SHUFFLE(i3, i2, i1, i0));
+  }
+
+  template<size_t i> __forceinline const avx512i insert (const avx512i& a, const avxi& b) { return _mm512_inserti64x4 (a,b,i); }
+  template<size_t i> __forceinline const avxi    extract(const avx512i& a               ) { return _mm512_extracti64x4_epi64(a,i); }
+
+  /*! gathers 16 integers from ptr at the given element offsets */
+  __forceinline const avx512i gather(const int* ptr, const avx512i& index) { return _mm512_i32gather_epi32(index, ptr, 4); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Reductions
+  ////////////////////////////////////////////////////////////////////////////////
+
+  __forceinline int reduce_min(const avx512i& v) { return _mm512_reduce_min_epi32(v); }
+  __forceinline int reduce_max(const avx512i& v) { return _mm512_reduce_max_epi32(v); }
+  __forceinline int reduce_add(const avx512i& v) { return _mm512_reduce_add_epi32(v); }
+
+  __forceinline const avx512i vreduce_min(const avx512i& v) { return avx512i(reduce_min(v)); }
+  __forceinline const avx512i vreduce_max(const avx512i& v) { return avx512i(reduce_max(v)); }
+  __forceinline const avx512i vreduce_add(const avx512i& v) { return avx512i(reduce_add(v)); }
+
+  __forceinline size_t select_min(const avx512i& v) { return __bsf(movemask(v == vreduce_min(v))); }
+  __forceinline size_t select_max(const avx512i& v) { return __bsf(movemask(v == vreduce_max(v))); }
+
+  __forceinline size_t select_min(const avx512b& valid, const avx512i& v) { const avx512i a = select(valid,v,avx512i(pos_inf)); return __bsf(movemask(valid & (a == vreduce_min(a)))); }
+  __forceinline size_t select_max(const avx512b& valid, const avx512i& v) { const avx512i a = select(valid,v,avx512i(neg_inf)); return __bsf(movemask(valid & (a == vreduce_max(a)))); }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Output Operators
+  ////////////////////////////////////////////////////////////////////////////////
+
+  inline std::ostream& operator<<(std::ostream& cout, const avx512i& a) {
+    cout << "<" << a[0];
+    for (size_t i=1; i<16; i++) cout << ", " << a[i];
+    return cout << ">";
+  }
+}
+
+#endif
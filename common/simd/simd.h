@@ -38,6 +38,37 @@
 #include "simd/mic.h"
 #endif
 
+/* include AVX-512 wrapper classes */
+#if defined(__AVX512F__) && !defined(__MIC__)
+#include "simd/avx512.h"
+#endif
+
+/* widest SIMD types of the target, used for packetized shading */
+namespace embree
+{
+#if defined(__MIC__)
+  typedef mic_m simdb;
+  typedef mic_i simdi;
+  typedef mic_f simdf;
+#define SIMD_WIDTH 16
+#elif defined(__AVX512F__)
+  typedef avx512b simdb;
+  typedef avx512i simdi;
+  typedef avx512f simdf;
+#define SIMD_WIDTH 16
+#elif defined(__AVX__)
+  typedef avxb simdb;
+  typedef avxi simdi;
+  typedef avxf simdf;
+#define SIMD_WIDTH 8
+#elif defined(__SSE__)
+  typedef sseb simdb;
+  typedef ssei simdi;
+  typedef ssef simdf;
+#define SIMD_WIDTH 4
+#endif
+}
+
 #if defined (__AVX__)
 #define AVX_ZERO_UPPER() _mm256_zeroupper()
 #else
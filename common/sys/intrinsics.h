@@ -116,6 +116,14 @@ __forceinline int64 atomic_cmpxchg(volatile int64* m, const int64 v, const int64
   return _InterlockedCompareExchange64(m,v,c);
 }
 
+__forceinline int32 atomic_add(volatile int32* p, const int32 v) {
+  return _InterlockedExchangeAdd((volatile long*)p,v);
+}
+
+__forceinline int32 atomic_cmpxchg(volatile int32* p, const int32 v, const int32 c) {
+  return _InterlockedCompareExchange((volatile long*)p,v,c);
+}
+
 #else
 
 typedef int32 atomic_t;
@@ -216,6 +224,14 @@ __forceinline int64 atomic_cmpxchg( int64 volatile* value, const int64 input, in
   return __sync_val_compare_and_swap(value, comparand, input);
 }
 
+__forceinline int32 atomic_add( int32 volatile* value, int32 input ) {
+  return __sync_fetch_and_add(value, input);
+}
+
+__forceinline int32 atomic_cmpxchg( int32 volatile* value, const int32 input, int32 comparand ) {
+  return __sync_val_compare_and_swap(value, comparand, input);
+}
+
 #else
 
 typedef int32 atomic_t;
@@ -279,6 +295,19 @@ __forceinline float cast_i2f(int i) {
   union { float f; int i; } v; v.i = i; return v.f;
 }
 
+/* atomic operations on floats through the int32 atomic_cmpxchg that every platform branch above provides */
+__forceinline void atomic_add_float(volatile float* p, const float v) {
+  int32 o; do { o = cast_f2i(*p); } while (atomic_cmpxchg((volatile int32*)p,cast_f2i(cast_i2f(o)+v),o) != o);
+}
+
+__forceinline void atomic_min_float(volatile float* p, const float v) {
+  int32 o; do { o = cast_f2i(*p); if (cast_i2f(o) <= v) return; } while (atomic_cmpxchg((volatile int32*)p,cast_f2i(v),o) != o);
+}
+
+__forceinline void atomic_max_float(volatile float* p, const float v) {
+  int32 o; do { o = cast_f2i(*p); if (cast_i2f(o) >= v) return; } while (atomic_cmpxchg((volatile int32*)p,cast_f2i(v),o) != o);
+}
+
 #if defined(__MIC__)
 __forceinline void __pause (const int cycles = 16) { _mm_delay_32(cycles); }
 #else
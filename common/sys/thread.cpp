@@ -127,23 +127,24 @@ namespace embree
   }
 
   /*! creates thread local storage */
-  tls_t createTls() {
-    return tls_t(TlsAlloc());
+  tls_t createTls(void (*destructor)(void*)) {
+    /* fiber local storage calls the destructor at thread exit */
+    return tls_t(FlsAlloc((PFLS_CALLBACK_FUNCTION)destructor));
   }
 
   /*! set the thread local storage pointer */
   void setTls(tls_t tls, void* const ptr) {
-    TlsSetValue(DWORD(size_t(tls)), ptr);
+    FlsSetValue(DWORD(size_t(tls)), ptr);
   }
 
   /*! return the thread local storage pointer */
   void* getTls(tls_t tls) {
-    return TlsGetValue(DWORD(size_t(tls)));
+    return FlsGetValue(DWORD(size_t(tls)));
   }
 
   /*! destroys thread local storage identifier */
   void destroyTls(tls_t tls) {
-    TlsFree(DWORD(size_t(tls)));
+    FlsFree(DWORD(size_t(tls)));
   }
 #endif
 }
@@ -285,9 +286,9 @@ namespace embree
   }
 
   /*! creates thread local storage */
-  tls_t createTls() {
+  tls_t createTls(void (*destructor)(void*)) {
     pthread_key_t* key = new pthread_key_t;
-    if (pthread_key_create(key,NULL) != 0)
+    if (pthread_key_create(key,destructor) != 0)
       throw std::runtime_error("pthread_key_create");
 
     return tls_t(key);
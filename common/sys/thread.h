@@ -45,8 +45,9 @@ namespace embree
   /*! type for handle to thread local storage */
   typedef struct opaque_tls_t* tls_t;
 
-  /*! creates thread local storage */
-  tls_t createTls();
+  /*! creates thread local storage, the optional destructor is called
+   *  with the pointer a thread has set when the thread exits */
+  tls_t createTls(void (*destructor)(void*) = NULL);
 
   /*! set the thread local storage pointer */
   void setTls(tls_t tls, void* const ptr);
@@ -34,6 +34,18 @@ namespace embree
     return dev;
   }
 
+  void Device::rtNewShapePrimitives(size_t num, const RTShape* shapes, const RTMaterial* materials, const float* transforms, RTPrimitive* prims)
+  {
+    for (size_t i=0; i<num; i++)
+      prims[i] = rtNewShapePrimitive(shapes[i], materials[i], transforms ? transforms+12*i : NULL);
+  }
+
+  void Device::rtSetPrimitives(RTScene scene, size_t slot, size_t num, const RTPrimitive* prims)
+  {
+    for (size_t i=0; i<num; i++)
+      rtSetPrimitive(scene, slot+i, prims[i]);
+  }
+
   Device* Device::rtCreateDevice(const char* type, size_t numThreads, const char* rtcore_cfg)
   {
     if      (!strcmp(type,"default"      )) return rtCreateDeviceHelper("device_singleray","",numThreads,rtcore_cfg);
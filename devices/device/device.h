@@ -182,6 +182,13 @@ namespace embree
      *  handle */
     virtual RTPrimitive rtNewShapePrimitive(RTShape shape, RTMaterial material, const float* transform = NULL) = 0;
 
+    /*! Creates many shape primitives in a single call. \param num
+     *  is the number of primitives to create \param shapes and
+     *  \param materials point to num shapes and materials \param
+     *  transforms is an optional pointer to num transformations of 12
+     *  floats each \param prims receives the num primitive handles */
+    virtual void rtNewShapePrimitives(size_t num, const RTShape* shapes, const RTMaterial* materials, const float* transforms, RTPrimitive* prims);
+
     /*! Creates a new light primitive. \param light is the light to
      *  instantiate \param transform is an optional pointer to a
      *  transformation to transform the shape \returns primitive
@@ -201,6 +208,10 @@ namespace embree
         deleted by adding NULL to a primitive slot. */
     virtual void rtSetPrimitive(RTScene scene, size_t slot, RTPrimitive prim) = 0;
 
+    /*! Sets num consecutive primitive slots of the scene, starting at
+     *  slot, in a single call. */
+    virtual void rtSetPrimitives(RTScene scene, size_t slot, size_t num, const RTPrimitive* prims);
+
     /*! Creates a new tonemapper. \returns tonemapper handle. */
     virtual RTToneMapper rtNewToneMapper(const char* type) = 0;
 
@@ -218,8 +229,13 @@ namespace embree
     virtual RTFrameBuffer rtNewFrameBuffer(const char* type, size_t width, size_t height, size_t buffers = 1, void** ptrs = NULL) = 0;
 
     /*! Map the framebuffer data. \param frameBuffer is the framebuffer
-     *  to map \returns pointer to framebuffer data */
-    virtual void* rtMapFrameBuffer(RTFrameBuffer frameBuffer, int bufID = -1) = 0;
+     *  to map \param bufID is the buffer of the swapchain to map
+     *  \param channel selects the color ("color") or an auxiliary
+     *  channel ("albedo", "normal", "depth", "primid", "direct",
+     *  "indirect") enabled by the "aovs" renderer parameter. Auxiliary
+     *  channels contain 3 floats per pixel, depth a float, and primid
+     *  an int per pixel. \returns pointer to framebuffer data */
+    virtual void* rtMapFrameBuffer(RTFrameBuffer frameBuffer, int bufID = -1, const char* channel = "color") = 0;
 
     /*! Unmap the framebuffer data. \param frameBuffer is the
      *  framebuffer to unmap. */
@@ -306,7 +322,11 @@ namespace embree
     /*! Renders a frame. \param renderer is the renderer to use \param
      *  camera is the camera to use \param scene is the scene to
      *  render \param tonemapper is the tonemapper to use \parm
-     *  frameBuffer is the framebuffer to render into */
+     *  frameBuffer is the framebuffer to render into \param
+     *  accumulate is 0 to restart accumulation, 1 to accumulate into
+     *  the previous frames, and 2 to restart from the previous frame
+     *  reprojected into the new camera, which devices without support
+     *  for reprojection treat like 0 */
     virtual void rtRenderFrame(RTRenderer renderer, RTCamera camera, RTScene scene, RTToneMapper tonemapper, RTFrameBuffer frameBuffer, int accumulate) = 0;
 
     /*! Pick a 3D point. \returns true if a point was picked, false otherwise
@@ -16,6 +16,7 @@
 
 #include "loaders.h"
 #include "sys/stl/string.h"
+#include "image/compressed.h"
 #include <map>
 
 namespace embree
@@ -23,6 +24,9 @@ namespace embree
   std::string g_mesh_accel = "default";
   std::string g_mesh_builder = "default";
   std::string g_mesh_traverser = "default";
+  bool g_compress_textures = false;
+  bool g_compact_meshes = false;
+  bool g_optimize_meshes = false;
 
   static std::map<std::string, Handle<Device::RTImage> >* image_map = NULL;
 
@@ -42,6 +46,18 @@ namespace embree
     image_map = NULL;
   }
 
+  /*! Loads an image locally and passes it to the device in compressed form. */
+  static Handle<Device::RTImage> rtLoadCompressedImage(const FileName &fileName) 
+  {
+    Ref<Image> image = loadImage(fileName);
+    if (!image) return rtLoadImage(fileName);
+    image = compressImage(image);
+    if (Ref<ImageBC1> img = image.dynamicCast<ImageBC1>()) return g_device->rtNewImage(img->type(),img->width,img->height,img->ptr(),true);
+    if (Ref<ImageBC3> img = image.dynamicCast<ImageBC3>()) return g_device->rtNewImage(img->type(),img->width,img->height,img->ptr(),true);
+    if (Ref<ImageBCH> img = image.dynamicCast<ImageBCH>()) return g_device->rtNewImage(img->type(),img->width,img->height,img->ptr(),true);
+    return rtLoadImage(fileName);
+  }
+
   static std::map<std::string, Handle<Device::RTTexture> >* texture_map = NULL;
 
   Handle<Device::RTTexture> rtLoadTexture(const FileName &fileName) 
@@ -52,8 +68,8 @@ namespace embree
     if (texture_map->find(fileName.str()) != texture_map->end()) 
       return((*texture_map)[fileName.str()]);
     
-    Handle<Device::RTTexture> texture = g_device->rtNewTexture("nearest");
-    g_device->rtSetImage(texture, "image", rtLoadImage(fileName));
+    Handle<Device::RTTexture> texture = g_device->rtNewTexture("image");
+    g_device->rtSetImage(texture, "image", g_compress_textures ? rtLoadCompressedImage(fileName) : rtLoadImage(fileName));
     g_device->rtCommit(texture);
     
     return((*texture_map)[fileName.str()] = texture);
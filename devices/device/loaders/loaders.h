@@ -25,6 +25,9 @@ namespace embree
   extern std::string g_mesh_accel;
   extern std::string g_mesh_builder;
   extern std::string g_mesh_traverser;
+  extern bool g_compress_textures;
+  extern bool g_compact_meshes;
+  extern bool g_optimize_meshes;
 
   Handle<Device::RTImage> rtLoadImage  (const FileName& fileName);
   void rtClearImageCache();
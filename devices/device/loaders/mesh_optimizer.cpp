@@ -0,0 +1,138 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+
+namespace embree
+{
+  /*! orders vertices lexicographically by their attributes */
+  struct VertexCompare
+  {
+    VertexCompare (const std::vector<float>& keys, size_t stride)
+      : keys(keys), stride(stride) {}
+
+    bool operator() (uint32 a, uint32 b) const {
+      const int c = memcmp(&keys[a*stride],&keys[b*stride],stride*sizeof(float));
+      return c != 0 ? c < 0 : a < b;
+    }
+
+    const std::vector<float>& keys;
+    size_t stride;
+  };
+
+  /*! spreads the lower 10 bits of x to every third bit */
+  static __forceinline uint32 spreadBits(uint32 x)
+  {
+    x &= 0x3ff;
+    x = (x | (x << 16)) & 0x030000ff;
+    x = (x | (x <<  8)) & 0x0300f00f;
+    x = (x | (x <<  4)) & 0x030c30c3;
+    x = (x | (x <<  2)) & 0x09249249;
+    return x;
+  }
+
+  /*! reorders a per vertex array, dst[i] = src[order[i]] */
+  template<typename T> 
+  static void reorder(std::vector<T>& array, const std::vector<uint32>& order)
+  {
+    if (array.empty()) return;
+    std::vector<T> result(order.size());
+    for (size_t i=0; i<order.size(); i++) result[i] = array[order[i]];
+    array.swap(result);
+  }
+
+  void optimizeMesh(std::vector<Vec3f>& positions, std::vector<Vec3f>& motions, std::vector<Vec3f>& normals, 
+                    std::vector<Vec2f>& texcoords, std::vector<Vec3i>& triangles)
+  {
+    const size_t numVertices = positions.size();
+    if (numVertices == 0 || triangles.empty()) return;
+    if (motions.size()   && motions.size()   != numVertices) throw std::runtime_error("number of motions does not match number of positions");
+    if (normals.size()   && normals.size()   != numVertices) throw std::runtime_error("number of normals does not match number of positions");
+    if (texcoords.size() && texcoords.size() != numVertices) throw std::runtime_error("number of texcoords does not match number of positions");
+    for (size_t i=0; i<triangles.size(); i++) {
+      const Vec3i& tri = triangles[i];
+      if (tri.x < 0 || tri.y < 0 || tri.z < 0 || size_t(tri.x) >= numVertices || size_t(tri.y) >= numVertices || size_t(tri.z) >= numVertices)
+        throw std::runtime_error("invalid vertex index");
+    }
+
+    /*! merge vertices with identical attributes */
+    const size_t stride = 3 + (motions.size() ? 3 : 0) + (normals.size() ? 3 : 0) + (texcoords.size() ? 2 : 0);
+    std::vector<float> keys(numVertices*stride);
+    for (size_t i=0; i<numVertices; i++) {
+      float* key = &keys[i*stride];
+      *key++ = positions[i].x; *key++ = positions[i].y; *key++ = positions[i].z;
+      if (motions.size())   { *key++ = motions[i].x; *key++ = motions[i].y; *key++ = motions[i].z; }
+      if (normals.size())   { *key++ = normals[i].x; *key++ = normals[i].y; *key++ = normals[i].z; }
+      if (texcoords.size()) { *key++ = texcoords[i].x; *key++ = texcoords[i].y; }
+    }
+    std::vector<uint32> sorted(numVertices);
+    for (size_t i=0; i<numVertices; i++) sorted[i] = (uint32) i;
+    std::sort(sorted.begin(),sorted.end(),VertexCompare(keys,stride));
+    std::vector<uint32> unique(numVertices);
+    for (size_t i=0, first=0; i<numVertices; i++) {
+      if (memcmp(&keys[sorted[first]*stride],&keys[sorted[i]*stride],stride*sizeof(float))) first = i;
+      unique[sorted[i]] = sorted[first];
+    }
+    for (size_t i=0; i<triangles.size(); i++) {
+      triangles[i].x = unique[triangles[i].x];
+      triangles[i].y = unique[triangles[i].y];
+      triangles[i].z = unique[triangles[i].z];
+    }
+
+    /*! sort triangles along a Morton curve through their centroids */
+    Vec3f lower(pos_inf), upper(neg_inf);
+    for (size_t i=0; i<triangles.size(); i++) {
+      const Vec3i& tri = triangles[i];
+      const Vec3f c = (positions[tri.x]+positions[tri.y]+positions[tri.z])*(1.0f/3.0f);
+      lower = min(lower,c);
+      upper = max(upper,c);
+    }
+    const Vec3f extent = upper-lower;
+    const Vec3f scale(extent.x > 0.0f ? 1023.0f/extent.x : 0.0f,
+                      extent.y > 0.0f ? 1023.0f/extent.y : 0.0f,
+                      extent.z > 0.0f ? 1023.0f/extent.z : 0.0f);
+    std::vector<std::pair<uint32,uint32> > codes(triangles.size());
+    for (size_t i=0; i<triangles.size(); i++) {
+      const Vec3i& tri = triangles[i];
+      const Vec3f c = ((positions[tri.x]+positions[tri.y]+positions[tri.z])*(1.0f/3.0f)-lower)*scale;
+      const uint32 code = spreadBits(uint32(c.x)) | (spreadBits(uint32(c.y)) << 1) | (spreadBits(uint32(c.z)) << 2);
+      codes[i] = std::make_pair(code,(uint32)i);
+    }
+    std::sort(codes.begin(),codes.end());
+    std::vector<Vec3i> sortedTriangles(triangles.size());
+    for (size_t i=0; i<codes.size(); i++) sortedTriangles[i] = triangles[codes[i].second];
+    triangles.swap(sortedTriangles);
+
+    /*! renumber vertices in order of first use */
+    std::vector<int> remap(numVertices,-1);
+    std::vector<uint32> order; order.reserve(numVertices);
+    for (size_t i=0; i<triangles.size(); i++) {
+      int* v = &triangles[i][0];
+      for (size_t k=0; k<3; k++) {
+        if (remap[v[k]] < 0) { remap[v[k]] = (int) order.size(); order.push_back(v[k]); }
+        v[k] = remap[v[k]];
+      }
+    }
+    reorder(positions,order);
+    reorder(motions,order);
+    reorder(normals,order);
+    reorder(texcoords,order);
+  }
+}
@@ -0,0 +1,35 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#ifndef __EMBREE_MESH_OPTIMIZER_H__
+#define __EMBREE_MESH_OPTIMIZER_H__
+
+#include <vector>
+#include "math/vec2.h"
+#include "math/vec3.h"
+
+namespace embree
+{
+  /*! Improves the memory locality of a triangle mesh. Merges vertices
+   *  with identical attributes, sorts the triangles along a Morton
+   *  curve through their centroids, and renumbers the vertices in
+   *  order of first use. Unreferenced vertices are dropped. The
+   *  optional arrays have to be empty or of the size of the positions. */
+  void optimizeMesh(std::vector<Vec3f>& positions, std::vector<Vec3f>& motions, std::vector<Vec3f>& normals, 
+                    std::vector<Vec2f>& texcoords, std::vector<Vec3i>& triangles);
+}
+
+#endif
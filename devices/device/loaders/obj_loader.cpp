@@ -18,6 +18,7 @@
 #include "math/vec2.h"
 #include "math/vec3.h"
 #include "loaders.h"
+#include "mesh_optimizer.h"
 
 #include <fstream>
 #include <iostream>
@@ -356,6 +357,12 @@ namespace embree
     }
     curGroup.clear();
 
+    /* improve memory locality of the mesh */
+    if (g_optimize_meshes) {
+      std::vector<Vec3f> motions;
+      optimizeMesh(positions, motions, normals, texcoords, triangles);
+    }
+
     Handle<Device::RTData> dataPositions = g_device->rtNewData("immutable", positions.size() * sizeof(Vec3f), (positions.size() ? &positions[0] : NULL));
     Handle<Device::RTData> dataTriangles = g_device->rtNewData("immutable", triangles.size() * sizeof(Vec3i), (triangles.size() ? &triangles[0] : NULL));
 
@@ -374,6 +381,7 @@ namespace embree
     g_device->rtSetString(mesh,"accel",g_mesh_accel.c_str());
     g_device->rtSetString(mesh,"builder",g_mesh_builder.c_str());
     g_device->rtSetString(mesh,"traverser",g_mesh_traverser.c_str());
+    if (g_compact_meshes) g_device->rtSetInt1(mesh,"compact",1);
 
     g_device->rtCommit(mesh);
     model.push_back(g_device->rtNewShapePrimitive(mesh, curMaterial, NULL));
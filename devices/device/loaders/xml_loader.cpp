@@ -15,6 +15,7 @@
 // ======================================================================== //
 
 #include "loaders.h"
+#include "mesh_optimizer.h"
 #include "xml_parser.h"
 #include "obj_loader.h"
 #include "image/image.h"
@@ -590,11 +591,35 @@ namespace embree
   {
     std::string materialName;
     Handle<Device::RTMaterial> material = loadMaterial(xml->child("material"),&materialName);
-    size_t numPositions = 0;  Handle<Device::RTData> positions = loadVec3fArray(xml->childOpt("positions"), numPositions);
-    size_t numMotions   = 0;  Handle<Device::RTData> motions   = loadVec3fArray(xml->childOpt("motions"  ), numMotions);
-    size_t numNormals   = 0;  Handle<Device::RTData> normals   = loadVec3fArray(xml->childOpt("normals"  ), numNormals);
-    size_t numTexCoords = 0;  Handle<Device::RTData> texcoords = loadVec2fArray(xml->childOpt("texcoords"), numTexCoords);
-    size_t numTriangles = 0;  Handle<Device::RTData> triangles = loadVector3iArray(xml->childOpt("triangles"), numTriangles);
+    size_t numPositions = 0;  Handle<Device::RTData> positions;
+    size_t numMotions   = 0;  Handle<Device::RTData> motions;
+    size_t numNormals   = 0;  Handle<Device::RTData> normals;
+    size_t numTexCoords = 0;  Handle<Device::RTData> texcoords;
+    size_t numTriangles = 0;  Handle<Device::RTData> triangles;
+
+    /*! improve memory locality of the mesh before passing the arrays to the device */
+    if (g_optimize_meshes) 
+    {
+      std::vector<Vec3f> positions2 = loadVec3fArray(xml->childOpt("positions"));
+      std::vector<Vec3f> motions2   = loadVec3fArray(xml->childOpt("motions"  ));
+      std::vector<Vec3f> normals2   = loadVec3fArray(xml->childOpt("normals"  ));
+      std::vector<Vec2f> texcoords2 = loadVec2fArray(xml->childOpt("texcoords"));
+      std::vector<Vec3i> triangles2 = loadVector3iArray(xml->childOpt("triangles"));
+      optimizeMesh(positions2,motions2,normals2,texcoords2,triangles2);
+      if ((numPositions = positions2.size())) positions = g_device->rtNewData("immutable",numPositions*sizeof(Vec3f),&positions2[0]);
+      if ((numMotions   = motions2  .size())) motions   = g_device->rtNewData("immutable",numMotions  *sizeof(Vec3f),&motions2  [0]);
+      if ((numNormals   = normals2  .size())) normals   = g_device->rtNewData("immutable",numNormals  *sizeof(Vec3f),&normals2  [0]);
+      if ((numTexCoords = texcoords2.size())) texcoords = g_device->rtNewData("immutable",numTexCoords*sizeof(Vec2f),&texcoords2[0]);
+      if ((numTriangles = triangles2.size())) triangles = g_device->rtNewData("immutable",numTriangles*sizeof(Vec3i),&triangles2[0]);
+    }
+    else 
+    {
+      positions = loadVec3fArray(xml->childOpt("positions"), numPositions);
+      motions   = loadVec3fArray(xml->childOpt("motions"  ), numMotions);
+      normals   = loadVec3fArray(xml->childOpt("normals"  ), numNormals);
+      texcoords = loadVec2fArray(xml->childOpt("texcoords"), numTexCoords);
+      triangles = loadVector3iArray(xml->childOpt("triangles"), numTriangles);
+    }
 
 #if 0
     std::vector<Vec3f> positions2 = loadVec3fArray(xml->childOpt("positions"));
@@ -617,6 +642,7 @@ namespace embree
     g_device->rtSetString(mesh,"accel",g_mesh_accel.c_str());
     g_device->rtSetString(mesh,"builder",g_mesh_builder.c_str());
     g_device->rtSetString(mesh,"traverser",g_mesh_traverser.c_str());
+    if (g_compact_meshes) g_device->rtSetInt1(mesh,"compact",1);
     g_device->rtCommit(mesh);
     g_device->rtClear(mesh);
 
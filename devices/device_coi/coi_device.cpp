@@ -280,6 +280,9 @@ namespace embree
     else if (!strcasecmp(type,"RGBA8"       )) bytes = width*height*4*sizeof(char);
     else if (!strcasecmp(type,"RGB_FLOAT32" )) bytes = width*height*3*sizeof(float);
     else if (!strcasecmp(type,"RGBA_FLOAT32")) bytes = width*height*4*sizeof(float);
+    else if (!strcasecmp(type,"BC1"         )) bytes = ((width+3)/4)*((height+3)/4)*8;
+    else if (!strcasecmp(type,"BC3"         )) bytes = ((width+3)/4)*((height+3)/4)*16;
+    else if (!strcasecmp(type,"BCH"         )) bytes = ((width+3)/4)*((height+3)/4)*16;
     else throw std::runtime_error("unknown image type: "+std::string(type)); 
 
     COIBUFFER buffer;   
@@ -446,6 +449,7 @@ namespace embree
     if      (!strcasecmp(type,"RGB_FLOAT32")) swapchain = new SwapChain(&process,width*height*3*sizeof(float),numBuffers);
     else if (!strcasecmp(type,"RGBA8"      )) swapchain = new SwapChain(&process,width*height*4,numBuffers);
     else if (!strcasecmp(type,"RGB8"       )) swapchain = new SwapChain(&process,width*height*3,numBuffers);
+    else if (!strcasecmp(type,"RGBA_FLOAT16")) swapchain = new SwapChain(&process,width*height*4*sizeof(half),numBuffers);
     else throw std::runtime_error("unknown framebuffer type: "+std::string(type));
     swapchains[(int)(long)id] = swapchain;
 
@@ -1056,13 +1060,16 @@ namespace embree
     if      (!strcasecmp(type,"RGB_FLOAT32")) buffers[id] = new SwapChain(type,width,height,numBuffers,ptrs,FrameBufferRGBFloat32::create);
     else if (!strcasecmp(type,"RGBA8"      )) buffers[id] = new SwapChain(type,width,height,numBuffers,ptrs,FrameBufferRGBA8     ::create);
     else if (!strcasecmp(type,"RGB8"       )) buffers[id] = new SwapChain(type,width,height,numBuffers,ptrs,FrameBufferRGB8      ::create);
+    else if (!strcasecmp(type,"RGBA_FLOAT16")) buffers[id] = new SwapChain(type,width,height,numBuffers,ptrs,FrameBufferRGBAFloat16::create);
     else throw std::runtime_error("unknown framebuffer type: "+std::string(type));
 
     return hid;
   }
 
-  void* COIDevice::rtMapFrameBuffer(Device::RTFrameBuffer frameBuffer, int bufID) 
+  void* COIDevice::rtMapFrameBuffer(Device::RTFrameBuffer frameBuffer, int bufID, const char* channel) 
   { 
+    if (channel && strcasecmp(channel,"color"))
+      throw std::runtime_error("framebuffer channel not supported by COI device: "+std::string(channel));
     Ref<SwapChain>& swapChain = buffers[(size_t)frameBuffer];
     if (bufID < 0) bufID = swapChain->id();
 
@@ -65,7 +65,11 @@
 #include "image3ca_ispc.h"
 #include "image3f_ispc.h"
 #include "image3fa_ispc.h"
+#include "imagebc1_ispc.h"
+#include "imagebc3_ispc.h"
+#include "imagebch_ispc.h"
 #include "textures/nearestneighbor.h"
+#include "textures/mipmap.h"
 
 /* include all tonemappers */
 #include "tonemappers/defaulttonemapper.h"
@@ -93,6 +97,11 @@ double __get_seconds() {
 extern "C" {
   int g_serverCount = 1;
   int g_serverID = 0;
+
+  /*! wall clock time for deadline checks inside ISPC code */
+  double getSecondsISPC() {
+    return embree::getSeconds();
+  }
 }
 
 namespace embree
@@ -166,6 +175,12 @@ namespace embree
       return (Device::RTImage) new ISPCConstHandle(ispc::Image3f__new(width,height,(ispc::vec3f*)data,copy));
     else if (!strcasecmp(type,"RGBA_FLOAT32"))
       return (Device::RTImage) new ISPCConstHandle(ispc::Image3fa__new(width,height,(ispc::vec3fa*)data,copy));
+    else if (!strcasecmp(type,"BC1"))
+      return (Device::RTImage) new ISPCConstHandle(ispc::ImageBC1__new(width,height,(unsigned*)data,copy));
+    else if (!strcasecmp(type,"BC3"))
+      return (Device::RTImage) new ISPCConstHandle(ispc::ImageBC3__new(width,height,(unsigned*)data,copy));
+    else if (!strcasecmp(type,"BCH"))
+      return (Device::RTImage) new ISPCConstHandle(ispc::ImageBCH__new(width,height,(unsigned*)data,copy));
     else
       throw std::runtime_error("unknown image type: "+std::string(type));
   }
@@ -195,7 +210,8 @@ namespace embree
   Device::RTTexture ISPCDevice::rtNewTexture(const char* type) 
   {
     if      (!strcasecmp(type,"nearest")) return (Device::RTTexture) new ISPCCreateHandle<NearestNeighborTexture>;
-    else if (!strcasecmp(type,"image"  )) return (Device::RTTexture) new ISPCCreateHandle<NearestNeighborTexture>;
+    else if (!strcasecmp(type,"mipmap" )) return (Device::RTTexture) new ISPCCreateHandle<MipMapTexture>;
+    else if (!strcasecmp(type,"image"  )) return (Device::RTTexture) new ISPCCreateHandle<MipMapTexture>;
     else throw std::runtime_error("unknown texture type: "+std::string(type));
   }
 
@@ -271,7 +287,8 @@ namespace embree
                                                 (ispc::vec3f&)transform.l.vx,
                                                 (ispc::vec3f&)transform.l.vy,
                                                 (ispc::vec3f&)transform.l.vz,
-                                                (ispc::vec3f&)transform.p);
+                                                (ispc::vec3f&)transform.p,
+                                                illumMask);
       }
     }
 
@@ -347,7 +364,7 @@ namespace embree
                                                (ispc::vec3f&)prim->transform.l.vz,
                                                (ispc::vec3f&)prim->transform.p);
 
-        ISPCRef inst = ispc::Instance__new(shape.ptr,prim->material.ptr,NULL);
+        ISPCRef inst = ispc::Instance__new(shape.ptr,prim->material.ptr,NULL,prim->illumMask);
         ispc::Scene__set(instance.ptr,slot,inst.ptr);
       }
       
@@ -357,10 +374,11 @@ namespace embree
                                                (ispc::vec3f&)prim->transform.l.vx,
                                                (ispc::vec3f&)prim->transform.l.vy,
                                                (ispc::vec3f&)prim->transform.l.vz,
-                                               (ispc::vec3f&)prim->transform.p);
+                                               (ispc::vec3f&)prim->transform.p,
+                                               prim->illumMask);
         
         ISPCRef shape = ispc::Light__shape(light.ptr);
-        ISPCRef inst = ispc::Instance__new(shape.ptr,prim->material.ptr,light.ptr);
+        ISPCRef inst = ispc::Instance__new(shape.ptr,prim->material.ptr,light.ptr,prim->illumMask);
         ispc::Scene__set(instance.ptr,slot,inst.ptr);
       }
       else throw std::runtime_error("invalid primitive");
@@ -404,16 +422,33 @@ namespace embree
   {
     if      (!strcasecmp(type,"RGB_FLOAT32")) return (Device::RTFrameBuffer) new ISPCConstHandle(ispc::SwapChainRGBFloat32__new(width,height,buffers,(void**)ptrs));
     else if (!strcasecmp(type,"RGBA8"      )) return (Device::RTFrameBuffer) new ISPCConstHandle(ispc::SwapChainRGBA8__new(width,height,buffers,(void**)ptrs));
+    else if (!strcasecmp(type,"RGBA_FLOAT16")) return (Device::RTFrameBuffer) new ISPCConstHandle(ispc::SwapChainRGBAFloat16__new(width,height,buffers,(void**)ptrs));
 #if !defined(__MIC__)
     else if (!strcasecmp(type,"RGB8"       )) return (Device::RTFrameBuffer) new ISPCConstHandle(ispc::SwapChainRGB8__new(width,height,buffers,(void**)ptrs));
 #endif
     else throw std::runtime_error("unknown framebuffer type: "+std::string(type));
   }
 
-  void* ISPCDevice::rtMapFrameBuffer(Device::RTFrameBuffer swapchain_i, int bufID) 
+  /*! returns the ID of an auxiliary framebuffer channel as defined in framebuffers/aovbuffer.isph */
+  static int aovChannel(const char* name)
+  {
+    if      (!strcasecmp(name,"albedo"  )) return 0;
+    else if (!strcasecmp(name,"normal"  )) return 1;
+    else if (!strcasecmp(name,"direct"  )) return 2;
+    else if (!strcasecmp(name,"indirect")) return 3;
+    else if (!strcasecmp(name,"depth"   )) return 4;
+    else if (!strcasecmp(name,"primid"  )) return 5;
+    else throw std::runtime_error("unknown framebuffer channel: "+std::string(name));
+  }
+
+  void* ISPCDevice::rtMapFrameBuffer(Device::RTFrameBuffer swapchain_i, int bufID, const char* channel) 
   {
     ISPCConstHandle* swapchain = castHandle<ISPCConstHandle>(swapchain_i,"framebuffer");
-    return ispc::SwapChain__map(swapchain->instance.ptr,bufID);
+    if (!channel || !strcasecmp(channel,"color"))
+      return ispc::SwapChain__map(swapchain->instance.ptr,bufID);
+    void* ptr = ispc::SwapChain__mapChannel(swapchain->instance.ptr,aovChannel(channel));
+    if (!ptr) throw std::runtime_error("framebuffer channel not rendered: "+std::string(channel));
+    return ptr;
   }
 
   void ISPCDevice::rtUnmapFrameBuffer(Device::RTFrameBuffer swapchain_i, int bufID) 
@@ -613,6 +648,9 @@ namespace embree
     ISPCNormalHandle* toneMapper = castHandle<ISPCNormalHandle>(toneMapper_i ,"tonemapper");
     ISPCConstHandle* swapchain    = castHandle<ISPCConstHandle>  (swapchain_i,"framebuffer");
 
+    /* reprojection of the previous frame is not supported, restart accumulation instead */
+    if (accumulate == 2) accumulate = 0;
+
     ispc::Renderer__renderFrameInit(renderer->instance.ptr,scene->instance.ptr);
     double t0 = getSeconds();
     int numRays = ispc::Renderer__renderFrame(renderer->instance.ptr,camera->instance.ptr,scene->instance.ptr,toneMapper->instance.ptr,swapchain->instance.ptr,accumulate);
@@ -54,7 +54,7 @@ namespace embree
     RTToneMapper rtNewToneMapper(const char* type);
     RTRenderer rtNewRenderer(const char* type);
     RTFrameBuffer rtNewFrameBuffer(const char* type, size_t width, size_t height, size_t buffers, void** ptrs);
-    void* rtMapFrameBuffer(RTFrameBuffer frameBuffer, int bufID);
+    void* rtMapFrameBuffer(RTFrameBuffer frameBuffer, int bufID, const char* channel);
     void rtUnmapFrameBuffer(RTFrameBuffer frameBuffer, int bufID);
     void rtSwapBuffers(RTFrameBuffer frameBuffer);
     void rtIncRef(RTHandle handle);
@@ -30,8 +30,28 @@ namespace embree
       const float epsilon = parms.getFloat("epsilon",32.0f)*float(ulp);
       const int spp = max(1,parms.getInt("sampler.spp",1));
       const int sampleLightForGlossy = parms.getInt("sampleLightForGlossy",0);
+      const int mis = parms.getInt("mis",0);
+      const int aovs = parms.getInt("aovs",0);
       ISPCRef backplate = parms.getImage("backplate");
-      return ispc::PathTracer__new(maxDepth,minContribution,epsilon,spp,backplate.ptr,sampleLightForGlossy);
+      void* renderer = ispc::PathTracer__new(maxDepth,minContribution,epsilon,spp,backplate.ptr,sampleLightForGlossy,mis,aovs);
+      const Vec2f cropMin = parms.getVec2f("crop.min",Vec2f(0.0f,0.0f));
+      const Vec2f cropMax = parms.getVec2f("crop.max",Vec2f(1.0f,1.0f));
+      ispc::PathTracer__setCropWindow(renderer,cropMin.x,cropMin.y,cropMax.x,cropMax.y);
+      ispc::PathTracer__setSubsample(renderer,parms.getInt("subsample",1));
+      ispc::PathTracer__setTimeBudget(renderer,parms.getFloat("timeBudget",0.0f));
+      ispc::PathTracer__setRegenerate(renderer,parms.getInt("regenerate",0));
+      ispc::PathTracer__setRoulette(renderer,parms.getInt("roulette.depth",-1));
+      ispc::PathTracer__setPathStatistics(renderer,parms.getInt("pathStatistics",0));
+      ispc::PathTracer__setSampler(renderer,parms.getInt("sampler.samples",16*16),parms.getInt("sampler.sets",64));
+      if (parms.getInt("denoise",0)) {
+        const int radius = parms.getInt("denoise.radius",4);
+        ispc::PathTracer__setDenoiser(renderer,radius,
+                                      parms.getFloat("denoise.sigmaSpatial",0.5f*float(radius)),
+                                      parms.getFloat("denoise.sigmaAlbedo",0.1f),
+                                      parms.getFloat("denoise.sigmaNormal",0.1f),
+                                      parms.getFloat("denoise.sigmaDepth",0.05f));
+      }
+      return renderer;
     }
   };
 }
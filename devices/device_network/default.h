@@ -28,6 +28,7 @@
 #include "math/vec3.h"
 #include "math/vec4.h"
 #include "math/col3.h"
+#include "math/half.h"
 #include "math/affinespace.h"
 
 #include "simd/simd.h"
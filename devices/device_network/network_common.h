@@ -37,6 +37,7 @@ namespace embree
     EMBREE_NEW_SHAPE = 7,
     EMBREE_NEW_LIGHT = 8,
     EMBREE_NEW_SHAPE_PRIMITIVE = 9,
+    EMBREE_NEW_SHAPE_PRIMITIVES = 52,
     EMBREE_NEW_LIGHT_PRIMITIVE = 10,
     EMBREE_TRANSFORM_PRIMITIVE = 44,
     EMBREE_NEW_SCENE = 11,
@@ -64,6 +65,7 @@ namespace embree
     EMBREE_SET_TEXTURE = 32,
     EMBREE_SET_TRANSFORM = 33,
     EMBREE_SET_SCENE_PRIMITIVE = 50,
+    EMBREE_SET_SCENE_PRIMITIVES = 53,
     EMBREE_CLEAR = 34,
     EMBREE_COMMIT = 35,
     EMBREE_RENDER_FRAME = 36,
@@ -76,6 +78,7 @@ namespace embree
     EMBREE_FRAME_DATA_NATIVE = 49,
     EMBREE_FRAME_DATA_DXT1 = 43,
     EMBREE_FRAME_DATA_JPEG = 45,
+    EMBREE_FRAME_DATA_RGB_HALF = 47,
     EMBREE_RENDER_TIME = 46
   };
 
@@ -235,6 +235,7 @@ namespace embree
     case EMBREE_FRAME_DATA_NATIVE:
     case EMBREE_FRAME_DATA_RGB8: 
     case EMBREE_FRAME_DATA_RGBE8: 
+    case EMBREE_FRAME_DATA_RGB_HALF: 
     case EMBREE_FRAME_DATA_RGB_FLOAT:
     case EMBREE_FRAME_DATA_DXT1: {
       
@@ -258,9 +259,10 @@ namespace embree
 
         /*! calculate size of one row in bytes */
         int rowBytes = 0;
-        if      (format == "RGB_FLOAT32") rowBytes = 3*width*sizeof(float);
-        else if (format == "RGBA8"      ) rowBytes = 4*width*sizeof(char);
-        else if (format == "RGB8"       ) rowBytes = (3*width*sizeof(char)+3)/4*4;
+        if      (format == "RGB_FLOAT32" ) rowBytes = 3*width*sizeof(float);
+        else if (format == "RGBA_FLOAT16") rowBytes = 4*width*sizeof(half);
+        else if (format == "RGBA8"       ) rowBytes = 4*width*sizeof(char);
+        else if (format == "RGB8"        ) rowBytes = (3*width*sizeof(char)+3)/4*4;
         else throw std::runtime_error("unknown framebuffer format");
 
         /*! store data directly into framebuffer */
@@ -294,6 +296,17 @@ namespace embree
         }
         break;
 
+      case EMBREE_FRAME_DATA_RGB_HALF: {
+        std::vector<half> row(3*width);
+        for (size_t y=0; y<height; y++) {
+          if ((ssize_t)((y>>2)-id) % (ssize_t)servers.size()) continue;
+          network::read(servers[id],&row[0],row.size()*sizeof(half));
+          for (size_t x=0; x<width; x++)
+            buffer->set(x,y,Color(half_to_float(row[3*x+0]),half_to_float(row[3*x+1]),half_to_float(row[3*x+2])));
+        }
+        break;
+      }
+
       case EMBREE_FRAME_DATA_RGB_FLOAT:
         for (size_t y=0; y<height; y++) {
           if ((ssize_t)((y>>2)-id) % (ssize_t)servers.size()) continue;
@@ -410,6 +423,9 @@ namespace embree
     else if (!strcasecmp(type,"RGBA8"       )) bytes = width*height*4*sizeof(char);
     else if (!strcasecmp(type,"RGB_FLOAT32" )) bytes = width*height*3*sizeof(float);
     else if (!strcasecmp(type,"RGBA_FLOAT32")) bytes = width*height*4*sizeof(float);
+    else if (!strcasecmp(type,"BC1"         )) bytes = ((width+3)/4)*((height+3)/4)*8;
+    else if (!strcasecmp(type,"BC3"         )) bytes = ((width+3)/4)*((height+3)/4)*16;
+    else if (!strcasecmp(type,"BCH"         )) bytes = ((width+3)/4)*((height+3)/4)*16;
     else throw std::runtime_error("unknown image type: "+std::string(type)); 
     broadcast(data,bytes);
     flush();
@@ -523,6 +539,30 @@ namespace embree
     return (Device::RTPrimitive)(long)id;
   }
 
+  void NetworkDevice::rtNewShapePrimitives(size_t num, const Device::RTShape* shapes, const Device::RTMaterial* materials, 
+                                           const float* transforms, Device::RTPrimitive* prims)
+  {
+    if (num == 0) return;
+    std::vector<int> ids(3*num);
+    std::vector<float> xfms(12*num);
+    for (size_t i=0; i<num; i++) {
+      int id = allocHandle();
+      prims[i] = (Device::RTPrimitive)(long)id;
+      ids[3*i+0] = id;
+      ids[3*i+1] = (int)(size_t)shapes[i];
+      ids[3*i+2] = (int)(size_t)materials[i];
+      if (transforms) for (size_t j=0; j<12; j++) xfms[12*i+j] = transforms[12*i+j];
+      else            for (size_t j=0; j<12; j++) xfms[12*i+j] = (j%4 == 0) ? 1.0f : 0.0f;
+    }
+
+    broadcast((int)magick);
+    broadcast((int)EMBREE_NEW_SHAPE_PRIMITIVES);
+    broadcast((int)num);
+    broadcast(&ids[0],ids.size()*sizeof(int));
+    broadcast(&xfms[0],xfms.size()*sizeof(float));
+    flush();
+  }
+
   Device::RTPrimitive NetworkDevice::rtNewLightPrimitive(Device::RTLight light, 
                                                          Device::RTMaterial material, 
                                                          const float* transform)
@@ -592,6 +632,20 @@ namespace embree
     flush();
   }
 
+  void NetworkDevice::rtSetPrimitives(RTScene scene, size_t slot, size_t num, const RTPrimitive* prims)
+  {
+    if (num == 0) return;
+    std::vector<int> ids(num);
+    for (size_t i=0; i<num; i++) ids[i] = (int)(size_t)prims[i];
+    broadcast((int)magick);
+    broadcast((int)EMBREE_SET_SCENE_PRIMITIVES);
+    broadcast((int)(size_t)scene);
+    broadcast((int)slot);
+    broadcast((int)num);
+    broadcast(&ids[0],ids.size()*sizeof(int));
+    flush();
+  }
+
   Device::RTToneMapper NetworkDevice::rtNewToneMapper(const char* type)
   {
     int id = allocHandle();
@@ -627,13 +681,16 @@ namespace embree
     if      (!strcasecmp(type,"RGB_FLOAT32")) buffers[id] = new SwapChain(type,width,height,numBuffers,ptrs,FrameBufferRGBFloat32::create);
     else if (!strcasecmp(type,"RGBA8"      )) buffers[id] = new SwapChain(type,width,height,numBuffers,ptrs,FrameBufferRGBA8     ::create);
     else if (!strcasecmp(type,"RGB8"       )) buffers[id] = new SwapChain(type,width,height,numBuffers,ptrs,FrameBufferRGB8      ::create);
+    else if (!strcasecmp(type,"RGBA_FLOAT16")) buffers[id] = new SwapChain(type,width,height,numBuffers,ptrs,FrameBufferRGBAFloat16::create);
     else throw std::runtime_error("unknown framebuffer type: "+std::string(type));
 
     return (Device::RTFrameBuffer)(long)id;
   }
 
-  void* NetworkDevice::rtMapFrameBuffer(Device::RTFrameBuffer frameBuffer, int bufID) 
+  void* NetworkDevice::rtMapFrameBuffer(Device::RTFrameBuffer frameBuffer, int bufID, const char* channel) 
   {
+    if (channel && strcasecmp(channel,"color"))
+      throw std::runtime_error("framebuffer channel not supported by network device: "+std::string(channel));
     Ref<SwapChain>& swapChain = buffers[(size_t)frameBuffer];
     if (bufID < 0) bufID = swapChain->id();
     swapChain->buffer(bufID)->wait();
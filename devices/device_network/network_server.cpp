@@ -100,6 +100,51 @@ namespace embree
     return(width * height * 4);
   }
 
+  size_t encodeRGBAFloat16_to_RGB8(unsigned char *buffer, half *pixels, size_t width, size_t height) 
+  {
+    for (size_t i=0, j=0 ; i < width * height ; i++, pixels += 4) {
+      float pixel[4]; half4_to_float4(pixels, pixel);
+      buffer[j++] = (unsigned char) (255.0f * clamp(pixel[0]));
+      buffer[j++] = (unsigned char) (255.0f * clamp(pixel[1]));
+      buffer[j++] = (unsigned char) (255.0f * clamp(pixel[2]));
+    }   
+    return(width * height * 3);
+  }
+
+  size_t encodeRGBAFloat16_to_RGBE8(unsigned char *buffer, half *pixels, size_t width, size_t height) 
+  {
+    for (size_t i=0, j=0 ; i < width * height ; i++, pixels += 4) 
+    {
+      float c[4]; half4_to_float4(pixels, c);
+      Vec4f pixel = encodeRGBE8(Col3f(c[0], c[1], c[2]));
+      buffer[j++] = (unsigned char) (pixel.x);
+      buffer[j++] = (unsigned char) (pixel.y);
+      buffer[j++] = (unsigned char) (pixel.z);
+      buffer[j++] = (unsigned char) (pixel.w);
+    }   
+    return(width * height * 4);
+  }
+
+  size_t encodeRGBFloat32_to_RGBHalf(half *buffer, Col3f *pixels, size_t width, size_t height) 
+  {
+    for (size_t i=0, j=0 ; i < width * height ; i++) {
+      buffer[j++] = float_to_half(pixels[i].r);
+      buffer[j++] = float_to_half(pixels[i].g);
+      buffer[j++] = float_to_half(pixels[i].b);
+    }   
+    return(width * height * 3 * sizeof(half));
+  }
+
+  size_t encodeRGBAFloat16_to_RGBHalf(half *buffer, half *pixels, size_t width, size_t height) 
+  {
+    for (size_t i=0 ; i < width * height ; i++, buffer += 3, pixels += 4) {
+      buffer[0] = pixels[0];
+      buffer[1] = pixels[1];
+      buffer[2] = pixels[2];
+    }   
+    return(width * height * 3 * sizeof(half));
+  }
+
   void NetworkServer::receive() 
   {
     /*! read the magick number */
@@ -178,6 +223,9 @@ namespace embree
       else if (!strcmp(type.c_str(), "RGBA8"       )) bytes = width * height * 4 * sizeof(char);
       else if (!strcmp(type.c_str(), "RGB_FLOAT32" )) bytes = width * height * 3 * sizeof(float);
       else if (!strcmp(type.c_str(), "RGBA_FLOAT32")) bytes = width * height * 4 * sizeof(float);
+      else if (!strcmp(type.c_str(), "BC1"         )) bytes = ((width+3)/4) * ((height+3)/4) * 8;
+      else if (!strcmp(type.c_str(), "BC3"         )) bytes = ((width+3)/4) * ((height+3)/4) * 16;
+      else if (!strcmp(type.c_str(), "BCH"         )) bytes = ((width+3)/4) * ((height+3)/4) * 16;
       else throw std::runtime_error("unknown image type: " + std::string(type));
       char* data = (char*) malloc(bytes);  
       network::read(socket, data, bytes);
@@ -273,6 +321,20 @@ namespace embree
       break;
     }
 
+    case EMBREE_SET_SCENE_PRIMITIVES:
+    {
+      int sceneID = network::read_int(socket);
+      int slot    = network::read_int(socket);
+      int num     = network::read_int(socket);
+      std::vector<int> ids(num);
+      if (num) network::read(socket, &ids[0], num * sizeof(int));
+      if (verbose) printf("rtSetScenePrimitives(%06d, %06d, %d)\n", sceneID, slot, num);
+      std::vector<Device::RTPrimitive> prims(num);
+      for (int i=0; i<num; i++) prims[i] = get<Device::RTPrimitive>(ids[i]);
+      if (num) device->rtSetPrimitives(get<Device::RTScene>(sceneID), slot, num, &prims[0]);
+      break;
+    }
+
     case EMBREE_NEW_SHAPE: 
     {
       int id = network::read_int(socket);
@@ -294,6 +356,26 @@ namespace embree
       break;
     } 
 
+    case EMBREE_NEW_SHAPE_PRIMITIVES: 
+    {
+      int num = network::read_int(socket);
+      std::vector<int> ids(3*num);
+      std::vector<float> transforms(12*num);
+      if (num) network::read(socket, &ids[0], ids.size() * sizeof(int));
+      if (num) network::read(socket, &transforms[0], transforms.size() * sizeof(float));
+      if (verbose) printf("rtNewShapePrimitives(%d)\n", num);
+      std::vector<Device::RTShape> shapes(num);
+      std::vector<Device::RTMaterial> materials(num);
+      std::vector<Device::RTPrimitive> prims(num);
+      for (int i=0; i<num; i++) {
+        shapes[i] = get<Device::RTShape>(ids[3*i+1]);
+        materials[i] = get<Device::RTMaterial>(ids[3*i+2]);
+      }
+      if (num) device->rtNewShapePrimitives(num, &shapes[0], &materials[0], &transforms[0], &prims[0]);
+      for (int i=0; i<num; i++) set(ids[3*i+0], prims[i]);
+      break;
+    } 
+
     case EMBREE_NEW_TEXTURE: 
     {
       int id = network::read_int(socket);
@@ -712,9 +794,10 @@ namespace embree
     case EMBREE_FRAME_DATA_NATIVE:
     {
       size_t bytes = 0;
-      if      (type == "RGB_FLOAT32") bytes = 3 * width * height1 * sizeof(float);
-      else if (type == "RGBA8"      ) bytes = 4 * width * height1;
-      else if (type == "RGB8"       ) bytes = ((3 * width + 3) / 4 * 4) * height1;
+      if      (type == "RGB_FLOAT32" ) bytes = 3 * width * height1 * sizeof(float);
+      else if (type == "RGBA_FLOAT16") bytes = 4 * width * height1 * sizeof(half);
+      else if (type == "RGBA8"       ) bytes = 4 * width * height1;
+      else if (type == "RGB8"        ) bytes = ((3 * width + 3) / 4 * 4) * height1;
       else throw std::runtime_error("unsupported framebuffer format: " + type);
       network::write(server->socket, data, bytes);
       break;
@@ -724,6 +807,7 @@ namespace embree
     {
       size_t bytes = 0;   
       if      (type == "RGB_FLOAT32") bytes = encodeRGBFloat32_to_RGB8(encoded, (Col3f *) data, width, height1);
+      else if (type == "RGBA_FLOAT16") bytes = encodeRGBAFloat16_to_RGB8(encoded, (half *) data, width, height1);
       else if (type == "RGBA8")       bytes = encodeRGBA8_to_RGB8(encoded, (unsigned char *) data, width, height1);
       else if (type == "RGB8")        bytes = width * height1 * 3;
       else throw std::runtime_error("unsupported framebuffer format: " + type);
@@ -734,7 +818,18 @@ namespace embree
     case EMBREE_FRAME_DATA_RGBE8:
     {
       size_t bytes = 0;
-      if (type == "RGB_FLOAT32") bytes = encodeRGBFloat32_to_RGBE8(encoded, (Col3f *) data, width, height1);
+      if      (type == "RGB_FLOAT32" ) bytes = encodeRGBFloat32_to_RGBE8(encoded, (Col3f *) data, width, height1);
+      else if (type == "RGBA_FLOAT16") bytes = encodeRGBAFloat16_to_RGBE8(encoded, (half *) data, width, height1);
+      else throw std::runtime_error("unsupported framebuffer format: " + type);
+      network::write(server->socket, encoded, bytes);
+      break;
+    }
+
+    case EMBREE_FRAME_DATA_RGB_HALF:
+    {
+      size_t bytes = 0;
+      if      (type == "RGB_FLOAT32" ) bytes = encodeRGBFloat32_to_RGBHalf((half *) encoded, (Col3f *) data, width, height1);
+      else if (type == "RGBA_FLOAT16") bytes = encodeRGBAFloat16_to_RGBHalf((half *) encoded, (half *) data, width, height1);
       else throw std::runtime_error("unsupported framebuffer format: " + type);
       network::write(server->socket, encoded, bytes);
       break;
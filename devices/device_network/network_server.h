@@ -54,7 +54,7 @@ namespace embree
         numBuffers(numBuffers), writeID(0), readID((size_t)-1), serverID(serverID), serverCount(serverCount)
       {
         server->device->rtIncRef(frameBuffer);
-        encoded = (unsigned char *) malloc(width * height * 4);  
+        encoded = (unsigned char *) malloc(width * height * 3 * sizeof(half));  
       }
       
       ~SwapChain () 
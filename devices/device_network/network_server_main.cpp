@@ -58,6 +58,7 @@ namespace embree
         else if (!strcmp(argv[i], "jpeg"  )) g_encoding = EMBREE_FRAME_DATA_JPEG;
         else if (!strcmp(argv[i], "rgb8"  )) g_encoding = EMBREE_FRAME_DATA_RGB8;
         else if (!strcmp(argv[i], "rgbe8" )) g_encoding = EMBREE_FRAME_DATA_RGBE8;
+        else if (!strcmp(argv[i], "half"  )) g_encoding = EMBREE_FRAME_DATA_RGB_HALF;
         else throw std::runtime_error("unknown encoding mode: " + (std::string) argv[i]);
       }
       
@@ -87,7 +88,7 @@ namespace embree
 
       /*! invalid argument */
       else {
-        std::cout << "usage: embree_network_server [-encode rgb8|rgbe8|jpeg] [-port number] [-threads number] [-verbose]" << std::endl;
+        std::cout << "usage: embree_network_server [-encode native|rgb8|rgbe8|half|jpeg] [-port number] [-threads number] [-verbose]" << std::endl;
         throw std::runtime_error("invalid command line argument: " + (std::string) argv[i]);
       }
     }
@@ -18,6 +18,7 @@
 #define __EMBREE_FRAMEBUFFER_H__
 
 #include "../default.h"
+#include "math/half.h"
 
 namespace embree
 {
@@ -128,6 +129,50 @@ namespace embree
     }
   };
 
+  /*! RGBA_FLOAT16 framebuffer, stores half precision HDR values at
+   *  half the size of an RGB_FLOAT32 framebuffer */
+  struct FrameBufferRGBAFloat16 : public FrameBuffer
+  {
+  public:
+
+    /*! class factory */
+    static FrameBuffer* create(size_t width, size_t height, void* ptr) {
+      return new FrameBufferRGBAFloat16(width,height,ptr);
+    }
+
+  protected:
+
+    /*! constructs a new framebuffer of specified size */
+    FrameBufferRGBAFloat16 (size_t width, size_t height, void* ptr) 
+      : FrameBuffer(width,height,4*width*sizeof(half),ptr) 
+    {
+      if (!data) {
+        data = malloc(stride*height);
+        allocated = true;
+      }
+      memset(data,0,stride*height);
+    }
+    
+    /*! destroys the framebuffer */
+    ~FrameBufferRGBAFloat16 () {
+      if (allocated) free(data); data = NULL;
+    }
+
+    /*! read pixel */
+    const Color get(size_t x, size_t y) const 
+    {
+      float c[4]; half4_to_float4((half*)data+4*(y*width+x),c);
+      return Color(c[0],c[1],c[2]);
+    }
+
+    /*! write pixel */
+    void set(size_t x, size_t y, const Color& c) 
+    {
+      const float pixel[4] = { c.r, c.g, c.b, 1.0f };
+      float4_to_half4(pixel,(half*)data+4*(y*width+x));
+    }
+  };
+
   /*! RGBA8 framebuffer */
   struct FrameBufferRGBA8 : public FrameBuffer
   {
@@ -225,22 +270,45 @@ namespace embree
     }
   };
 
-  /*! accumulation buffer */
+  /*! Accumulation buffer. The default representation stores the
+   *  weighted color sum and the weight as a Vec4f per pixel. The
+   *  compact representation stores the normalized color in half
+   *  precision and the weight in a separate float plane, which reduces
+   *  the memory and bandwidth of the per pixel update from 16 to 12
+   *  bytes. The weight is stored exactly, but the half mean is
+   *  requantized by every update, thus the share of a new sample has
+   *  to stay well above the 11 bit precision of half. The compact
+   *  representation is therefore limited to MAX_COMPACT_WEIGHT
+   *  samples per pixel. A compact buffer that reached the limit
+   *  reports to be saturated and gets expanded to the default
+   *  representation, in which the accumulation continues. */
   struct AccuBuffer : public RefCount
   {
   public:
 
+    /*! Largest weight the compact representation accumulates. */
+    enum { MAX_COMPACT_WEIGHT = 256 };
+
     /*! constructs a new framebuffer of specified size */
-    AccuBuffer (size_t width, size_t height) 
-    : width(width), height(height), data(NULL)
+    AccuBuffer (size_t width, size_t height, bool compact = false) 
+    : width(width), height(height), compact(compact), saturated(false), expanded(false), data(NULL), color(NULL), weights(NULL)
     {
-      data = new Vec4f[width*height];
-      memset(data,0,width*height*sizeof(Vec4f));
+      if (compact) {
+        color = new half[4*width*height];
+        weights = new float[width*height];
+        memset(color,0,4*width*height*sizeof(half));
+        memset(weights,0,width*height*sizeof(float));
+      } else {
+        data = new Vec4f[width*height];
+        memset(data,0,width*height*sizeof(Vec4f));
+      }
     }
     
     /*! destroys the framebuffer */
     ~AccuBuffer () {
       delete[] data; data = NULL;
+      delete[] color; color = NULL;
+      delete[] weights; weights = NULL;
     }
 
     /*! return the width of the swapchain */
@@ -249,36 +317,72 @@ namespace embree
     /*! return the height of the swapchain */
     __forceinline size_t getHeight() const { return height; }
 
-    /*! return a pointer to the raw pixel data */
-    __forceinline void* getData() { return data; }
+    /*! returns true if the compact representation is used */
+    __forceinline bool isCompact() const { return compact; }
+
+    /*! returns true if a pixel of the compact representation reached MAX_COMPACT_WEIGHT */
+    __forceinline bool isSaturated() const { return saturated; }
+
+    /*! returns true if the buffer continues a saturated compact buffer */
+    __forceinline bool isExpanded() const { return expanded; }
+
+    /*! returns a copy in the default representation */
+    Ref<AccuBuffer> expand() const
+    {
+      Ref<AccuBuffer> accu = new AccuBuffer(width,height);
+      for (size_t y=0; y<height; y++)
+        for (size_t x=0; x<width; x++)
+          accu->data[y*width+x] = getSum(x,y);
+      accu->expanded = true;
+      return accu;
+    }
 
     /*! clear buffer */
     __forceinline void clear(size_t x, size_t y) {
-      data[y*width+x] = Vec4f(0.0f,0.0f,0.0f,1E-10f);
+      set(x,y,Vec4f(0.0f,0.0f,0.0f,1E-10f));
     }
 
-    /*! set pixel */
-    __forceinline void set(size_t x, size_t y, const Vec4f& c) {
-      data[y*width+x] = c;
+    /*! set pixel to weighted color sum and weight */
+    __forceinline void set(size_t x, size_t y, const Vec4f& c) 
+    {
+      if (compact) {
+        const float norm = rcp(c.w);
+        const float pixel[4] = { c.x*norm, c.y*norm, c.z*norm, 0.0f };
+        float4_to_half4(pixel,color+4*(y*width+x));
+        weights[y*width+x] = c.w;
+        if (unlikely(c.w >= float(MAX_COMPACT_WEIGHT))) saturated = true;
+      }
+      else data[y*width+x] = c;
+    }
+
+    /*! read weighted color sum and weight of pixel */
+    __forceinline Vec4f getSum(size_t x, size_t y) const 
+    {
+      if (compact) {
+        float pixel[4]; half4_to_float4(color+4*(y*width+x),pixel);
+        const float w = weights[y*width+x];
+        return Vec4f(pixel[0]*w,pixel[1]*w,pixel[2]*w,w);
+      }
+      else return data[y*width+x];
     }
 
     /*! accumulate pixel */
     __forceinline void add(size_t x, size_t y, const Vec4f& c) {
-      data[y*width+x] += c;
+      if (compact) set(x,y,getSum(x,y)+c);
+      else data[y*width+x] += c;
     }
 
     /*! update pixel */
     __forceinline Color update(size_t x, size_t y, const Color& c, const float weight, bool accu) 
     {
       if (accu) {
-        const Vec4f cur = data[y*width+x];
-        const Vec4f next = cur + Vec4f(c.r,c.g,c.b,weight);
-        data[y*width+x] = next;
+        const Vec4f next = getSum(x,y) + Vec4f(c.r,c.g,c.b,weight);
+        set(x,y,next);
         const float norm = rcp(next.w);
         return Color(next.x,next.y,next.z)*norm;
       }
       else {
-        data[y*width+x] = Vec4f(c.r,c.g,c.b,weight);
+        set(x,y,Vec4f(c.r,c.g,c.b,weight));
         return c*rcp(weight);
       }
     }
@@ -286,6 +390,10 @@ namespace embree
     /*! read pixel */
     __forceinline const Color get(size_t x, size_t y) const 
     {
+      if (compact) {
+        float pixel[4]; half4_to_float4(color+4*(y*width+x),pixel);
+        return Color(pixel[0],pixel[1],pixel[2]);
+      }
       const Vec4f& c = data[y*width+x];
       const float norm = rcp(c.w);
       return Color(c.x,c.y,c.z)*norm;
@@ -294,7 +402,138 @@ namespace embree
   protected:
     size_t width;              //!< width of the framebuffer in pixels
     size_t height;             //!< height of the framebuffer in pixels
-    Vec4f* data;                //!< framebuffer data
+    bool compact;              //!< true if the compact representation is used
+    bool saturated;            //!< true if a compact pixel reached MAX_COMPACT_WEIGHT
+    bool expanded;             //!< true if expanded from a saturated compact buffer
+    Vec4f* data;               //!< weighted color sums and weights
+    half* color;               //!< normalized colors of compact representation, padded to 4 channels
+    float* weights;            //!< weights of compact representation
+  };
+
+  /*! auxiliary outputs of a single sample, written by the integrator at the primary hit */
+  struct AOVSample
+  {
+    AOVSample () : albedo(zero), normal(zero), depth(inf), primID(-1), direct(zero) {}
+
+  public:
+    Color albedo;              //!< reflectivity at the primary hit
+    Vector3f normal;           //!< shading normal at the primary hit
+    float depth;               //!< distance to the primary hit
+    int primID;                //!< ID of the primitive hit by the primary ray
+    Color direct;              //!< emitted radiance plus light sampled at the primary hit
+  };
+
+  /*! Buffer of auxiliary channels (AOVs) rendered in the same pass
+   *  as the color. Albedo, normal, direct, and indirect channels are
+   *  accumulated like the color, depth and primitive ID are taken
+   *  from the first sample of a frame. */
+  struct AOVBuffer : public RefCount
+  {
+  public:
+
+    /*! channels that can be mapped */
+    enum Channel { ALBEDO = 0, NORMAL = 1, DIRECT = 2, INDIRECT = 3, DEPTH = 4, PRIMID = 5 };
+
+    /*! number of accumulated channels */
+    enum { NUM_ACCU_CHANNELS = 4 };
+
+    /*! returns the channel of the specified name */
+    static Channel channel(const char* name)
+    {
+      if      (!strcasecmp(name,"albedo"  )) return ALBEDO;
+      else if (!strcasecmp(name,"normal"  )) return NORMAL;
+      else if (!strcasecmp(name,"direct"  )) return DIRECT;
+      else if (!strcasecmp(name,"indirect")) return INDIRECT;
+      else if (!strcasecmp(name,"depth"   )) return DEPTH;
+      else if (!strcasecmp(name,"primid"  )) return PRIMID;
+      else throw std::runtime_error("unknown framebuffer channel: "+std::string(name));
+    }
+
+    /*! constructs a new AOV buffer of specified size */
+    AOVBuffer (size_t width, size_t height)
+      : width(width), height(height)
+    {
+      for (size_t c=0; c<NUM_ACCU_CHANNELS; c++) {
+        data[c] = new Vec4f[width*height];
+        memset(data[c],0,width*height*sizeof(Vec4f));
+      }
+      depth = new float[width*height];
+      primID = new int[width*height];
+      resolved = new Col3f[width*height];
+      for (size_t i=0; i<width*height; i++) {
+        depth[i] = inf; primID[i] = -1;
+      }
+    }
+
+    /*! destroys the AOV buffer */
+    ~AOVBuffer ()
+    {
+      for (size_t c=0; c<NUM_ACCU_CHANNELS; c++) {
+        delete[] data[c]; data[c] = NULL;
+      }
+      delete[] depth; depth = NULL;
+      delete[] primID; primID = NULL;
+      delete[] resolved; resolved = NULL;
+    }
+
+    /*! update pixel with the sum of the auxiliary outputs of all
+     *  samples and the sum of their radiance */
+    __forceinline void update(size_t x, size_t y, const AOVSample& s, const Color& L, const float weight, bool accu)
+    {
+      const size_t i = y*width+x;
+      const Color indirect = L-s.direct;
+      const Vec4f v[NUM_ACCU_CHANNELS] = {
+        Vec4f(s.albedo.r,s.albedo.g,s.albedo.b,weight),
+        Vec4f(s.normal.x,s.normal.y,s.normal.z,weight),
+        Vec4f(s.direct.r,s.direct.g,s.direct.b,weight),
+        Vec4f(indirect.r,indirect.g,indirect.b,weight)
+      };
+      for (size_t c=0; c<NUM_ACCU_CHANNELS; c++)
+        data[c][i] = accu ? data[c][i]+v[c] : v[c];
+
+      if (!accu) {
+        depth[i] = s.depth;
+        primID[i] = s.primID;
+      }
+    }
+
+    /*! read normalized pixel of an accumulated channel */
+    __forceinline Vector3f get(Channel channel, size_t x, size_t y) const
+    {
+      const Vec4f& c = data[channel][y*width+x];
+      const float norm = c.w > 0.0f ? rcp(c.w) : 0.0f;
+      return Vector3f(c.x,c.y,c.z)*norm;
+    }
+
+    /*! read pixel of the depth channel */
+    __forceinline float getDepth(size_t x, size_t y) const {
+      return depth[y*width+x];
+    }
+
+    /*! returns a pointer to the channel data, float3 per pixel for
+     *  albedo, normal, direct, and indirect, a float per pixel for
+     *  depth, and an int per pixel for the primitive ID */
+    void* map(Channel channel)
+    {
+      if (channel == DEPTH ) return depth;
+      if (channel == PRIMID) return primID;
+
+      for (size_t y=0; y<height; y++) {
+        for (size_t x=0; x<width; x++) {
+          const Vector3f c = get(channel,x,y);
+          resolved[y*width+x] = Col3f(c.x,c.y,c.z);
+        }
+      }
+      return resolved;
+    }
+
+  protected:
+    size_t width;                       //!< width of the buffer in pixels
+    size_t height;                      //!< height of the buffer in pixels
+    Vec4f* data[NUM_ACCU_CHANNELS];     //!< accumulated channels, weight stored in w
+    float* depth;                       //!< depth channel
+    int* primID;                        //!< primitive ID channel
+    Col3f* resolved;                    //!< normalized copy of the last mapped accumulated channel
   };
 }
 
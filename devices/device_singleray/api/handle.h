@@ -19,6 +19,7 @@
 
 #include "device/device.h"
 #include "parms.h"
+#include "sys/sync/mutex.h"
 
 namespace embree
 {
@@ -38,6 +39,9 @@ namespace embree
 
     /*! Sets a parameter of the handle. */
     virtual void set(const std::string& property, const embree::Variant& data) = 0;
+
+  public:
+    MutexSys mutex;  //!< Serializes set, clear, and create calls to this handle.
   };
 
   /*******************************************************************
@@ -69,7 +73,9 @@ namespace embree
   public:
     InstanceHandle () {}
 
-    Ref<B> getInstance() { return instance; }
+    /*! Returns the current object. Locks the handle, as the object
+     *  may get recreated by a concurrent commit. */
+    Ref<B> getInstance() { Lock<MutexSys> lock(this->mutex); return instance; }
 
     /*! checks if object is newer than other object */
     template<typename A>
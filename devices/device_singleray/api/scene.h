@@ -22,12 +22,24 @@
 
 #include "../lights/light.h"
 #include "../shapes/differentialgeometry.h"
+#include "../samplers/pathguide.h"
+#include "../integrators/radiancecache.h"
 
 /*! include interface to ray tracing core */
 #include <embree2/rtcore.h>
 
 namespace embree
 {
+  /*! Primitive that blocked the last shadow ray towards a light. */
+  struct Occluder
+  {
+    Occluder () : id0(-1), id1(-1) {}
+    Occluder (int id0, int id1) : id0(id0), id1(id1) {}
+  public:
+    int id0;  /*!< 1st primitive ID, -1 if no blocker is known. */
+    int id1;  /*!< 2nd primitive ID. */
+  };
+
   /*! Scene holding all geometry and lights. */
   class BackendScene : public RefCount
   {
@@ -76,9 +88,28 @@ namespace embree
      *  which will call the post intersector of the shape. */
     virtual void postIntersect(const Ray& ray, DifferentialGeometry& dg) const = 0;
 
+    /*! Returns true if the scene supports occludedBy and reports
+     *  the blocker of occlusion queries. */
+    virtual bool supportsOccludedBy() const { return false; }
+
+    /*! Tests if the ray segment is blocked by the primitive
+     *  identified by id0 and id1 without traversing the scene. Returns
+     *  false if the primitive cannot be tested cheaply. */
+    virtual bool occludedBy(const Ray& ray, int id0, int id1) const { return false; }
+
+    /*! Tests the ray for occlusion like rtcOccluded and stores the
+     *  primitive that blocked it in blocker, or clears blocker if the
+     *  ray is unoccluded. Leaves blocker unchanged if the scene does
+     *  not support occludedBy. */
+    virtual void occluded(Ray& ray, Occluder& blocker) const {
+      rtcOccluded(scene,(RTCRay&)ray);
+    }
+
   public:
     std::vector<Ref<Light> > allLights;              //!< All lights of the scene
     std::vector<Ref<EnvironmentLight> > envLights;   //!< Environment lights of the scene
+    Ref<PathGuide> guide;                            //!< Incident radiance learned for path guiding, NULL if disabled
+    Ref<RadianceCache> cache;                        //!< Radiance cached for preview rendering, NULL if disabled
     RTCScene scene;
   };
 }
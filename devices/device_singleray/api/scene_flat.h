@@ -18,6 +18,7 @@
 #define __EMBREE_BACKEND_SCENE_FLAT_H__
 
 #include "scene.h"
+#include "sys/thread.h"
 #include <embree2/rtcore.h>
 
 namespace embree
@@ -26,6 +27,16 @@ namespace embree
     ray.id0 = RTC_INVALID_GEOMETRY_ID;
   }
 
+  /*! Blocker the occlusion query of the calling thread reports to, NULL if not recorded. */
+  static tls_t occluderRecord = createTls();
+
+  /*! Accepts the hit of an opaque primitive and records it as blocker. */
+  void recordOccluderFilter(void* ptr, Ray& ray)
+  {
+    Occluder* blocker = (Occluder*) getTls(occluderRecord);
+    if (blocker) *blocker = Occluder(ray.id0,ray.id1);
+  }
+
   /*! Flat scene, no support for instancing, best render performance. */
   class BackendSceneFlat : public BackendScene
   {
@@ -94,6 +105,8 @@ namespace embree
           id0_to_geomID[id0] = i;
           if (prims[i]->material && prims[i]->material->isTransparentForShadowRays)
             rtcSetOcclusionFilterFunction(scene,i,(RTCFilterFunc)&occlusionFilter);
+          else
+            rtcSetOcclusionFilterFunction(scene,i,(RTCFilterFunc)&recordOccluderFilter);
         }
       }
       rtcCommit(scene);
@@ -111,6 +124,29 @@ namespace embree
       if (ray) geometry[id0_to_geomID[ray.id0]]->postIntersect(ray,dg);
     }
 
+    /*! Tests the ray against a single primitive. Primitives that are
+     *  transparent for shadow rays never occlude. */
+    bool occludedBy(const Ray& ray, int id0, int id1) const
+    {
+      if (id0 < 0 || size_t(id0) >= id0_to_geomID.size()) return false;
+      const Ref<Primitive>& prim = geometry[id0_to_geomID[id0]];
+      if (!prim || !prim->shape) return false;
+      if (prim->material && prim->material->isTransparentForShadowRays) return false;
+      return prim->shape->occluded(ray,id1);
+    }
+
+    bool supportsOccludedBy() const { return true; }
+
+    /*! The occlusion filter of the opaque primitives records the
+     *  accepted hit, thus the blocker comes without a closest hit query. */
+    void occluded(Ray& ray, Occluder& blocker) const
+    {
+      blocker = Occluder();
+      setTls(occluderRecord,&blocker);
+      rtcOccluded(scene,(RTCRay&)ray);
+      setTls(occluderRecord,NULL);
+    }
+
   private:
     std::vector<Ref<Primitive> > geometry;  //!< Geometry of the scene
     std::vector<int> id0_to_geomID;
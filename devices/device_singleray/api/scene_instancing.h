@@ -56,6 +56,8 @@ namespace embree
         if (hasTransform) {
           dg.Tx   = xfmVector(local2world,dg.Tx); 
           dg.Ty   = xfmVector(local2world,dg.Ty);
+          dg.dPds = xfmVector(local2world,dg.dPds);
+          dg.dPdt = xfmVector(local2world,dg.dPdt);
           dg.Ng = xfmVector(normal2world,dg.Ng);
           dg.Ns = normalize(xfmVector(normal2world,dg.Ns));
         }
@@ -16,6 +16,9 @@
 
 #include "singleray_device.h"
 #include "image/image.h"
+#include "image/tiled.h"
+#include "image/compressed.h"
+#include "sys/stl/string.h"
 #include "sys/taskscheduler.h"
 
 /* include general stuff */
@@ -64,6 +67,7 @@
 
 /* include all textures */
 #include "textures/nearestneighbor.h"
+#include "textures/mipmap.h"
 
 /* include all tonemappers */
 #include "tonemappers/defaulttonemapper.h"
@@ -82,7 +86,12 @@
 #pragma warning(disable:4297) // function assumed not to throw an exception but does
 #endif
 
+/*! Commands that enter the ray tracing core or touch the task
+ *  scheduler are serialized through the device mutex. All other
+ *  commands only lock the handles they modify, thus application
+ *  threads can create and commit unrelated handles concurrently. */
 #define RT_COMMAND_HEADER Lock<MutexSys> lock(mutex); g_time++;
+#define RT_CONCURRENT_COMMAND_HEADER g_time++;
 
 namespace embree
 {
@@ -97,7 +106,7 @@ namespace embree
 
   int g_serverCount = 1;
   int g_serverID = 0;
-  size_t g_time = 0;
+  Atomic g_time(0);
 
   /*******************************************************************
                   type definitions
@@ -162,7 +171,7 @@ namespace embree
 
   Device::RTCamera SingleRayDevice::rtNewCamera(const char* type)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if      (!strcasecmp(type,"pinhole")) return (Device::RTCamera) new ConstructorHandle<PinHoleCamera,Camera>;
     else if (!strcasecmp(type,"depthoffield")) return (Device::RTCamera) new ConstructorHandle<DepthOfFieldCamera,Camera>;
     else throw std::runtime_error("unknown camera type: "+std::string(type));
@@ -170,7 +179,7 @@ namespace embree
 
   Device::RTData SingleRayDevice::rtNewData(const char* type, size_t bytes, const void* data)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!strcasecmp(type,"immutable")) 
       return (Device::RTData) new ConstHandle<Data>(new Data(bytes,data,true));
     else if (!strcasecmp(type,"immutable_managed")) 
@@ -181,7 +190,7 @@ namespace embree
 
   Device::RTData SingleRayDevice::rtNewDataFromFile(const char* type, const char* fileName, size_t offset, size_t bytes)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
 
     /*! we always load locally */
     if (!strncmp(fileName,"server:",7)) 
@@ -206,14 +215,48 @@ namespace embree
 
   Device::RTImage SingleRayDevice::rtNewImage(const char* type, size_t width, size_t height, const void* data, const bool copy)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if      (!strcasecmp(type,"RGB8"        )) return (Device::RTImage) new ConstHandle<Image>(new Image3c(width,height,(Col3c*)data,copy));
     else if (!strcasecmp(type,"RGBA8"       )) return (Device::RTImage) new ConstHandle<Image>(new Image4c(width,height,(Col4c*)data,copy));
     else if (!strcasecmp(type,"RGB_FLOAT32" )) return (Device::RTImage) new ConstHandle<Image>(new Image3f(width,height,(Col3f*)data,copy));
     else if (!strcasecmp(type,"RGBA_FLOAT32")) return (Device::RTImage) new ConstHandle<Image>(new Image4f(width,height,(Col4f*)data,copy));
+    else if (!strcasecmp(type,"BC1"         )) return (Device::RTImage) new ConstHandle<Image>(new ImageBC1(width,height,data,copy));
+    else if (!strcasecmp(type,"BC3"         )) return (Device::RTImage) new ConstHandle<Image>(new ImageBC3(width,height,data,copy));
+    else if (!strcasecmp(type,"BCH"         )) return (Device::RTImage) new ConstHandle<Image>(new ImageBCH(width,height,data,copy));
     else throw std::runtime_error("unknown image type: "+std::string(type));
   }
 
+#if !defined(__MIC__)
+  /*! Images with more texels are paged in on demand if their format
+   *  allows it, other formats are converted to a tiled mip pyramid
+   *  with the imgtile tool. */
+  static const size_t tiledImageThreshold = 4096*4096;
+
+  /*! Loads an image, preferring a tiled version of it if present. */
+  static Ref<Image> loadPagedImage(const FileName& fileName)
+  {
+    const FileName tiledName = fileName.addExt(".tiled");
+    if (std::strlwr(fileName.ext()) != "tiled") {
+      if (FILE* f = fopen(tiledName.c_str(),"rb")) {
+        fclose(f); return loadImage(tiledName);
+      }
+    }
+
+    /*! only reads the header of uncompressed PFM and PPM files */
+    const std::string ext = std::strlwr(fileName.ext());
+    if (ext == "pfm" || ext == "ppm") {
+      try {
+        Ref<Image> image = loadTiled(fileName);
+        if (image->width*image->height > tiledImageThreshold) return image;
+      }
+      catch (const std::exception&) {
+        /* ASCII and 16 bit files are loaded completely */
+      }
+    }
+    return loadImage(fileName);
+  }
+#endif
+
   Device::RTImage SingleRayDevice::rtNewImageFromFile(const char* file)
   {
     RT_COMMAND_HEADER;
@@ -221,7 +264,7 @@ namespace embree
       throw std::runtime_error("rtNewImageFromFile not supported on MIC");
 #else
     if (!strncmp(file,"server:",7)) file += 7;
-    Ref<Image> image = loadImage(file);
+    Ref<Image> image = loadPagedImage(file);
     if (image) 
       return (Device::RTImage) new ConstHandle<Image>(image);
     else
@@ -230,15 +273,16 @@ namespace embree
   }
 
   Device::RTTexture SingleRayDevice::rtNewTexture(const char* type) {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!strcasecmp(type,"nearest")) return (Device::RTTexture) new ConstructorHandle<NearestNeighbor,Texture>;
-    else if (!strcasecmp(type,"image")) return (Device::RTTexture) new ConstructorHandle<NearestNeighbor,Texture>;
+    else if (!strcasecmp(type,"mipmap")) return (Device::RTTexture) new ConstructorHandle<MipMap,Texture>;
+    else if (!strcasecmp(type,"image")) return (Device::RTTexture) new ConstructorHandle<MipMap,Texture>;
     else throw std::runtime_error("unsupported texture type: "+std::string(type));
   }
 
   Device::RTMaterial SingleRayDevice::rtNewMaterial(const char* type)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if      (!strcasecmp(type,"Matte")         ) return (Device::RTMaterial) new ConstructorHandle<Matte,Material>;
     else if (!strcasecmp(type,"Plastic")       ) return (Device::RTMaterial) new ConstructorHandle<Plastic,Material>;
     else if (!strcasecmp(type,"Dielectric")    ) return (Device::RTMaterial) new ConstructorHandle<Dielectric,Material>;
@@ -256,7 +300,7 @@ namespace embree
   }
 
   Device::RTShape SingleRayDevice::rtNewShape(const char* type) {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if      (!strcasecmp(type,"trianglemesh")) return (Device::RTShape) new CreateHandle<TriangleMesh,Shape>;
     else if (!strcasecmp(type,"triangle")    ) return (Device::RTShape) new ConstructorHandle<Triangle,Shape>;
     else if (!strcasecmp(type,"sphere")      ) return (Device::RTShape) new ConstructorHandle<Sphere,Shape>;
@@ -266,7 +310,7 @@ namespace embree
 
   Device::RTLight SingleRayDevice::rtNewLight(const char* type)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if      (!strcasecmp(type,"ambientlight"    )) return (Device::RTLight) new ConstructorHandle<AmbientLight,Light>;
     else if (!strcasecmp(type,"pointlight"      )) return (Device::RTLight) new ConstructorHandle<PointLight,Light>;
     else if (!strcasecmp(type,"spotlight"       )) return (Device::RTLight) new ConstructorHandle<SpotLight,Light>;
@@ -281,18 +325,30 @@ namespace embree
                                                            Device::RTMaterial material_i, 
                                                            const float* transform)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     Ref<InstanceHandle<Shape> > shape = castHandle<InstanceHandle<Shape>    >(shape_i   ,"shape"   );
     Ref<InstanceHandle<Material> > material = castHandle<InstanceHandle<Material> >(material_i,"material");
     AffineSpace3f space = transform ? copyFromArray(transform) : AffineSpace3f(one);
     return (Device::RTPrimitive) new PrimitiveHandle(shape,material,space);
   }
 
+  void SingleRayDevice::rtNewShapePrimitives(size_t num, const Device::RTShape* shapes, const Device::RTMaterial* materials, 
+                                             const float* transforms, Device::RTPrimitive* prims)
+  {
+    RT_CONCURRENT_COMMAND_HEADER;
+    for (size_t i=0; i<num; i++) {
+      Ref<InstanceHandle<Shape> > shape = castHandle<InstanceHandle<Shape>    >(shapes[i]   ,"shape"   );
+      Ref<InstanceHandle<Material> > material = castHandle<InstanceHandle<Material> >(materials[i],"material");
+      AffineSpace3f space = transforms ? copyFromArray(transforms+12*i) : AffineSpace3f(one);
+      prims[i] = (Device::RTPrimitive) new PrimitiveHandle(shape,material,space);
+    }
+  }
+
   Device::RTPrimitive SingleRayDevice::rtNewLightPrimitive(Device::RTLight light_i, 
                                                         Device::RTMaterial material_i, 
                                                         const float* transform)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     Ref<InstanceHandle<Light> > light = castHandle<InstanceHandle<Light> >(light_i,"light");
     Ref<InstanceHandle<Material> > material = NULL;
     if (material_i) material = castHandle<InstanceHandle<Material> >(material_i,"material");
@@ -302,15 +358,16 @@ namespace embree
 
   Device::RTPrimitive SingleRayDevice::rtTransformPrimitive(Device::RTPrimitive primitive, const float* transform) 
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     Ref<PrimitiveHandle> prim = dynamic_cast<PrimitiveHandle*>((_RTHandle*)primitive);
     AffineSpace3f space = transform ? copyFromArray(transform) : AffineSpace3f(one);
+    Lock<MutexSys> lockPrim(prim->mutex);
     return (Device::RTPrimitive) new PrimitiveHandle(space, prim);
   }
   
   Device::RTScene SingleRayDevice::rtNewScene(const char* type) 
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if      (!strcmp(type,"default" )) return (Device::RTScene) new BackendSceneFlat::Handle;
     else if (!strcmp(type,"flat"    )) return (Device::RTScene) new BackendSceneFlat::Handle;
     //else if (!strcmp(type,"twolevel")) return (Device::RTScene) new BackendSceneInstancing::Handle;
@@ -319,23 +376,38 @@ namespace embree
      
   void SingleRayDevice::rtSetPrimitive(RTScene hscene, size_t slot, RTPrimitive hprim) 
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     Ref<BackendScene::Handle> scene = castHandle<BackendScene::Handle>(hscene,"scene");
+    Lock<MutexSys> lockScene(scene->mutex);
     if (hprim == NULL) { scene->setPrimitive(slot,NULL); return; }
     Ref<PrimitiveHandle> prim = dynamic_cast<PrimitiveHandle*>((_RTHandle*)hprim);
+    Lock<MutexSys> lockPrim(prim->mutex);
     scene->setPrimitive(slot,prim);
   }
 
+  void SingleRayDevice::rtSetPrimitives(RTScene hscene, size_t slot, size_t num, const RTPrimitive* hprims) 
+  {
+    RT_CONCURRENT_COMMAND_HEADER;
+    Ref<BackendScene::Handle> scene = castHandle<BackendScene::Handle>(hscene,"scene");
+    Lock<MutexSys> lockScene(scene->mutex);
+    for (size_t i=0; i<num; i++) {
+      if (hprims[i] == NULL) { scene->setPrimitive(slot+i,NULL); continue; }
+      Ref<PrimitiveHandle> prim = dynamic_cast<PrimitiveHandle*>((_RTHandle*)hprims[i]);
+      Lock<MutexSys> lockPrim(prim->mutex);
+      scene->setPrimitive(slot+i,prim);
+    }
+  }
+
   Device::RTToneMapper SingleRayDevice::rtNewToneMapper(const char* type)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if      (!strcasecmp(type,"default")) return (Device::RTToneMapper) new ConstructorHandle<DefaultToneMapper,ToneMapper>;
     else throw std::runtime_error("unknown tonemapper type: "+std::string(type));
   }
 
   Device::RTRenderer SingleRayDevice::rtNewRenderer(const char* type)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!strcasecmp(type,"debug"     )) return (Device::RTRenderer) new ConstructorHandle<DebugRenderer,Renderer>;
     if (!strcasecmp(type,"pathtracer")) {
       ConstructorHandle<IntegratorRenderer,Renderer>* handle = new ConstructorHandle<IntegratorRenderer,Renderer>;
@@ -347,23 +419,27 @@ namespace embree
 
   Device::RTFrameBuffer SingleRayDevice::rtNewFrameBuffer(const char* type, size_t width, size_t height, size_t buffers, void** ptrs) 
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     Ref<SwapChain> swapchain = null;
     if      (!strcasecmp(type,"RGB_FLOAT32")) swapchain = new SwapChain(type,width,height,buffers,ptrs,FrameBufferRGBFloat32::create);
     else if (!strcasecmp(type,"RGBA8"      )) swapchain = new SwapChain(type,width,height,buffers,ptrs,FrameBufferRGBA8     ::create);
     else if (!strcasecmp(type,"RGB8"       )) swapchain = new SwapChain(type,width,height,buffers,ptrs,FrameBufferRGB8      ::create);
+    else if (!strcasecmp(type,"RGBA_FLOAT16")) swapchain = new SwapChain(type,width,height,buffers,ptrs,FrameBufferRGBAFloat16::create);
     else throw std::runtime_error("unknown framebuffer type: "+std::string(type));
     return (Device::RTFrameBuffer) new ConstHandle<SwapChain>(swapchain);
   }
 
-  void* SingleRayDevice::rtMapFrameBuffer(Device::RTFrameBuffer frameBuffer_i, int bufID) 
+  void* SingleRayDevice::rtMapFrameBuffer(Device::RTFrameBuffer frameBuffer_i, int bufID, const char* channel) 
   {
     RT_COMMAND_HEADER;
     Ref<ConstHandle<SwapChain> > frameBuffer = castHandle<ConstHandle<SwapChain> >(frameBuffer_i,"framebuffer");
     Ref<SwapChain> instance = frameBuffer->getInstance();
     if (bufID < 0) bufID = instance->id();
     instance->buffer(bufID)->wait();
-    return instance->buffer(bufID)->getData();
+    if (!channel || !strcasecmp(channel,"color"))
+      return instance->buffer(bufID)->getData();
+    if (!instance->aovs()) throw std::runtime_error("framebuffer channel not rendered: "+std::string(channel));
+    return instance->aovs()->map(AOVBuffer::channel(channel));
   }
 
   void SingleRayDevice::rtUnmapFrameBuffer(Device::RTFrameBuffer frameBuffer_i, int bufID) 
@@ -392,101 +468,115 @@ namespace embree
   *******************************************************************/
 
   void SingleRayDevice::rtSetBool1(Device::RTHandle handle, const char* property, bool x) {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x));
   }
 
   void SingleRayDevice::rtSetBool2(Device::RTHandle handle, const char* property, bool x, bool y)  {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x,y));
   }
 
   void SingleRayDevice::rtSetBool3(Device::RTHandle handle, const char* property, bool x, bool y, bool z) {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x,y,z));
   }
 
   void SingleRayDevice::rtSetBool4(Device::RTHandle handle, const char* property, bool x, bool y, bool z, bool w)  {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x,y,z,w));
   }
 
   void SingleRayDevice::rtSetInt1(Device::RTHandle handle, const char* property, int x)  {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) {
+      Lock<MutexSys> lock(mutex);
       if      (!strcmp(property,"serverID"   )) g_serverID = x;
       else if (!strcmp(property,"serverCount")) g_serverCount = x;
       return;
     }
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x));
   }
 
   void SingleRayDevice::rtSetInt2(Device::RTHandle handle, const char* property, int x, int y)  {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x,y));
   }
 
   void SingleRayDevice::rtSetInt3(Device::RTHandle handle, const char* property, int x, int y, int z)  {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x,y,z));
   }
 
   void SingleRayDevice::rtSetInt4(Device::RTHandle handle, const char* property, int x, int y, int z, int w)  {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x,y,z,w));
   }
 
   void SingleRayDevice::rtSetFloat1(Device::RTHandle handle, const char* property, float x)  {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x));
   }
 
   void SingleRayDevice::rtSetFloat2(Device::RTHandle handle, const char* property, float x, float y)  {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x,y));
   }
 
   void SingleRayDevice::rtSetFloat3(Device::RTHandle handle, const char* property, float x, float y, float z)  {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x,y,z));
   }
 
   void SingleRayDevice::rtSetFloat4(Device::RTHandle handle, const char* property, float x, float y, float z, float w)  {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(x,y,z,w));
   }
 
   void SingleRayDevice::rtSetArray(Device::RTHandle handle_i, const char* property, const char* type, Device::RTData data_i, size_t size, size_t stride, size_t ofs)
   {
 
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     Ref<ConstHandle<Data> > data    = castHandle<ConstHandle<Data> >(data_i,"data");
     _RTHandle* handle = (_RTHandle*)handle_i;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     if      (!strcasecmp(type,"bool1" )) handle->set(property,Variant(data->getInstance(),Variant::BOOL1 ,size,stride == size_t(-1) ? 1*sizeof(bool ) : stride, ofs));
     else if (!strcasecmp(type,"bool2" )) handle->set(property,Variant(data->getInstance(),Variant::BOOL2 ,size,stride == size_t(-1) ? 2*sizeof(bool ) : stride, ofs));
     else if (!strcasecmp(type,"bool3" )) handle->set(property,Variant(data->getInstance(),Variant::BOOL3 ,size,stride == size_t(-1) ? 3*sizeof(bool ) : stride, ofs));
@@ -503,16 +593,18 @@ namespace embree
   }
 
   void SingleRayDevice::rtSetString(Device::RTHandle handle, const char* property, const char* str) {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(str));
   }
 
   void SingleRayDevice::rtSetImage(Device::RTHandle handle, const char* property, Device::RTImage img) {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     if (ConstHandle<Image>* image = dynamic_cast<ConstHandle<Image>*>((_RTHandle*)img)) {
       if (!image->getInstance()) throw std::runtime_error("invalid image value");
       ((_RTHandle*)handle)->set(property,Variant(image->getInstance()));
@@ -521,30 +613,42 @@ namespace embree
   }
 
   void SingleRayDevice::rtSetTexture(Device::RTHandle handle, const char* property, Device::RTTexture tex) {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     Ref<InstanceHandle<Texture> > texture = castHandle<InstanceHandle<Texture> >(tex,"texture");
     ((_RTHandle*)handle)->set(property,Variant(texture->getInstance()));
   }
 
   void SingleRayDevice::rtSetTransform(Device::RTHandle handle, const char* property, const float* transform)
   {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!property) throw std::runtime_error("invalid property");
     if (!handle  ) return;
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->set(property,Variant(copyFromArray(transform)));
   }
 
   void SingleRayDevice::rtClear(Device::RTHandle handle) {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!handle) throw std::runtime_error("invalid handle");
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->clear();
   }
 
   void SingleRayDevice::rtCommit(Device::RTHandle handle) {
-    RT_COMMAND_HEADER;
+    RT_CONCURRENT_COMMAND_HEADER;
     if (!handle) throw std::runtime_error("invalid handle");
+
+    /*! building a scene enters the ray tracing core, thus is serialized with rendering */
+    if (dynamic_cast<BackendScene::Handle*>((_RTHandle*)handle)) {
+      Lock<MutexSys> lock(mutex);
+      Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
+      ((_RTHandle*)handle)->create();
+      return;
+    }
+    Lock<MutexSys> lockHandle(((_RTHandle*)handle)->mutex);
     ((_RTHandle*)handle)->create();
   }
 
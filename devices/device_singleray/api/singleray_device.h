@@ -48,14 +48,16 @@ namespace embree
     RTShape rtNewShape(const char* type);
     RTLight rtNewLight(const char* type);
     RTPrimitive rtNewShapePrimitive(RTShape shape, RTMaterial material, const float* transform);
+    void rtNewShapePrimitives(size_t num, const RTShape* shapes, const RTMaterial* materials, const float* transforms, RTPrimitive* prims);
     RTPrimitive rtNewLightPrimitive(RTLight light, RTMaterial material, const float* transform);
     RTPrimitive rtTransformPrimitive(RTPrimitive prim, const float* transform);
     RTScene rtNewScene(const char* type);
     void rtSetPrimitive(RTScene scene, size_t slot, RTPrimitive prim);
+    void rtSetPrimitives(RTScene scene, size_t slot, size_t num, const RTPrimitive* prims);
     RTToneMapper rtNewToneMapper(const char* type);
     RTRenderer rtNewRenderer(const char* type);
     RTFrameBuffer rtNewFrameBuffer(const char* type, size_t width, size_t height, size_t buffers, void** ptrs);
-    void* rtMapFrameBuffer(RTFrameBuffer frameBuffer, int bufID);
+    void* rtMapFrameBuffer(RTFrameBuffer frameBuffer, int bufID, const char* channel);
     void rtUnmapFrameBuffer(RTFrameBuffer frameBuffer, int bufID);
     void rtSwapBuffers(RTFrameBuffer frameBuffer);
     void rtIncRef(RTHandle handle);
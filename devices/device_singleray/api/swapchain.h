@@ -95,12 +95,31 @@ namespace embree
       return _accu->update(x,y,color,weight,accumulate);
     }
 
+    /*! selects the representation of the accumulation buffer, switching discards the accumulated samples */
+    void setCompactAccu(bool compact) {
+      if (_accu->isCompact() != compact) _accu = new AccuBuffer(width,height,compact);
+    }
+
+    /*! continues the accumulation in the default representation once the compact one is saturated */
+    void expandSaturatedAccu() {
+      if (_accu->isSaturated()) _accu = _accu->expand();
+    }
+
+    /*! enables the auxiliary channels, allocated on first use */
+    Ref<AOVBuffer>& enableAOVs() {
+      if (!_aovs) _aovs = new AOVBuffer(width,height);
+      return _aovs;
+    }
+
     /*! returns framebuffer format */
     __forceinline std::string getFormat() const { return format; }
 
     /*! returns accumulation buffer */
     __forceinline Ref<AccuBuffer>& accu() { return _accu; }
 
+    /*! returns buffer of auxiliary channels, NULL if not enabled */
+    __forceinline Ref<AOVBuffer>& aovs() { return _aovs; }
+
     /*! returns ID of current buffer */
     __forceinline size_t id() const { return buf; }
 
@@ -119,6 +138,7 @@ namespace embree
     
   private:
     Ref<AccuBuffer> _accu;                    //!< special accumulation buffer
+    Ref<AOVBuffer> _aovs;                     //!< auxiliary channels, NULL if not enabled
     std::vector<Ref<FrameBuffer> > _buffer;   //!< the swapchain frame buffers
   };
 }
@@ -90,6 +90,41 @@ namespace embree {
 
         }
 
+        /*! evaluate the BRDF for a packet of incoming light directions */
+        virtual ColorN evalN(const Vector3f               & wo,    /*! outgoing light direction          */
+                             const DifferentialGeometry& dg,    /*! shade location on a surface       */
+                             const Vector3fN              & wi,    /*! incoming light directions         */
+                             const simdb               & valid) /*! active elements of the packet     */ const {
+
+            /*! by default we evaluate each active element individually */
+            ColorN c(zero);
+            for (int m = (int)movemask(valid); m; m &= m-1) {
+                const size_t i = __bsf(m);
+                setColor(c, i, eval(wo, dg, getVector3f(wi, i)));
+            }
+            return(c);
+
+        }
+
+        /*! sample the BRDF for a packet of sample locations */
+        virtual ColorN sampleN(const Vector3f               & wo,    /*! outgoing light direction          */
+                               const DifferentialGeometry& dg,    /*! shade location on a surface       */
+                               Vector3fN                 & wi,    /*! sampled light directions          */
+                               simdf                     & pdf,   /*! PDF of the sampled directions     */
+                               const Vec2fN              & s,     /*! sample locations given by caller  */
+                               const simdb               & valid) /*! active elements of the packet     */ const {
+
+            /*! by default we sample each active element individually */
+            ColorN c(zero); pdf = zero;
+            for (int m = (int)movemask(valid); m; m &= m-1) {
+                const size_t i = __bsf(m);
+                Sample3f wi1; setColor(c, i, sample(wo, dg, wi1, Vec2f(s.x[i], s.y[i])));
+                setVector3f(wi, i, wi1.value); pdf[i] = wi1.pdf;
+            }
+            return(c);
+
+        }
+
         /*! BRDF type hint to the integrator */
         BRDFType type;
 
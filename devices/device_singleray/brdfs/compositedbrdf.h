@@ -76,6 +76,28 @@ namespace embree
       return c;
     }
 
+    /*! Evaluates all BRDF components for a packet of incoming light directions. */
+    ColorN evalN(const Vector3f& wo, const DifferentialGeometry& dg, const Vector3fN& wi, const simdb& valid, BRDFType type) const
+    {
+      ColorN c = zero;
+      for (size_t i=0; i<size(); i++)
+        if (BRDFs[i]->type & type) c += BRDFs[i]->evalN(wo,dg,wi,valid);
+      return c;
+    }
+
+    /*! Evaluates the sampling PDF of all BRDF components of the
+     *  specified type. Each component is assumed to be selected with
+     *  equal probability. */
+    float pdf(const Vector3f& wo, const DifferentialGeometry& dg, const Vector3f& wi, BRDFType type) const
+    {
+      float p = 0.0f; size_t num = 0;
+      for (size_t i=0; i<size(); i++) {
+        if (!(BRDFs[i]->type & type)) continue;
+        p += BRDFs[i]->pdf(wo,dg,wi); num++;
+      }
+      return num ? p*rcp(float(num)) : 0.0f;
+    }
+
     /*! Determine if the composited BRDF contains a component of the specified type. */
     bool has(const BRDFType &type) {
 
@@ -142,6 +164,59 @@ namespace embree
       return colors[i];
     }
 
+    /*! Samples the composited BRDF for a packet of sample
+     *  locations. Each BRDF component is sampled for the whole packet
+     *  and the component selection is performed per element like in
+     *  the single sample version. */
+    ColorN sampleN(const Vector3f            & wo,          /*!< Direction light is reflected into.                    */
+                   const DifferentialGeometry& dg,          /*!< Shade location on a surface to sample the BRDF at.    */
+                   Vector3fN                 & wi_o,        /*!< Returns sampled incoming light directions.            */
+                   simdf                     & pdf_o,       /*!< Returns the PDF of the sampled directions.            */
+                   BRDFType                    type_o[],    /*!< Returns the type flags of the sampled components.     */
+                   const Vec2fN              & s,           /*!< Sample locations for BRDF are provided by the caller. */
+                   const simdf               & ss,          /*!< Samples to select the BRDF component.                 */
+                   const simdb               & valid,       /*!< Active elements of the packet.                        */
+                   const BRDFType            & type = ALL)  /*!< The type of BRDF components to consider.              */ const
+    {
+      /*! sample each BRDF component and build probability distribution */
+      simdf f[maxComponents];
+      ColorN colors[maxComponents];
+      Vector3fN samples[maxComponents];
+      simdf pdfs[maxComponents];
+      simdb ok[maxComponents];
+      simdf sum = zero;
+      for (size_t i = 0; i<size(); i++)
+      {
+        ok[i] = simdb(False);
+        if (!(BRDFs[i]->type & type)) continue;
+        colors[i] = BRDFs[i]->sampleN(wo, dg, samples[i], pdfs[i], s, valid);
+        const simdf lum = colors[i].x + colors[i].y + colors[i].z;
+        ok[i] = valid & (lum != simdf(zero)) & (pdfs[i] > simdf(zero));
+        f[i] = select(ok[i], lum * rcp(select(ok[i],pdfs[i],simdf(one))), simdf(zero));
+        sum += f[i];
+      }
+
+      /*! select the first component whose accumulated probability
+       *  exceeds the selection sample, falling back to the last valid one */
+      const simdf rcpSum = rcp(select(sum > simdf(zero), sum, simdf(one)));
+      ColorN c = zero; wi_o = Vector3fN(zero); pdf_o = zero;
+      for (size_t k=0; k<SIMD_WIDTH; k++) type_o[k] = (BRDFType)0;
+      simdb done(false); simdf d = zero;
+      for (size_t i = 0; i<size(); i++)
+      {
+        const simdb m = ok[i] & !done;
+        if (none(m)) continue;
+        const simdf fi = f[i] * rcpSum;
+        c.x = select(m, colors[i].x, c.x); c.y = select(m, colors[i].y, c.y); c.z = select(m, colors[i].z, c.z);
+        wi_o.x = select(m, samples[i].x, wi_o.x); wi_o.y = select(m, samples[i].y, wi_o.y); wi_o.z = select(m, samples[i].z, wi_o.z);
+        pdf_o = select(m, pdfs[i] * fi, pdf_o);
+        for (int b = (int)movemask(m); b; b &= b-1) type_o[__bsf(b)] = BRDFs[i]->type;
+        d += fi;
+        done |= m & (ss <= d);
+      }
+      return c;
+    }
+
   private:
 
     /*! Data storage. Has to be at the beginning of the class due to alignment. */
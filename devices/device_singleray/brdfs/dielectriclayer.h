@@ -79,12 +79,11 @@ namespace embree
     float pdf(const Vector3f& wo, const DifferentialGeometry& dg, const Vector3f& wi) const
     {
       float cosThetaO = dot(wo,dg.Ns);
-      if (cosThetaO <= 0.0f) return 0.0f;
+      float cosThetaI = dot(wi,dg.Ns);
+      if (cosThetaI <= 0.0f || cosThetaO <= 0.0f) return 0.0f;
       Sample3f wo1 = refract(wo,dg.Ns,etait,cosThetaO);
-      Sample3f wi1(zero); float p = ground.pdf(-wo1.value,dg,wi1);
-      Sample3f wi0 = refract(-wi1.value,-dg.Ns,etati);
-      if (wi0.pdf == 0.0f) return zero;
-      return p;
+      Sample3f wi1 = refract(wi,dg.Ns,etait,cosThetaI);
+      return ground.pdf(-wo1.value,dg,-wi1.value);
     }
 
   private:
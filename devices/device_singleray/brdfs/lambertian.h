@@ -44,6 +44,11 @@ namespace embree
       return cosineSampleHemispherePDF(wi,dg.Ns);
     }
 
+    ColorN evalN(const Vector3f& wo, const DifferentialGeometry& dg, const Vector3fN& wi, const simdb& valid) const {
+      const simdf cosTheta = select(valid,clamp(dot(wi,splat(dg.Ns))),simdf(zero));
+      return splat(R * (1.0f/float(pi))) * cosTheta;
+    }
+
   private:
 
     /*! The reflectivity parameter. The vale 0 means no reflection,
@@ -35,6 +35,12 @@ namespace embree
                      const Vec2f& sample, /*!< The lens sample in [0,1) for depth of field. */
                      Ray& ray_o)          /*!< To return the ray. */ const = 0;
 
+    /*! Projects a point onto the image plane. Returns false if the
+     *  point cannot be seen by the camera. */
+    virtual bool project(const Vector3f& p, /*!< The point to project. */
+                         Vec2f& pixel,      /*!< To return the pixel location in the range from 0 to 1. */
+                         float& dist)       /*!< To return the distance of the point to the eye. */ const { return false; }
+
     /*! Field of view. */
     float angle;
   };
@@ -33,16 +33,26 @@ namespace embree
       aspectRatio = parms.getFloat("aspectRatio",1.0f);
       Vector3f W     = xfmVector(local2world, Vector3f(-0.5f*aspectRatio,-0.5f,0.5f*rcp(tanf(deg2rad(0.5f*angle)))));
       pixel2world = AffineSpace3f(aspectRatio*local2world.l.vx,local2world.l.vy,W,local2world.p);
+      world2pixel = rcp(pixel2world);
     }
 
     void ray(const Vec2f& pixel, const Vec2f& sample, Ray& ray_o) const {
       new (&ray_o) Ray(pixel2world.p,normalize(pixel.x*pixel2world.l.vx + (1.0f-pixel.y)*pixel2world.l.vy + pixel2world.l.vz));
     }
 
+    bool project(const Vector3f& p, Vec2f& pixel, float& dist) const {
+      const Vector3f c = xfmPoint(world2pixel,p);
+      if (c.z <= 0.0f) return false;
+      pixel = Vec2f(c.x*rcp(c.z),1.0f-c.y*rcp(c.z));
+      dist = length(p-pixel2world.p);
+      return true;
+    }
+
   protected:
     float aspectRatio;
     AffineSpace3f local2world;    //!< transformation from camera space to world space
     AffineSpace3f pixel2world;    //!< special transformation to generate rays
+    AffineSpace3f world2pixel;    //!< inverse of pixel2world to project points
   };
 }
 
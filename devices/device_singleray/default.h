@@ -44,6 +44,25 @@ namespace embree
   /* vertex and triangle layout */
   struct RTCVertex   { float x,y,z,a; };
   struct RTCTriangle { int v0, v1, v2; };
+
+  /* SoA packets of the widest SIMD type for packetized shading */
+  typedef Vec2<simdf> Vec2fN;
+  typedef Vec3<simdf> Vector3fN;
+  typedef Vec3<simdf> ColorN;
+
+  /*! Broadcasts a vector to all elements of a packet. */
+  __forceinline Vector3fN splat(const Vector3f& a) { return Vector3fN(simdf(a.x),simdf(a.y),simdf(a.z)); }
+
+  /*! Broadcasts a color to all elements of a packet. */
+  __forceinline ColorN splat(const Color& a) { return ColorN(simdf(a.r),simdf(a.g),simdf(a.b)); }
+
+  /*! Reads the i'th element of a packet. */
+  __forceinline Vector3f getVector3f(const Vector3fN& a, size_t i) { return Vector3f(a.x[i],a.y[i],a.z[i]); }
+  __forceinline Color    getColor   (const ColorN&    a, size_t i) { return Color   (a.x[i],a.y[i],a.z[i]); }
+
+  /*! Writes the i'th element of a packet. */
+  __forceinline void setVector3f(Vector3fN& a, size_t i, const Vector3f& v) { a.x[i] = v.x; a.y[i] = v.y; a.z[i] = v.z; }
+  __forceinline void setColor   (ColorN&    a, size_t i, const Color&    c) { a.x[i] = c.r; a.y[i] = c.g; a.z[i] = c.b; }
 };
 
 #endif
@@ -19,18 +19,51 @@
 
 #include "renderers/ray.h"
 #include "../api/scene.h"
+#include "../api/framebuffer.h"
 #include "../samplers/sampler.h"
 
 namespace embree
 {
+  /*! Reasons for a path to terminate. */
+  enum PathTermination {
+    PATH_ESCAPED = 0,          //!< ray left the scene
+    PATH_ABSORBED = 1,         //!< BRDF sampling found no direction to continue
+    PATH_MAX_DEPTH = 2,        //!< maximal recursion depth reached
+    PATH_MIN_CONTRIBUTION = 3, //!< throughput fell below the minimal contribution
+    PATH_ROULETTE = 4,         //!< killed by Russian roulette
+    PATH_CACHED = 5,           //!< terminated into the radiance cache
+    NUM_PATH_TERMINATIONS = 6
+  };
+
+  /*! Number of bins of the path length histogram, the last bin also counts all longer paths. */
+  enum { PATH_LENGTH_BINS = 32 };
+
   /*! Integrator State */
   struct IntegratorState
   {
-    IntegratorState () : sample(NULL), pixel(0.0f,0.0f), numRays(0) {}
+    IntegratorState () : sample(NULL), pixel(0.0f,0.0f), numRays(0), aov(NULL), numOccluderTests(0), numOccluderHits(0) 
+    {
+      for (size_t i=0; i<PATH_LENGTH_BINS; i++) pathLengths[i] = 0;
+      for (size_t i=0; i<NUM_PATH_TERMINATIONS; i++) pathTerminations[i] = 0;
+    }
+
+    /*! Counts a terminated path with the given number of bounces. */
+    __forceinline void terminatePath(size_t depth, PathTermination reason) {
+      pathLengths[min(depth,size_t(PATH_LENGTH_BINS-1))]++;
+      pathTerminations[reason]++;
+    }
+
   public:
     const PrecomputedSample* sample;  /*!< Sampler used to generate (pseudo) random numbers. */
     Vec2f                    pixel;   /*!< normalized pixel location on screen */
     size_t                   numRays; /*!< Used to count the number of rays shot.            */
+    AOVSample*               aov;     /*!< Auxiliary outputs of the primary hit, NULL if not rendered. */
+    RayDifferentials         differentials; /*!< Pixel footprint of the current ray of the path. */
+    size_t                   numOccluderTests; /*!< Number of shadow rays tested against a cached blocker. */
+    size_t                   numOccluderHits;  /*!< Number of shadow rays blocked by the cached blocker. */
+    std::vector<Occluder>    occluders;        /*!< Last blocker per light found by this thread in the current pass. */
+    size_t                   pathLengths[PATH_LENGTH_BINS];            /*!< Histogram of the bounces of terminated paths. */
+    size_t                   pathTerminations[NUM_PATH_TERMINATIONS];  /*!< Histogram of the termination reasons of paths. */
   };
   
   /*! Interface to different integrators. The task of the integrator
@@ -45,6 +78,13 @@ namespace embree
     /*! Allows the integrator to register required samples at the sampler. */
     virtual void requestSamples(Ref<SamplerFactory>& samplerFactory, const Ref<BackendScene>& scene) {}
 
+    /*! Called before a render pass starts, allows the integrator to
+     *  attach state to the scene that persists across frames. */
+    virtual void beginPass(Ref<BackendScene> scene) {}
+
+    /*! Called after all tiles of a render pass are finished. */
+    virtual void endPass(Ref<BackendScene> scene) {}
+
     /*! Computes the radiance arriving at the origin of the ray from
      *  the ray direction. */
     virtual Color Li(      Ray&               ray,     /*!< Ray to compute the radiance along.                */
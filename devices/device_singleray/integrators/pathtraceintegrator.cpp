@@ -19,20 +19,47 @@
 namespace embree
 {
   PathTraceIntegrator::PathTraceIntegrator(const Parms& parms)
-    : lightSampleID(-1), firstScatterSampleID(-1), firstScatterTypeSampleID(-1), sampleLightForGlossy(false)
+    : sampleLightForGlossy(false), mis(MIS_NONE), lightSampleID(-1), firstScatterSampleID(-1), firstScatterTypeSampleID(-1), cacheSampleID(-1), rouletteSampleID(-1),
+      splitSampleID(-1), splitTypeSampleID(-1)
   {
     maxDepth        = parms.getInt  ("maxDepth"       ,10    );
     minContribution = parms.getFloat("minContribution",0.01f );
     epsilon         = parms.getFloat("epsilon"        ,32.0f)*float(ulp);
     backplate       = parms.getImage("backplate");
     sampleLightForGlossy = parms.getInt  ("sampleLightForGlossy",0);
+    mis             = clamp(parms.getInt("mis",MIS_NONE),int(MIS_NONE),int(MIS_POWER));
+
+    /*! path guiding combines guide and BRDF samples with light samples, thus requires MIS */
+    guiding               = parms.getInt  ("guiding",0) != 0;
+    guideFraction         = clamp(parms.getFloat("guiding.fraction",0.5f),0.0f,1.0f);
+    guideRounds           = max(0,parms.getInt("guiding.rounds",10));
+    guideSpatialThreshold = max(1.0f,parms.getFloat("guiding.spatialThreshold",12000.0f));
+    if (guiding && !mis) mis = MIS_BALANCE;
+
+    /*! the radiance cache is biased, thus only used for previews */
+    caching         = parms.getInt  ("cache",0) != 0;
+    cacheDepth      = max(1,parms.getInt("cache.depth",1));
+    cacheMinSamples = max(1,parms.getInt("cache.minSamples",16));
+    cacheUpdate     = clamp(parms.getFloat("cache.update",0.1f),0.0f,1.0f);
+    cacheScale      = max(0.0f,parms.getFloat("cache.scale",8.0f));
+    cacheSize       = clamp(parms.getInt("cache.size",20),10,30);
+
+    /*! shadow rays first retest the primitive that blocked the previous shadow ray to the same light */
+    occluderCache   = parms.getInt  ("occluderCache",0) != 0;
+
+    /*! Russian roulette from the given depth on replaces the biased minContribution cutoff, off by default */
+    rouletteDepth   = parms.getInt  ("roulette.depth",-1);
+
+    /*! multiple light samples and BRDF samples at the first hit are evaluated as packets */
+    lightSamples    = clamp(parms.getInt("lightSamples",1),1,int(SIMD_WIDTH));
+    brdfSamples     = clamp(parms.getInt("brdfSamples",1),1,int(SIMD_WIDTH));
   }
   
   void PathTraceIntegrator::requestSamples(Ref<SamplerFactory>& samplerFactory, const Ref<BackendScene>& scene)
   {
     precomputedLightSampleID.resize(scene->allLights.size());
 
-    lightSampleID = samplerFactory->request2D();
+    lightSampleID = samplerFactory->request2D((int)lightSamples);
     for (size_t i=0; i<scene->allLights.size(); i++) {
       precomputedLightSampleID[i] = -1;
       if (scene->allLights[i]->precompute())
@@ -40,13 +67,35 @@ namespace embree
     }
     firstScatterSampleID = samplerFactory->request2D((int)maxDepth);
     firstScatterTypeSampleID = samplerFactory->request1D((int)maxDepth);
+    cacheSampleID = caching ? samplerFactory->request1D((int)maxDepth) : -1;
+    rouletteSampleID = rouletteDepth >= 0 ? samplerFactory->request1D((int)maxDepth) : -1;
+    splitSampleID = brdfSamples > 1 ? samplerFactory->request2D((int)brdfSamples) : -1;
+    splitTypeSampleID = brdfSamples > 1 ? samplerFactory->request1D((int)brdfSamples) : -1;
+  }
+
+  void PathTraceIntegrator::beginPass(Ref<BackendScene> scene)
+  {
+    /*! the guide is kept with the scene to continue training across frames */
+    if (guiding && !scene->guide) scene->guide = new PathGuide(guideSpatialThreshold,guideRounds);
+
+    /*! the radiance cache is kept with the scene and stays valid while the scene is unchanged */
+    if (caching && !scene->cache) scene->cache = new RadianceCache(cacheSize,cacheMinSamples);  }
+
+  void PathTraceIntegrator::endPass(Ref<BackendScene> scene) {
+    if (guiding && scene->guide) scene->guide->endPass();
   }
 
   Color PathTraceIntegrator::Li(LightPath& lightPath, const Ref<BackendScene>& scene, IntegratorState& state)
   {
-    /*! Terminate path if too long or contribution too low. */
-    if (lightPath.depth >= maxDepth || reduce_max(lightPath.throughput) < minContribution)
+    /*! Terminate path if too long or, without Russian roulette, if the contribution is too low. */
+    if (lightPath.depth >= maxDepth) {
+      state.terminatePath(lightPath.depth,PATH_MAX_DEPTH);
       return zero;
+    }
+    if (rouletteDepth < 0 && reduce_max(lightPath.throughput) < minContribution) {
+      state.terminatePath(lightPath.depth,PATH_MIN_CONTRIBUTION);
+      return zero;
+    }
 
     /*! Traverse ray. */
     DifferentialGeometry dg;
@@ -54,13 +103,25 @@ namespace embree
     rtcIntersect(scene->scene,(RTCRay&)lightPath.lastRay);
     scene->postIntersect(lightPath.lastRay,dg);
     state.numRays++;
+
+    /*! Compute the texture footprint and transfer the differentials to
+     *  the hit. The directional part is kept unchanged at scattering
+     *  events, which slightly underestimates the spread of glossy paths. */
+    if (lightPath.lastRay) {
+      dg.computeDifferentials(lightPath.lastRay.org,lightPath.lastRay.dir,state.differentials);
+      state.differentials.dOdx = dg.dPdx;
+      state.differentials.dOdy = dg.dPdy;
+    }
     //return Color(dg.st.x,dg.st.y,0.0f);
 
     Color L = zero;
     const Vector3f wo = -lightPath.lastRay.dir;
     BRDFType directLightingBRDFTypes = (BRDFType)(DIFFUSE); 
     BRDFType giBRDFTypes = (BRDFType)(ALL);
-    if (sampleLightForGlossy) {
+    if (mis) {
+      directLightingBRDFTypes = (BRDFType)(DIFFUSE|GLOSSY);
+    }
+    else if (sampleLightForGlossy) {
       directLightingBRDFTypes = (BRDFType)(DIFFUSE|GLOSSY); 
       giBRDFTypes = (BRDFType)(SPECULAR);
     }
@@ -76,8 +137,10 @@ namespace embree
       else {
         if (!lightPath.ignoreVisibleLights)
           for (size_t i=0; i<scene->envLights.size(); i++)
-            L += scene->envLights[i]->Le(wo);
+            L += scene->envLights[i]->Le(wo) * brdfSampleWeight(lightPath, scene->envLights[i].ptr);
       }
+      if (lightPath.depth == 0 && state.aov) state.aov->direct = L;
+      state.terminatePath(lightPath.depth,PATH_ESCAPED);
       return L;
     }
 
@@ -91,34 +154,119 @@ namespace embree
     CompositedBRDF brdfs;
     if (dg.material) dg.material->shade(lightPath.lastRay, lightPath.lastMedium, dg, brdfs);
 
+    /*! Store auxiliary outputs of the primary hit. */
+    if (lightPath.depth == 0 && state.aov) {
+      state.aov->albedo = brdfs.eval(wo, dg, dg.Ns, ALL) * float(pi);
+      state.aov->normal = dg.Ns;
+      state.aov->depth  = lightPath.lastRay.tfar;
+      state.aov->primID = lightPath.lastRay.id0;
+    }
+
+    /*! Path guiding applies to surfaces whose components all take
+     *  part in MIS with light sampling. Until the region of the guide
+     *  learned a distribution only the BRDF is sampled. */
+    PathGuide* guide = scene->guide.ptr;
+    const bool guided = guide && lightPath.depth < maxDepth && brdfs.size() && !brdfs.has((BRDFType)~(DIFFUSE|GLOSSY));
+    const size_t region = guided ? guide->region(dg.P) : 0;
+    const float alpha = guided && guide->learned(region) ? guideFraction : 0.0f;
+
     /*! Add light emitted by hit area light source. */
     if (!lightPath.ignoreVisibleLights && dg.light && !backfacing)
-      L += dg.light->Le(dg,wo);
+      L += dg.light->Le(dg,wo) * brdfSampleWeight(lightPath, dg.light);
 
-    /*! Global illumination. Pick one BRDF component and sample it. */
+    /*! Preview mode. Later bounces at diffuse surfaces return the
+     *  cached radiance, except for a fraction of the paths that get
+     *  traced on to update the cache. */
+    RadianceCache* cache = scene->cache.ptr;
+    const bool cached = cache && lightPath.depth >= cacheDepth && brdfs.size() && !brdfs.has((BRDFType)~DIFFUSE_REFLECTION);
+    const Color Lemitted = L;
+    Color albedo = zero; float cellSize = 0.0f;
+    if (cached) {
+      albedo = brdfs.eval(wo, dg, dg.Ns, DIFFUSE_REFLECTION) * float(pi);
+      cellSize = cacheScale * max(length(dg.dPdx),length(dg.dPdy));
+      Color Lcache;
+      if (state.sample->getFloat(cacheSampleID + lightPath.depth) >= cacheUpdate && cache->lookup(dg.P, dg.Ns, cellSize, Lcache)) {
+        state.terminatePath(lightPath.depth,PATH_CACHED);
+        return L + albedo*Lcache;
+      }
+    }
+
+    /*! Global illumination. Pick one BRDF component and sample it. At
+     *  the first hit a packet of brdfSamples directions can be sampled
+     *  at once, the path is then split into one path per direction. */
+    Color Lindirect = zero;
+    const size_t numScatter = lightPath.depth == 0 && alpha == 0.0f ? brdfSamples : 1;
     if (lightPath.depth < maxDepth)
     {
       /*! sample brdf */
-      Sample3f wi; BRDFType type;
-      Vec2f s  = state.sample->getVec2f(firstScatterSampleID     + lightPath.depth);
-      float ss = state.sample->getFloat(firstScatterTypeSampleID + lightPath.depth);
-      Color c = brdfs.sample(wo, dg, wi, type, s, ss, giBRDFTypes);
+      Color cs[SIMD_WIDTH]; Sample3f wis[SIMD_WIDTH]; BRDFType types[SIMD_WIDTH];
+      if (numScatter > 1)
+      {
+        Vec2fN s; simdf ss;
+        for (size_t j=0; j<numScatter; j++) {
+          const Vec2f sj = state.sample->getVec2f(splitSampleID + j);
+          s.x[j] = sj.x; s.y[j] = sj.y; ss[j] = state.sample->getFloat(splitTypeSampleID + j);
+        }
+        Vector3fN wiN; simdf pdfN;
+        const ColorN cN = brdfs.sampleN(wo, dg, wiN, pdfN, types, s, ss, simdf(step) < simdf(float(numScatter)), giBRDFTypes);
+        for (size_t j=0; j<numScatter; j++) {
+          cs[j] = getColor(cN,j);
+          wis[j] = Sample3f(getVector3f(wiN,j),pdfN[j]);
+        }
+      }
+      else
+      {
+        Vec2f s  = state.sample->getVec2f(firstScatterSampleID     + lightPath.depth);
+        float ss = state.sample->getFloat(firstScatterTypeSampleID + lightPath.depth);
+        if (alpha > 0.0f) cs[0] = sampleGuided(guide, region, alpha, brdfs, wo, dg, wis[0], types[0], s, ss);
+        else              cs[0] = brdfs.sample(wo, dg, wis[0], types[0], s, ss, giBRDFTypes);
+      }
 
-      /*! Continue only if we hit something valid. */
-      if (c != Color(zero) && wi.pdf > 0.0f)
+      for (size_t j=0; j<numScatter; j++)
       {
+        Color c = cs[j]; const Sample3f& wi = wis[j]; const BRDFType type = types[j];
+
         /*! Compute  simple volumetric effect. */
         const Color& transmission = lightPath.lastMedium.transmission;
         if (transmission != Color(one)) c *= pow(transmission,lightPath.lastRay.tfar);
 
-        /*! Tracking medium if we hit a medium interface. */
-        Medium nextMedium = lightPath.lastMedium;
-        if (type & TRANSMISSION) nextMedium = dg.material->nextMedium(lightPath.lastMedium);
+        /*! Russian roulette. The path survives with the probability of
+         *  its Monte Carlo weight and survivors are reweighted, thus dim
+         *  paths end early without bias. */
+        float survival = 1.0f;
+        if (c != Color(zero) && wi.pdf > 0.0f && rouletteDepth >= 0 && lightPath.depth >= size_t(rouletteDepth)) {
+          survival = min(1.0f, reduce_max(lightPath.weight*c)*rcp(wi.pdf));
+          if (state.sample->getFloat(rouletteSampleID + lightPath.depth) >= survival) survival = 0.0f;
+        }
+
+        /*! Continue only if we hit something valid. */
+        if (c == Color(zero) || wi.pdf <= 0.0f) 
+          state.terminatePath(lightPath.depth,PATH_ABSORBED);
+        else if (survival == 0.0f)
+          state.terminatePath(lightPath.depth,PATH_ROULETTE);
+        else
+        {
+          /*! Tracking medium if we hit a medium interface. */
+          Medium nextMedium = lightPath.lastMedium;
+          if (type & TRANSMISSION) nextMedium = dg.material->nextMedium(lightPath.lastMedium);
 
-        /*! Continue the path. */
-        LightPath scatteredPath = lightPath.extended(Ray(dg.P, wi, dg.error*epsilon, inf, lightPath.lastRay.time), 
-                                                     nextMedium, c, (type & directLightingBRDFTypes) != NONE);
-        L += c * Li(scatteredPath, scene, state) * rcp(wi.pdf);
+          /*! Continue the path. With MIS the emission found by the
+           *  scattered ray is weighted against light sampling instead
+           *  of being ignored. */
+          const bool lightSampled = (type & directLightingBRDFTypes) != NONE;
+          const Color sampleWeight = c * rcp(wi.pdf*survival*float(numScatter));
+          LightPath scatteredPath = mis && lightSampled
+            ? lightPath.extended(Ray(dg.P, wi, dg.error*epsilon, inf, lightPath.lastRay.time),
+                                 nextMedium, c, false, &dg, float(numScatter)*(alpha > 0.0f ? wi.pdf : brdfs.pdf(wo, dg, wi, directLightingBRDFTypes)), sampleWeight)
+            : lightPath.extended(Ray(dg.P, wi, dg.error*epsilon, inf, lightPath.lastRay.time), 
+                                 nextMedium, c, lightSampled, NULL, 0.0f, sampleWeight);
+          const Color Lin = Li(scatteredPath, scene, state);
+          Lindirect += Lin * sampleWeight;
+
+          /*! Train the guide with the incident radiance. */
+          if (guided && guide->training())
+            guide->record(region, dg.P, wi, (Lin.r+Lin.g+Lin.b)*(1.0f/3.0f)*rcp(wi.pdf));
+        }
       }
     }
 
@@ -127,39 +275,148 @@ namespace embree
     for (size_t i=0; i<brdfs.size(); i++)
       useDirectLighting |= (brdfs[i]->type & directLightingBRDFTypes) != NONE;
 
-    /*! Direct lighting. Shoot shadow rays to all light sources. */
+    /*! Direct lighting. Shoot shadow rays to all light sources. The
+     *  light samples are gathered into packets to evaluate the BRDF
+     *  for SIMD_WIDTH light directions at once. With multiple samples
+     *  per light all samples of a light are drawn as one packet. */
     if (useDirectLighting)
     {
-      for (size_t i=0; i<scene->allLights.size(); i++)
+      const size_t numLights = scene->allLights.size();
+      const bool cacheOccluders = occluderCache && scene->supportsOccludedBy();
+      if (cacheOccluders && state.occluders.size() != numLights) state.occluders.assign(numLights,Occluder());
+      for (size_t i=0; i<numLights; )
       {
-        if ((scene->allLights[i]->illumMask & dg.illumMask) == 0)
-          continue;
-
-        /*! Either use precomputed samples for the light or sample light now. */
-        LightSample ls;
-        if (scene->allLights[i]->precompute()) ls = state.sample->getLightSample(precomputedLightSampleID[i]);
-        else ls.L = scene->allLights[i]->sample(dg, ls.wi, ls.tMax, state.sample->getVec2f(lightSampleID));
-
-        /*! Ignore zero radiance or illumination from the back. */
-        //if (ls.L == Color(zero) || ls.wi.pdf == 0.0f || dot(dg.Ns,Vector3f(ls.wi)) <= 0.0f) continue; 
-        if (ls.L == Color(zero) || ls.wi.pdf == 0.0f) continue;
-
-        /*! Evaluate BRDF */
-        Color brdf = brdfs.eval(wo, dg, ls.wi, directLightingBRDFTypes);
-        if (brdf == Color(zero)) continue;
-
-        /*! Test for shadows. */
-        Ray shadowRay(dg.P, ls.wi, dg.error*epsilon, ls.tMax-dg.error*epsilon, lightPath.lastRay.time,dg.shadowMask);
-        rtcOccluded(scene->scene,(RTCRay&)shadowRay);
-        state.numRays++;
-        if (shadowRay) continue;
-
-        /*! Evaluate BRDF. */
-        L += ls.L * brdf * rcp(ls.wi.pdf);
+        LightSample ls[SIMD_WIDTH];
+        size_t lightIDs[SIMD_WIDTH];
+        Vector3fN wi = zero;
+        size_t num = 0;
+        for (; i<numLights; i++)
+        {
+          const Light* light = scene->allLights[i].ptr;
+          if ((light->illumMask & dg.illumMask) == 0)
+            continue;
+
+          /*! Continue with the next packet if the samples of this light do not fit. */
+          const size_t n = numLightSamples(light);
+          if (num+n > SIMD_WIDTH) break;
+
+          /*! Either use precomputed samples for the light or sample light now. */
+          if (light->precompute()) ls[num] = state.sample->getLightSample(precomputedLightSampleID[i]);
+          else if (n == 1) ls[num].L = light->sample(dg, ls[num].wi, ls[num].tMax, state.sample->getVec2f(lightSampleID));
+          else
+          {
+            Vec2fN s;
+            for (size_t j=0; j<n; j++) {
+              const Vec2f sj = state.sample->getVec2f(lightSampleID + j);
+              s.x[j] = sj.x; s.y[j] = sj.y;
+            }
+            Vector3fN wiN; simdf pdfN, tMaxN;
+            const ColorN LN = light->sampleN(dg, wiN, pdfN, tMaxN, s, simdf(step) < simdf(float(n)));
+            for (size_t j=0; j<n; j++) {
+              ls[num+j].L = getColor(LN,j) * rcp(float(n));
+              ls[num+j].wi = Sample3f(getVector3f(wiN,j),pdfN[j]);
+              ls[num+j].tMax = tMaxN[j];
+            }
+          }
+
+          /*! Ignore zero radiance or illumination from the back. */
+          //if (lsi.L == Color(zero) || lsi.wi.pdf == 0.0f || dot(dg.Ns,Vector3f(lsi.wi)) <= 0.0f) continue; 
+          const size_t first = num;
+          for (size_t j=0; j<n; j++) {
+            const LightSample& lsi = ls[first+j];
+            if (lsi.L == Color(zero) || lsi.wi.pdf == 0.0f) continue;
+            if (num != first+j) ls[num] = lsi;
+            setVector3f(wi, num, lsi.wi.value);
+            lightIDs[num++] = i;
+          }
+        }
+        if (num == 0) continue;
+
+        /*! Evaluate BRDF for all gathered light directions. */
+        const simdb valid = simdf(step) < simdf(float(num));
+        const ColorN brdfN = brdfs.evalN(wo, dg, wi, valid, directLightingBRDFTypes);
+
+        for (size_t k=0; k<num; k++)
+        {
+          const Color brdf = getColor(brdfN, k);
+          if (brdf == Color(zero)) continue;
+
+          /*! Test for shadows. The occluder cache tests the last
+           *  blocker of this light before traversing the scene. */
+          Ray shadowRay(dg.P, ls[k].wi, dg.error*epsilon, ls[k].tMax-dg.error*epsilon, lightPath.lastRay.time,dg.shadowMask);
+          if (cacheOccluders)
+          {
+            Occluder& occluder = state.occluders[lightIDs[k]];
+            if (occluder.id0 != -1) {
+              state.numOccluderTests++;
+              if (scene->occludedBy(shadowRay,occluder.id0,occluder.id1)) {
+                state.numOccluderHits++;
+                continue;
+              }
+            }
+
+            /*! the occlusion query records its blocker, or clears the entry if unoccluded */
+            scene->occluded(shadowRay,occluder);
+          }
+          else rtcOccluded(scene->scene,(RTCRay&)shadowRay);
+          state.numRays++;
+          if (shadowRay) continue;
+
+          /*! Weight the sample against BRDF sampling for lights that BRDF samples can hit. */
+          float weight = 1.0f;
+          const Light* light = scene->allLights[lightIDs[k]].ptr;
+          if (mis && light->hittable()) {
+            float pdf = brdfs.pdf(wo, dg, ls[k].wi, directLightingBRDFTypes);
+            if (alpha > 0.0f) pdf = alpha*guide->pdf(region, ls[k].wi) + (1.0f-alpha)*pdf;
+            weight = misWeight(float(numLightSamples(light))*ls[k].wi.pdf, float(numScatter)*pdf);
+          }
+
+          /*! Evaluate BRDF. */
+          L += ls[k].L * brdf * (weight * rcp(ls[k].wi.pdf));
+        }
       }
     }
+
+    /*! Only emission and light samples of the primary hit count as direct. */
+    if (lightPath.depth == 0 && state.aov) state.aov->direct = L;
+
+    /*! Update the radiance cache with the reflected radiance divided by the albedo. */
+    if (cached) {
+      const Color Lr = L - Lemitted + Lindirect;
+      cache->record(dg.P, dg.Ns, cellSize, Color(albedo.r > 0.0f ? Lr.r*rcp(albedo.r) : 0.0f,
+                                                 albedo.g > 0.0f ? Lr.g*rcp(albedo.g) : 0.0f,
+                                                 albedo.b > 0.0f ? Lr.b*rcp(albedo.b) : 0.0f));
+    }
     
-    return L;
+    return L + Lindirect;
+  }
+
+  Color PathTraceIntegrator::sampleGuided(const PathGuide* guide, const size_t region, const float alpha,
+                                          const CompositedBRDF& brdfs, const Vector3f& wo, const DifferentialGeometry& dg,
+                                          Sample3f& wi, BRDFType& type, const Vec2f& s, const float ss) const
+  {
+    /*! Pick guide or BRDF, the BRDF component is picked uniformly as
+     *  assumed by CompositedBRDF::pdf. */
+    if (ss < alpha) wi = guide->sample(region, s);
+    else {
+      const size_t i = min(size_t((ss-alpha)*rcp(1.0f-alpha)*float(brdfs.size())), brdfs.size()-1);
+      brdfs[i]->sample(wo, dg, wi, s);
+    }
+    type = dot(Vector3f(wi), dg.Ng) < 0.0f ? (BRDFType)(TRANSMISSION & (DIFFUSE|GLOSSY)) : (BRDFType)(REFLECTION & (DIFFUSE|GLOSSY));
+
+    /*! One-sample MIS, the sample is weighted by the density of both strategies combined. */
+    wi.pdf = alpha*guide->pdf(region, wi) + (1.0f-alpha)*brdfs.pdf(wo, dg, wi, ALL);
+    if (wi.pdf <= 0.0f) return zero;
+    return brdfs.eval(wo, dg, wi, ALL);
+  }
+
+  float PathTraceIntegrator::brdfSampleWeight(const LightPath& lightPath, const Light* light) const
+  {
+    /*! Full weight if the previous vertex did not sample this light. */
+    const DifferentialGeometry* dg = lightPath.misDg;
+    if (!dg || !light->hittable() || (light->illumMask & dg->illumMask) == 0)
+      return 1.0f;
+    return misWeight(lightPath.misPdf, float(numLightSamples(light))*light->pdf(*dg, lightPath.lastRay.dir));
   }
 
   Color PathTraceIntegrator::Li(Ray& ray, const Ref<BackendScene>& scene, IntegratorState& state) {
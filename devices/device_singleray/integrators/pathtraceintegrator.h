@@ -37,12 +37,16 @@ namespace embree
 
       /*! Constructs a path. */
       __forceinline LightPath (const Ray& ray, const Medium& medium = Medium::Vacuum(), const int depth = 0,
-                               const Color& throughput = one, const bool ignoreVisibleLights = false, const bool unbend = true)
-        : lastRay(ray), lastMedium(medium), depth(depth), throughput(throughput), ignoreVisibleLights(ignoreVisibleLights), unbend(unbend) {}
+                               const Color& throughput = one, const bool ignoreVisibleLights = false, const bool unbend = true,
+                               const DifferentialGeometry* misDg = NULL, const float misPdf = 0.0f, const Color& weight = one)
+        : lastRay(ray), lastMedium(medium), depth(depth), throughput(throughput), ignoreVisibleLights(ignoreVisibleLights), unbend(unbend),
+          misDg(misDg), misPdf(misPdf), weight(weight) {}
 
       /*! Extends a light path. */
-      __forceinline LightPath extended(const Ray& nextRay, const Medium& nextMedium, const Color& weight, const bool ignoreVL) const {
-        return LightPath(nextRay, nextMedium, depth+1, throughput*weight, ignoreVL, unbend && (nextRay.dir == lastRay.dir));
+      __forceinline LightPath extended(const Ray& nextRay, const Medium& nextMedium, const Color& weight, const bool ignoreVL,
+                                       const DifferentialGeometry* misDg = NULL, const float misPdf = 0.0f, const Color& sampleWeight = one) const {
+        return LightPath(nextRay, nextMedium, depth+1, throughput*weight, ignoreVL, unbend && (nextRay.dir == lastRay.dir), misDg, misPdf,
+                         this->weight*sampleWeight);
       }
 
     public:
@@ -53,6 +57,9 @@ namespace embree
       bool ignoreVisibleLights;    /*! If the previous shade point used shadow rays we have to ignore the emission
                                        of geometrical lights to not double count them. */
       bool unbend;                 /*! True of the ray path is a straight line. */
+      const DifferentialGeometry* misDg; /*! Shade point the last ray was sampled from, if its BRDF sample takes part in MIS. */
+      float misPdf;                /*! BRDF sampling PDF of the last ray used to compute the MIS weight. */
+      Color weight;                /*! Monte Carlo weight of the path, BRDF values divided by sampling PDFs and survival probabilities. */
     };
 
   public:
@@ -63,6 +70,34 @@ namespace embree
     /*! Registers samples we need tom the sampler. */
     void requestSamples(Ref<SamplerFactory>& samplerFactory, const Ref<BackendScene>& scene);
 
+    /*! Creates the path guide and radiance cache of the scene. */
+    void beginPass(Ref<BackendScene> scene);
+
+    /*! Trains the path guide of the scene. */
+    void endPass(Ref<BackendScene> scene);
+
+    /*! Combines the PDFs of two sampling strategies into the MIS weight of the first one. */
+    __forceinline float misWeight(const float pdf0, const float pdf1) const {
+      if (pdf1 == 0.0f) return 1.0f;
+      if (mis == MIS_POWER) return pdf0*pdf0*rcp(pdf0*pdf0+pdf1*pdf1);
+      return pdf0*rcp(pdf0+pdf1);
+    }
+
+    /*! Samples a direction from the path guide with probability alpha
+     *  and from the BRDF otherwise, and returns the BRDF value. The
+     *  PDF is the combined density of both strategies. */
+    Color sampleGuided(const PathGuide* guide, const size_t region, const float alpha,
+                       const CompositedBRDF& brdfs, const Vector3f& wo, const DifferentialGeometry& dg,
+                       Sample3f& wi, BRDFType& type, const Vec2f& s, const float ss) const;
+
+    /*! Computes the MIS weight for emission of a light found by a BRDF sample. */
+    float brdfSampleWeight(const LightPath& lightPath, const Light* light) const;
+
+    /*! Returns the number of samples taken of a light per shade point. */
+    __forceinline size_t numLightSamples(const Light* light) const {
+      return light->precompute() ? 1 : lightSamples;
+    }
+
     /*! Test for occlusion. */
     bool occluded(LightPath& lightPath, const Ref<BackendScene>& scene);
 
@@ -72,19 +107,41 @@ namespace embree
     /*! Computes the radiance arriving at the origin of the ray from the ray direction. */
     Color Li(Ray& ray, const Ref<BackendScene>& scene, IntegratorState& state);
 
+    /*! Heuristics to combine light and BRDF samples. */
+    enum { MIS_NONE = 0, MIS_BALANCE = 1, MIS_POWER = 2 };
+
     /* Configuration. */
   private:
     bool sampleLightForGlossy;
+    int mis;                       //!< Multiple importance sampling heuristic (0=off, 1=balance, 2=power).
     size_t maxDepth;               //!< Maximal recursion depth (1=primary ray only)
     float minContribution;         //!< Minimal contribution of a path to the pixel.
     float epsilon;                 //!< Epsilon to avoid self intersections.
     Ref<Image> backplate;          //!< High resolution background.
+    bool guiding;                  //!< Samples directions from the incident radiance learned in the path guide of the scene.
+    float guideFraction;           //!< Probability to sample the path guide instead of the BRDF.
+    size_t guideRounds;            //!< Number of training rounds of the path guide.
+    float guideSpatialThreshold;   //!< Number of samples that cause a spatial split of the path guide.
+    bool caching;                  //!< Preview mode, terminates diffuse bounces into the radiance cache of the scene.
+    size_t cacheDepth;             //!< First path depth that terminates into the radiance cache.
+    size_t cacheMinSamples;        //!< Samples a cell of the radiance cache needs before it gets used.
+    float cacheUpdate;             //!< Probability to continue the path to update the radiance cache.
+    float cacheScale;              //!< Size of the cells of the radiance cache in pixel footprints.
+    size_t cacheSize;              //!< Logarithm of the number of cells of the radiance cache.
+    bool occluderCache;            //!< Tests the last blocker of each light before tracing a shadow ray.
+    int rouletteDepth;             //!< Bounces before Russian roulette starts, negative disables roulette in favour of minContribution.
+    size_t lightSamples;           //!< Number of samples per light, taken as one packet.
+    size_t brdfSamples;            //!< Number of BRDF samples at the first hit, taken as one packet.
 
     /*! Random variables. */
   private:
-    int lightSampleID;            //!< 2D random variable to sample the light source.
+    int lightSampleID;            //!< 2D random variables to sample the light sources.
     int firstScatterSampleID;     //!< 2D random variable to sample the BRDF.
     int firstScatterTypeSampleID; //!< 1D random variable to sample the BRDF type to choose.
+    int cacheSampleID;            //!< 1D random variable to decide between radiance cache lookup and update.
+    int rouletteSampleID;         //!< 1D random variable to decide if the path survives Russian roulette.
+    int splitSampleID;            //!< 2D random variables to sample the BRDF at the first hit.
+    int splitTypeSampleID;        //!< 1D random variables to sample the BRDF type at the first hit.
     std::vector<int> precomputedLightSampleID;  //!< ID of precomputed light samples for lights that need precomputations.
   };
 }
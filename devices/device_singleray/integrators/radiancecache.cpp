@@ -0,0 +1,97 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "radiancecache.h"
+
+namespace embree
+{
+  /*! maximal number of cells probed for a key */
+  #define CACHE_MAX_PROBES 16
+
+  RadianceCache::RadianceCache (const size_t log2Cells, const size_t minSamples)
+    : mask((size_t(1) << log2Cells)-1), minSamples(int32(minSamples))
+  {
+    cells = (Cell*) alignedMalloc((mask+1)*sizeof(Cell));
+    memset(cells,0,(mask+1)*sizeof(Cell));
+  }
+
+  RadianceCache::~RadianceCache () {
+    alignedFree(cells); cells = NULL;
+  }
+
+  int64 RadianceCache::key(const Vector3f& P, const Vector3f& N, const float cellSize)
+  {
+    if (!(cellSize > 0.0f) || !finite(cellSize)) return 0;
+
+    /*! round the cell size up to a power of two */
+    int level; frexpf(cellSize,&level);
+    const float rcpSize = ldexpf(1.0f,-level);
+
+    /*! 17 bits per coordinate, 8 bits of level, 3 bits of normal direction */
+    const int64 x = int64(floorf(P.x*rcpSize)) & 0x1FFFF;
+    const int64 y = int64(floorf(P.y*rcpSize)) & 0x1FFFF;
+    const int64 z = int64(floorf(P.z*rcpSize)) & 0x1FFFF;
+    const Vector3f a = abs(N);
+    const int axis = a.x > a.y ? (a.x > a.z ? 0 : 2) : (a.y > a.z ? 1 : 2);
+    const int64 n = 2*axis + (N[axis] < 0.0f);
+    return (int64(1) << 62) | (int64((level+128) & 0xFF) << 54) | (n << 51) | (x << 34) | (y << 17) | z;
+  }
+
+  RadianceCache::Cell* RadianceCache::find(const int64 key, const bool insert) const
+  {
+    /*! mix the bits of the key to spread neighbouring cells */
+    uint64 h = uint64(key);
+    h ^= h >> 33; h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33; h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+
+    for (size_t i=0; i<CACHE_MAX_PROBES; i++)
+    {
+      Cell* cell = &cells[(size_t(h)+i) & mask];
+      if (cell->key == key) return cell;
+      if (cell->key != 0) continue;
+      if (!insert) return NULL;
+      const int64 old = atomic_cmpxchg(&cell->key,key,int64(0));
+      if (old == 0 || old == key) return cell;
+    }
+    return NULL;
+  }
+
+  bool RadianceCache::lookup(const Vector3f& P, const Vector3f& N, const float cellSize, Color& L) const
+  {
+    const int64 k = key(P,N,cellSize);
+    if (!k) return false;
+    const Cell* cell = find(k,false);
+    if (!cell) return false;
+    const int32 count = cell->count;
+    if (count < minSamples) return false;
+    L = Color(cell->sum[0],cell->sum[1],cell->sum[2]) * rcp(float(count));
+    return true;
+  }
+
+  void RadianceCache::record(const Vector3f& P, const Vector3f& N, const float cellSize, const Color& L)
+  {
+    if (!finite(L.r) || !finite(L.g) || !finite(L.b)) return;
+    const int64 k = key(P,N,cellSize);
+    if (!k) return;
+    Cell* cell = find(k,true);
+    if (!cell) return;
+    atomic_add_float(&cell->sum[0],L.r);
+    atomic_add_float(&cell->sum[1],L.g);
+    atomic_add_float(&cell->sum[2],L.b);
+    atomic_add(&cell->count,1);
+  }
+}
@@ -0,0 +1,71 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#ifndef __EMBREE_RADIANCE_CACHE_H__
+#define __EMBREE_RADIANCE_CACHE_H__
+
+#include "../default.h"
+
+namespace embree
+{
+  /*! World space hashed grid that caches the radiance reflected by
+   *  diffuse surfaces for preview rendering. The cells are sized
+   *  relative to the pixel footprint at the hit point, rounded to a
+   *  power of two, and separated by the dominant axis of the normal.
+   *  The radiance is stored divided by the albedo to keep texture
+   *  detail. Cells are inserted and updated lock free, a full probe
+   *  sequence drops the sample. */
+  class RadianceCache : public RefCount
+  {
+    /*! Cell of the grid. */
+    struct Cell {
+      volatile int64 key;      //!< Key of the cell, 0 for empty cells.
+      volatile float sum[3];   //!< Sum of the recorded radiance.
+      volatile int32 count;    //!< Number of recorded samples.
+    };
+
+  public:
+
+    /*! Construction. \param log2Cells is the logarithm of the number
+     *  of cells, \param minSamples is the number of samples a cell
+     *  needs before it gets used. */
+    RadianceCache (const size_t log2Cells, const size_t minSamples);
+
+    /*! Destruction. */
+    ~RadianceCache ();
+
+    /*! Looks up the cached radiance, returns false if the cell did not get enough samples. */
+    bool lookup(const Vector3f& P, const Vector3f& N, const float cellSize, Color& L) const;
+
+    /*! Records a radiance sample, can be called concurrently. */
+    void record(const Vector3f& P, const Vector3f& N, const float cellSize, const Color& L);
+
+  private:
+
+    /*! Computes the key of the cell containing P, returns 0 for invalid cell sizes. */
+    static int64 key(const Vector3f& P, const Vector3f& N, const float cellSize);
+
+    /*! Finds the cell of a key, optionally inserts it. Returns NULL if not found. */
+    Cell* find(const int64 key, const bool insert) const;
+
+  private:
+    size_t mask;           //!< Number of cells minus one.
+    int32 minSamples;      //!< Samples a cell needs before it gets used.
+    Cell* cells;           //!< Hash table of cells.
+  };
+}
+
+#endif
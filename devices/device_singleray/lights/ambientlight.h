@@ -63,6 +63,8 @@ namespace embree
       return cosineSampleHemispherePDF(wi,dg.Ns);
     }
 
+    bool hittable() const { return true; }
+
   protected:
     Color L;          //!< Radiance (W/(m^2*sr))
   };
@@ -19,20 +19,22 @@
 
 namespace embree
 {
-  HDRILight::HDRILight(const AffineSpace3f& local2world, 
-                       unsigned width, unsigned height, 
-                       const Color& L, const Ref<Image>& pixels, 
-                       const Ref<Distribution2D>& distribution,
+  HDRILight::HDRILight(const HDRILight& other,
+                       const AffineSpace3f& local2world, 
                        light_mask_t illumMask,
                        light_mask_t shadowMask)
     : EnvironmentLight(illumMask,shadowMask), 
       local2world(local2world), 
       world2local(rcp(local2world)), 
-      width(width), 
-      height(height), 
-      L(L), 
-      pixels(pixels), 
-      distribution(distribution) 
+      width(other.width), 
+      height(other.height), 
+      L(other.L), 
+      pixels(other.pixels), 
+      distribution(other.distribution),
+      cosTheta(other.cosTheta),
+      cosPhi(other.cosPhi),
+      sinPhi(other.sinPhi),
+      rcpSolidAngle(other.rcpSolidAngle)
   {}
   
   HDRILight::HDRILight(const Parms& parms)
@@ -46,32 +48,97 @@ namespace embree
     width  = (unsigned) pixels->width;
     height = (unsigned) pixels->height;
 
+    /*! precompute the row and column boundaries */
+    cosTheta.resize(height+1);
+    for (size_t y = 0; y <= height; y++)
+      cosTheta[y] = cosf(float(pi)*float(y)*rcp(float(height)));
+    cosTheta[0] = 1.0f; cosTheta[height] = -1.0f;
+
+    cosPhi.resize(width+1);
+    sinPhi.resize(width+1);
+    for (size_t x = 0; x <= width; x++) {
+      const float phi = float(two_pi)*(1.0f-float(x)*rcp(float(width)));
+      cosPhi[x] = cosf(phi);
+      sinPhi[x] = sinf(phi);
+    }
+
+    /*! importance is proportional to the solid angle of the pixel */
+    rcpSolidAngle.resize(height);
     Array2D<float> importance(height,width);
-    for (size_t y = 0; y < height; y++)
+    for (size_t y = 0; y < height; y++) {
+      const float dcos = max(cosTheta[y]-cosTheta[y+1],1E-10f);
+      rcpSolidAngle[y] = rcp(float(two_pi)*float(height)*dcos);
       for (size_t x = 0; x < width; x++)
-        importance.set(y, x, sinf(float(pi)*(y+0.5f)*rcp(float(height))) * reduce_add(pixels->get(x,y)));
+        importance.set(y, x, dcos * reduce_add(pixels->get(x,y)));
+    }
 
-    distribution = new Distribution2D(importance,width,height);
+    distribution = new AliasTable2D(importance,width,height);
+  }
+
+  /*! sine and cosine of small angles in [0,2*pi/width] */
+  static __forceinline void sincosSmall(const float d, float& s, float& c)
+  {
+    const float d2 = d*d;
+    s = d*(1.0f-d2*(1.0f/6.0f)*(1.0f-d2*(1.0f/20.0f)*(1.0f-d2*(1.0f/42.0f))));
+    c = 1.0f-d2*0.5f*(1.0f-d2*(1.0f/12.0f)*(1.0f-d2*(1.0f/30.0f)*(1.0f-d2*(1.0f/56.0f))));
+  }
+
+  /*! Approximates acos with an absolute error below 1E-7 (Abramowitz and Stegun 4.4.46). */
+  static __forceinline float fastAcos(const float x)
+  {
+    const float a = min(abs(x),1.0f);
+    const float r = sqrt(1.0f-a)*(1.5707963050f + a*(-0.2145988016f + a*(0.0889789874f + a*(-0.0501743046f + 
+                    a*(0.0308918810f + a*(-0.0170881256f + a*(0.0066700901f - a*0.0012624911f)))))));
+    return x < 0.0f ? float(pi)-r : r;
+  }
+
+  /*! Approximates atan2 with an absolute error below 1E-5. */
+  static __forceinline float fastAtan2(const float y, const float x)
+  {
+    const float ax = abs(x), ay = abs(y);
+    const float t = min(ax,ay)/max(max(ax,ay),1E-30f), t2 = t*t;
+    float r = t*(0.99997726f + t2*(-0.33262347f + t2*(0.19354346f + t2*(-0.11643287f + t2*(0.05265332f + t2*(-0.01172120f))))));
+    if (ay > ax) r = 0.5f*float(pi)-r;
+    if (x < 0.0f) r = float(pi)-r;
+    return y < 0.0f ? -r : r;
+  }
+
+  /*! The approximations of acos and atan2 find the pixel up to a
+   *  neighbour, the row and column boundaries in the tables decide. */
+  __forceinline Vec2i HDRILight::texel(const Vector3f& wi, float& fx, float& fy) const
+  {
+    /*! rows are uniform in theta, row y spans cos(theta) in (cosTheta[y+1],cosTheta[y]] */
+    const float cost = clamp(wi.y,-1.0f,1.0f);
+    const float v = fastAcos(cost)*float(one_over_pi)*float(height);
+    ssize_t y = clamp(ssize_t(v), ssize_t(0), ssize_t(height-1));
+    while (y > 0 && cost > cosTheta[y]) y--;
+    while (size_t(y) < height-1 && cost <= cosTheta[y+1]) y++;
+    fy = clamp(v-float(y),0.0f,1.0f);
+
+    /*! column x spans phi in (phi[x+1],phi[x]], the sine of the angle
+     *  between the direction and a boundary tells the side */
+    const float cosp = -wi.x, sinp = -wi.z;
+    float phi = fastAtan2(sinp,cosp);
+    if (phi < 0.0f) phi += 2.0f*float(pi);
+    const float u = (1.0f-phi*float(one_over_two_pi))*float(width);
+    ssize_t x = clamp(ssize_t(u), ssize_t(0), ssize_t(width-1));
+    if (width > 2) {
+      for (size_t i=0; i<2; i++) {
+        if      (sinp*cosPhi[x  ] - cosp*sinPhi[x  ] >  0.0f) x = x == 0 ? width-1 : x-1;
+        else if (sinp*cosPhi[x+1] - cosp*sinPhi[x+1] <= 0.0f) x = size_t(x) == width-1 ? 0 : x+1;
+        else break;
+      }
+    }
+    fx = clamp(u-float(x),0.0f,1.0f);
+    return Vec2i(int(x),int(y));
   }
 
   __forceinline Color HDRILight::Le(const Vector3f& wo) const
   {
-    Vector3f wi = xfmVector(world2local, -wo);
-    float theta = acosf(clamp(wi.y,-1.0f,1.0f));
-    float phi = atan2f(-wi.z,-wi.x);
-    if (phi < 0) phi += 2.0f * float(pi);
-    float u = 1.0f - (phi * float(one_over_two_pi));
-    float v = theta * float(one_over_pi);
-
-    ssize_t x = clamp(ssize_t(u*width), ssize_t(0), ssize_t(width-1));
-    ssize_t xNext = x + 1;
-    if (size_t(xNext) == width) xNext = 0;
-    float alpha = u*width - x;
-
-    ssize_t y = clamp(ssize_t(v*height), ssize_t(0), ssize_t(height-1));
-    ssize_t yNext = y+1;
-    if (size_t(yNext) == height) yNext = height-1;
-    float beta  = v*height - y;
+    float alpha, beta;
+    const Vec2i p = texel(xfmVector(world2local, -wo),alpha,beta);
+    const size_t x = p.x, xNext = size_t(p.x+1) == width ? 0 : p.x+1;
+    const size_t y = p.y, yNext = size_t(p.y+1) == height ? height-1 : p.y+1;
 
     Color c0 = pixels->get(x,     y    );
     Color c1 = pixels->get(xNext, y    );
@@ -91,23 +158,26 @@ namespace embree
   Color HDRILight::sample(const DifferentialGeometry& dg, Sample3f& wi, float& tMax, const Vec2f& sample) const
   {
     Sample2f pixelF = distribution->sample(sample);
-    float theta = float(pi) * pixelF.value.y*rcp(float(height));
-    float phi   = float(two_pi) * (1.0f - pixelF.value.x*rcp(float(width)));
-    Vector3f _wi = Vector3f(-sinf(theta)*cosf(phi),cosf(theta),-sinf(theta)*sinf(phi));
-    wi = Sample3f(xfmVector(local2world, _wi),pixelF.pdf*rcp(float(two_pi) * float(pi) * sinf(theta)));
+    const size_t x = min(size_t(pixelF.value.x),size_t(width-1));
+    const size_t y = min(size_t(pixelF.value.y),size_t(height-1));
+    const float fx = pixelF.value.x - float(x);
+    const float fy = pixelF.value.y - float(y);
+
+    /*! uniform in cos(theta) and phi inside the pixel */
+    const float cost = (1.0f-fy)*cosTheta[y] + fy*cosTheta[y+1];
+    const float sint = sqrtf(max(0.0f,1.0f-cost*cost));
+    float sind, cosd; sincosSmall(float(two_pi)*fx*rcp(float(width)),sind,cosd);
+    const float cosp = cosPhi[x]*cosd + sinPhi[x]*sind;
+    const float sinp = sinPhi[x]*cosd - cosPhi[x]*sind;
+    Vector3f _wi = Vector3f(-sint*cosp,cost,-sint*sinp);
+    wi = Sample3f(xfmVector(local2world, _wi),distribution->pdf(x,y)*rcpSolidAngle[y]);
     tMax = inf;
-    return L*pixels->get(clamp(ssize_t(pixelF.value.x), ssize_t(0), ssize_t(width-1)),
-                         clamp(ssize_t(pixelF.value.y), ssize_t(0), ssize_t(height-1)));
+    return L*pixels->get(x,y);
   }
 
-  float HDRILight::pdf(const DifferentialGeometry& dg, const Vector3f& _wi) const {
-    Vector3f wi = xfmVector(world2local, _wi);
-    float theta = acosf(wi.y);
-    float phi = atan2f(-wi.z,-wi.x);
-    if (phi < 0) phi += 2.0f * float(pi);
-    float u = 1.0f - float(one_over_two_pi) * phi;
-    float v = float(one_over_pi) * theta;
-    return distribution->pdf(Vec2f(u,v))*rcp(float(two_pi) * float(pi) * sinf(theta));
+  float HDRILight::pdf(const DifferentialGeometry& dg, const Vector3f& wi) const {
+    float fx, fy;
+    const Vec2i p = texel(xfmVector(world2local, wi),fx,fy);
+    return distribution->pdf(p.x,p.y)*rcpSolidAngle[p.y];
   }
 }
-
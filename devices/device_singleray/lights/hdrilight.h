@@ -19,7 +19,7 @@
 
 #include "image/image.h"
 #include "../lights/light.h"
-#include "../samplers/distribution2d.h"
+#include "../samplers/aliastable2d.h"
 
 namespace embree
 {
@@ -27,11 +27,9 @@ namespace embree
   class HDRILight : public EnvironmentLight
   {
   protected:
-    /*! construction from members */
-    HDRILight(const AffineSpace3f& local2world, 
-              unsigned width, unsigned height, 
-              const Color& L, const Ref<Image>& pixels, 
-              const Ref<Distribution2D>& distribution,
+    /*! construction from other light with new transformation */
+    HDRILight(const HDRILight& other,
+              const AffineSpace3f& local2world, 
               light_mask_t illumMask=-1,
               light_mask_t shadowMask=-1);
   public:
@@ -42,8 +40,7 @@ namespace embree
     Ref<Light> transform(const AffineSpace3f& xfm,
                          light_mask_t illumMask,
                          light_mask_t shadowMask) const {
-      return new HDRILight(xfm*local2world,width,height,L,pixels,distribution,
-                           illumMask,shadowMask);
+      return new HDRILight(*this,xfm*local2world,illumMask,shadowMask);
     }
 
     Color Le    (const Vector3f& wo) const;
@@ -52,6 +49,12 @@ namespace embree
                  float& tMax, const Vec2f& s) const;
     float pdf   (const DifferentialGeometry& dg, const Vector3f& wi) const;
     bool  precompute() const { return true; }
+    bool  hittable() const { return true; }
+
+  protected:
+    /*! Returns the pixel containing the direction in light space and
+     *  the position inside the pixel in theta and phi. */
+    __forceinline Vec2i texel(const Vector3f& wi, float& fx, float& fy) const;
 
   protected:
     AffineSpace3f local2world;            //!< Transformation from light space into world space
@@ -60,7 +63,15 @@ namespace embree
     Color L;                            //!< Scaling factor for the image.
 
     Ref<Image> pixels;                  //!< The image mapped to the environment.
-    Ref<Distribution2D> distribution;   //!< The 2D distribution used to importance sample the image.
+    Ref<AliasTable2D> distribution;     //!< The 2D distribution used to importance sample the image.
+
+    /*! Precomputed direction and pdf lookup. Inside a pixel,
+     *  directions are sampled uniformly in solid angle, thus the pdf
+     *  is constant per pixel and no trigonometry is needed. */
+    std::vector<float> cosTheta;        //!< Cosine of theta at the row boundaries (height+1 entries).
+    std::vector<float> cosPhi;          //!< Cosine of phi at the column boundaries (width+1 entries).
+    std::vector<float> sinPhi;          //!< Sine of phi at the column boundaries (width+1 entries).
+    std::vector<float> rcpSolidAngle;   //!< Converts the pdf of the distribution to solid angle per row.
   };
 }
 
@@ -61,6 +61,26 @@ namespace embree
                           float& tMax,                    /*!< Returns the distance of the light. */
                           const Vec2f& sample)            /*!< Sample locations are provided by the caller. */ const { return zero; }
 
+    /*! Samples the light for a packet of sample locations. \returns
+     *  the radiance arriving from the sampled directions. */
+    virtual ColorN sampleN (const DifferentialGeometry& dg, /*!< The shade point that is illuminated. */
+                            Vector3fN& wi,                  /*!< Returns the sampled directions. */
+                            simdf& pdf,                     /*!< Returns the PDF of the sampled directions. */
+                            simdf& tMax,                    /*!< Returns the distances of the light. */
+                            const Vec2fN& s,                /*!< Sample locations are provided by the caller. */
+                            const simdb& valid)             /*!< Active elements of the packet. */ const
+    {
+      /*! by default we sample each active element individually */
+      ColorN L = zero; pdf = zero; tMax = zero;
+      for (int m = (int)movemask(valid); m; m &= m-1) {
+        const size_t i = __bsf(m);
+        Sample3f wi1; float tMax1 = 0.0f;
+        setColor(L, i, sample(dg, wi1, tMax1, Vec2f(s.x[i], s.y[i])));
+        setVector3f(wi, i, wi1.value); pdf[i] = wi1.pdf; tMax[i] = tMax1;
+      }
+      return L;
+    }
+
     /*! Evaluates the probability distribution function used by the
      *  sampling function of the light for a shade location and
      *  direction. \returns the probability density */
@@ -71,6 +91,11 @@ namespace embree
      *  integrator should presample the light. */
     virtual bool precompute() const { return false; }
 
+    /*! Indicates that the emission of the light can also be found by
+     *  rays sampled from a BRDF. Only such lights take part in
+     *  multiple importance sampling. */
+    virtual bool hittable() const { return false; }
+
     light_mask_t illumMask;
     light_mask_t shadowMask;
   };
@@ -99,12 +99,27 @@ namespace embree
       return L;
     }
 
+    ColorN sampleN(const DifferentialGeometry& dg, Vector3fN& wi, simdf& pdf, simdf& tMax, const Vec2fN& s, const simdb& valid) const
+    {
+      const simdf su = sqrt(s.x);
+      const Vector3fN C = splat(tri->v2);
+      const Vector3fN d = C + (simdf(one)-su)*(splat(tri->v0)-C) + (s.y*su)*(splat(tri->v1)-C) - splat(dg.P);
+      tMax = length(d);
+      const simdf dDotNg = dot(d,splat(Ng));
+      const simdb ok = valid & (dDotNg < simdf(zero));
+      wi = d*rcp(tMax);
+      pdf = select(ok,2.0f*tMax*tMax*tMax*rcp(abs(dDotNg)),simdf(zero));
+      return ColorN(select(ok,simdf(L.r),simdf(zero)),select(ok,simdf(L.g),simdf(zero)),select(ok,simdf(L.b),simdf(zero)));
+    }
+
     float pdf(const DifferentialGeometry& dg, const Vector3f& wi) const {
       float t,u,v,w; intersect(dg.P,wi,t,u,v,w);
       if (t < 0.0f || min(u,v,w) < 0) return zero;
       return 2.0f*t*t*rcp(abs(dot(wi,Ng)));
     }
 
+    bool hittable() const { return true; }
+
   public:
     Vector3f v0;                //!< First vertex of the triangle
     Vector3f v1;                //!< Second vertex of the triangle
@@ -37,7 +37,7 @@ namespace embree
     }
 
     void shade(const Ray& ray, const Medium& currentMedium, const DifferentialGeometry& dg, CompositedBRDF& brdfs) const {
-      if (Kd) brdfs.add(NEW_BRDF(Lambertian)(Kd->get(ds*dg.st+s0)));
+      if (Kd) brdfs.add(NEW_BRDF(Lambertian)(Kd->get(ds*dg.st+s0,ds*dg.dstdx,ds*dg.dstdy)));
     }
 
   protected:
@@ -0,0 +1,190 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#include "renderers/denoiser.h"
+
+namespace embree
+{
+  /*! Fast approximation of exp(x) for x <= 0 evaluated as (1+x/256)^256. */
+  static __forceinline ssef fastExp(const ssef& x)
+  {
+    ssef y = max(ssef(zero), ssef(one) + x*ssef(1.0f/256.0f));
+    y *= y; y *= y; y *= y; y *= y;
+    y *= y; y *= y; y *= y; y *= y;
+    return y;
+  }
+
+  /*! Albedo used to demodulate the radiance. Surfaces without diffuse
+   *  albedo, like mirrors or the background, are filtered directly. */
+  static __forceinline float demodulation(float albedo) {
+    return albedo > 0.01f ? albedo : 1.0f;
+  }
+
+  Denoiser::Denoiser (const Parms& parms)
+    : stride(0), planeSize(0), planes(NULL), numTilesX(0), numTilesY(0)
+  {
+    radius = clamp(parms.getInt("denoise.radius",4),1,16);
+    const float sigmaSpatial = parms.getFloat("denoise.sigmaSpatial",0.5f*float(radius));
+    const float sigmaAlbedo  = parms.getFloat("denoise.sigmaAlbedo" ,0.1f);
+    const float sigmaNormal  = parms.getFloat("denoise.sigmaNormal" ,0.1f);
+    const float sigmaDepth   = parms.getFloat("denoise.sigmaDepth"  ,0.05f);
+    spatialScale = rcp(2.0f*sigmaSpatial*sigmaSpatial);
+    albedoScale  = rcp(2.0f*sigmaAlbedo*sigmaAlbedo);
+    normalScale  = rcp(sigmaNormal);
+    depthScale   = rcp(2.0f*sigmaDepth*sigmaDepth);
+  }
+
+  Denoiser::~Denoiser () {
+    delete[] planes; planes = NULL;
+  }
+
+  void Denoiser::denoise(Ref<SwapChain> swapchain, const Ref<ToneMapper>& toneMapper)
+  {
+    if (!swapchain->aovs()) throw std::runtime_error("denoising requires auxiliary framebuffer channels");
+    this->swapchain = swapchain;
+    this->toneMapper = toneMapper;
+    this->framebuffer = swapchain->buffer();
+    numTilesX = (swapchain->getWidth() +TILE_SIZE-1)/TILE_SIZE;
+    numTilesY = (swapchain->getHeight()+TILE_SIZE-1)/TILE_SIZE;
+
+    /*! pixels that are never written, like the border, stay invalid */
+    const size_t newStride = numTilesX*TILE_SIZE+2*radius;
+    const size_t newPlaneSize = newStride*(numTilesY*TILE_SIZE+2*radius);
+    if (newStride != stride || newPlaneSize != planeSize) {
+      delete[] planes;
+      stride = newStride;
+      planeSize = newPlaneSize;
+      planes = new float[NUM_PLANES*planeSize];
+      memset(planes,0,NUM_PLANES*planeSize*sizeof(float));
+    }
+
+    runTiles(_prepareTile,"denoise::prepare");
+    runTiles(_filterTile,"denoise::filter");
+
+    this->swapchain = null;
+    this->toneMapper = null;
+    this->framebuffer = null;
+  }
+
+  void Denoiser::runTiles(TaskScheduler::runFunction run, const char* name)
+  {
+    TaskScheduler::EventSync event;
+    TaskScheduler::Task task(&event,run,this,numTilesX*numTilesY,NULL,NULL,name);
+    TaskScheduler::addTask(-1,TaskScheduler::GLOBAL_BACK,&task);
+    event.sync();
+  }
+
+  void Denoiser::prepareTile(size_t threadIndex, size_t threadCount, size_t taskIndex, size_t taskCount, TaskScheduler::Event* event)
+  {
+    const size_t tile_x = (taskIndex%numTilesX)*TILE_SIZE;
+    const size_t tile_y = (taskIndex/numTilesX)*TILE_SIZE;
+    const Ref<AccuBuffer>& accu = swapchain->accu();
+    const Ref<AOVBuffer>& aovs = swapchain->aovs();
+
+    for (size_t y=tile_y; y<min(tile_y+TILE_SIZE,swapchain->getHeight()); y++)
+    {
+      if (!swapchain->activeLine(int(y))) continue;
+      const size_t _y = swapchain->raster2buffer(y);
+
+      for (size_t x=tile_x; x<min(tile_x+TILE_SIZE,swapchain->getWidth()); x++)
+      {
+        const Color L = accu->get(x,_y);
+        const Vector3f albedo = aovs->get(AOVBuffer::ALBEDO,x,_y);
+        const Vector3f N = aovs->get(AOVBuffer::NORMAL,x,_y);
+        const float depth = aovs->getDepth(x,_y);
+
+        const size_t i = index(x,_y);
+        planes[R       *planeSize+i] = L.r*rcp(demodulation(albedo.x));
+        planes[G       *planeSize+i] = L.g*rcp(demodulation(albedo.y));
+        planes[B       *planeSize+i] = L.b*rcp(demodulation(albedo.z));
+        planes[ALBEDO_R*planeSize+i] = albedo.x;
+        planes[ALBEDO_G*planeSize+i] = albedo.y;
+        planes[ALBEDO_B*planeSize+i] = albedo.z;
+        planes[NORMAL_X*planeSize+i] = N.x;
+        planes[NORMAL_Y*planeSize+i] = N.y;
+        planes[NORMAL_Z*planeSize+i] = N.z;
+        planes[DEPTH   *planeSize+i] = depth < float(inf) ? depth : 0.0f;
+        planes[VALID   *planeSize+i] = 1.0f;
+      }
+    }
+  }
+
+  void Denoiser::filterTile(size_t threadIndex, size_t threadCount, size_t taskIndex, size_t taskCount, TaskScheduler::Event* event)
+  {
+    const size_t tile_x = (taskIndex%numTilesX)*TILE_SIZE;
+    const size_t tile_y = (taskIndex/numTilesX)*TILE_SIZE;
+    const size_t width = swapchain->getWidth();
+
+    for (size_t y=tile_y; y<min(tile_y+TILE_SIZE,swapchain->getHeight()); y++)
+    {
+      if (!swapchain->activeLine(int(y))) continue;
+      const size_t _y = swapchain->raster2buffer(y);
+
+      /*! in network mode only the 4 lines of a block are neighbors in the buffer */
+      ssize_t y0 = -radius, y1 = radius;
+      if (g_serverCount > 1) {
+        y0 = max(y0,-ssize_t(_y&3));
+        y1 = min(y1,3-ssize_t(_y&3));
+      }
+
+      /*! filter 4 pixels at once */
+      for (size_t x=tile_x; x<min(tile_x+TILE_SIZE,width); x+=4)
+      {
+        const size_t c = index(x,_y);
+        const ssef cAr = load(ALBEDO_R,c), cAg = load(ALBEDO_G,c), cAb = load(ALBEDO_B,c);
+        const ssef cNx = load(NORMAL_X,c), cNy = load(NORMAL_Y,c), cNz = load(NORMAL_Z,c);
+        const ssef cD  = load(DEPTH,c);
+        ssef sumR = zero, sumG = zero, sumB = zero, sumW = zero;
+
+        for (ssize_t dy=y0; dy<=y1; dy++)
+        {
+          for (ssize_t dx=-radius; dx<=radius; dx++)
+          {
+            const size_t n = c+dy*ssize_t(stride)+dx;
+            const ssef dAr = load(ALBEDO_R,n)-cAr, dAg = load(ALBEDO_G,n)-cAg, dAb = load(ALBEDO_B,n)-cAb;
+            const ssef cosN = load(NORMAL_X,n)*cNx + load(NORMAL_Y,n)*cNy + load(NORMAL_Z,n)*cNz;
+            const ssef nD = load(DEPTH,n);
+            const ssef relD = (nD-cD)*rcp(nD+cD+ssef(1E-4f));
+
+            ssef e = ssef(-float(dx*dx+dy*dy)*spatialScale);
+            e -= (dAr*dAr + dAg*dAg + dAb*dAb)*ssef(albedoScale);
+            e -= max(ssef(zero),ssef(one)-cosN)*ssef(normalScale);
+            e -= relD*relD*ssef(depthScale);
+            const ssef w = fastExp(e)*load(VALID,n);
+
+            sumR = madd(w,load(R,n),sumR);
+            sumG = madd(w,load(G,n),sumG);
+            sumB = madd(w,load(B,n),sumB);
+            sumW += w;
+          }
+        }
+
+        /*! remodulate with the albedo, tonemap, and write back */
+        const ssef rcpW = rcp(max(sumW,ssef(1E-10f)));
+        for (size_t i=0; i<4 && x+i<width; i++) {
+          const Color L(sumR[i]*rcpW[i]*demodulation(cAr[i]),
+                        sumG[i]*rcpW[i]*demodulation(cAg[i]),
+                        sumB[i]*rcpW[i]*demodulation(cAb[i]));
+          framebuffer->set(x+i, _y, toneMapper->eval(L,int(x+i),int(y),swapchain));
+        }
+      }
+    }
+
+    /*! mark one more tile as finished */
+    framebuffer->finishTile();
+  }
+}
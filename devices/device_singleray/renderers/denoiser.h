@@ -0,0 +1,97 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#ifndef __EMBREE_DENOISER_H__
+#define __EMBREE_DENOISER_H__
+
+#include "../renderers/renderer.h"
+#include "common/sys/taskscheduler.h"
+
+namespace embree
+{
+  /*! Feature guided denoiser that runs as a post pass after
+   *  accumulation and before tonemapping. A joint bilateral filter
+   *  smoothes the radiance divided by the albedo, using weights
+   *  derived from the albedo, normal, and depth channels of the
+   *  swapchain. The accumulation buffer is not modified, thus
+   *  progressive rendering still converges to the unfiltered
+   *  image. */
+  class Denoiser : public RefCount
+  {
+    ALIGNED_CLASS
+  public:
+
+    /*! tile size, has to match the renderer to finish the same framebuffer tiles */
+    enum { TILE_SIZE = Renderer::TILE_SIZE };
+
+    /*! Construction from parameters. */
+    Denoiser (const Parms& parms);
+
+    /*! Destruction. */
+    ~Denoiser ();
+
+    /*! Denoises the accumulated image of the swapchain and writes the
+     *  tonemapped result into its current framebuffer. */
+    void denoise(Ref<SwapChain> swapchain, const Ref<ToneMapper>& toneMapper);
+
+  private:
+
+    /*! gathers normalized color and features of a tile into the planes */
+    TASK_RUN_FUNCTION(Denoiser,prepareTile);
+
+    /*! filters a tile and writes it into the framebuffer */
+    TASK_RUN_FUNCTION(Denoiser,filterTile);
+
+    /*! runs a function over all tiles and waits for completion */
+    void runTiles(TaskScheduler::runFunction run, const char* name);
+
+    /*! returns the index of a pixel inside the padded planes */
+    __forceinline size_t index(size_t x, size_t y) const { 
+      return (y+radius)*stride+x+radius; 
+    }
+
+    /*! loads 4 consecutive pixels of a plane */
+    __forceinline ssef load(size_t plane, size_t i) const {
+      return ssef((const char*)&planes[plane*planeSize+i]);
+    }
+
+    /*! Configuration */
+  private:
+    int radius;                    //!< Filter radius in pixels.
+    float spatialScale;            //!< Scales squared pixel distance in the weight exponent.
+    float albedoScale;             //!< Scales squared albedo difference in the weight exponent.
+    float normalScale;             //!< Scales normal deviation (1-cos) in the weight exponent.
+    float depthScale;              //!< Scales squared relative depth difference in the weight exponent.
+
+    /*! Feature planes. */
+  private:
+    enum { R, G, B, ALBEDO_R, ALBEDO_G, ALBEDO_B, NORMAL_X, NORMAL_Y, NORMAL_Z, DEPTH, VALID, NUM_PLANES };
+    size_t stride;                 //!< Row stride of the padded planes in floats.
+    size_t planeSize;              //!< Size of a single plane in floats.
+    float* planes;                 //!< All planes stored one after the other.
+
+    /*! State of the current denoising pass. */
+  private:
+    Ref<SwapChain> swapchain;      //!< Swapchain to denoise.
+    Ref<ToneMapper> toneMapper;    //!< Tonemapper to apply after filtering.
+    Ref<FrameBuffer> framebuffer;  //!< Framebuffer to write into.
+    size_t numTilesX;              //!< Number of tiles in x direction.
+    size_t numTilesY;              //!< Number of tiles in y direction.
+  };
+}
+
+#endif
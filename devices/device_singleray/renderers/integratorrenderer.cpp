@@ -15,6 +15,7 @@
 // ======================================================================== //
 
 #include "renderers/integratorrenderer.h"
+#include "image/tiled.h"
 
 /* include all integrators */
 #include "integrators/pathtraceintegrator.h"
@@ -29,7 +30,7 @@
 namespace embree
 {
   IntegratorRenderer::IntegratorRenderer(const Parms& parms)
-    : iteration(0)
+    : iteration(0), raysPerSecond(0.0), raysPerPass(0), samplesAccumulated(0.0), jobRays(0), jobCoverage(0.0), jobOccluderTests(0), jobOccluderHits(0)
   {
     /*! create integrator to use */
     std::string _integrator = parms.getString("integrator","pathtracer");
@@ -50,32 +51,181 @@ namespace embree
 
     /*! get framebuffer configuration */
     gamma = parms.getFloat("gamma",1.0f);
+    aovs = parms.getInt("aovs",0) != 0;
+    compactAccu = parms.getInt("compactAccu",0) != 0;
+
+    /*! get time budget per frame */
+    timeBudget = max(0.0f,parms.getFloat("timeBudget",0.0f));
+
+    /*! get crop window, the camera still maps the full frame */
+    cropMin = parms.getVec2f("crop.min",Vec2f(0.0f,0.0f));
+    cropMax = parms.getVec2f("crop.max",Vec2f(1.0f,1.0f));
+    cropMin = Vec2f(clamp(cropMin.x,0.0f,1.0f),clamp(cropMin.y,0.0f,1.0f));
+    cropMax = Vec2f(clamp(cropMax.x,cropMin.x,1.0f),clamp(cropMax.y,cropMin.y,1.0f));
+
+    /*! get subsampling of frames that restart accumulation, blocks
+     *  of up to 4 lines stay within the lines of a network server */
+    const int _subsample = parms.getInt("subsample",1);
+    subsample = _subsample >= 4 ? 4 : (_subsample >= 2 ? 2 : 1);
+
+    /*! create denoiser if requested */
+    if (parms.getInt("denoise",0)) denoiser = new Denoiser(parms);
+
+    /*! set memory budget in MB of the tiles of out-of-core textures */
+    const int _textureCache = parms.getInt("textureCache",0);
+    if (_textureCache > 0) TileCache::instance().setBudget(size_t(_textureCache)*1024*1024);
+
+    /*! create reprojector used for accumulation mode 2 */
+    reprojector = new Reprojector(parms);
+    reproject = false;
 
     /*! show progress to the user */
     showProgress = parms.getInt("showprogress",0);
+
+    /*! print path statistics to tune the path depth */
+    pathStatistics = parms.getInt("pathStatistics",0) != 0;
   }
 
   void IntegratorRenderer::renderFrame(const Ref<Camera>& camera, const Ref<BackendScene>& scene, const Ref<ToneMapper>& toneMapper, Ref<SwapChain > swapchain, int accumulate) 
   {
-    if (accumulate == 0) iteration = 0;
-    new RenderJob(this,camera,scene,toneMapper,swapchain,accumulate,iteration);
-    iteration++;
+    if (accumulate != 1) iteration = 0;
+    if (accumulate != 1) samplesAccumulated = 0.0;
+
+    /*! A new accumulation starts in the selected representation. An
+     *  accumulation that outgrew the compact representation continues
+     *  in the default one. */
+    if (accumulate != 1 || !swapchain->accu()->isExpanded()) swapchain->setCompactAccu(compactAccu);
+    for (size_t i=0; i<PATH_LENGTH_BINS; i++) pathLengths[i] = 0;
+    for (size_t i=0; i<NUM_PATH_TERMINATIONS; i++) pathTerminations[i] = 0;
+
+    /*! keep the previous frame as history for reprojection, nothing
+     *  is recorded before reprojection got requested for the first time */
+    if (accumulate == 2) reproject = true;
+    if (accumulate == 2) reprojector->begin(swapchain);
+
+    if (timeBudget <= 0.0f) {
+      new RenderJob(this,camera,scene,toneMapper,swapchain,accumulate,iteration,0.0);
+      swapchain->expandSaturatedAccu();
+      if (denoiser) denoiser->denoise(swapchain,toneMapper);
+      if (reproject) reprojector->end(swapchain,camera);
+      iteration++;
+      if (pathStatistics) printPathStatistics();
+      return;
+    }
+
+    /*! Render passes until the time budget is used up. A new pass is
+     *  only started if the measured ray throughput predicts that it
+     *  finishes in time, and tiles of a started pass are skipped when
+     *  the deadline approaches. A non-accumulating first pass always
+     *  covers the full frame as it overwrites the accumulation buffer. */
+    const double t0 = getSeconds();
+    const double deadline = t0 + double(timeBudget);
+    const size_t spp = samplers->samplesPerPixel;
+    size_t numPasses = 0, numRays = 0, numOccluderTests = 0, numOccluderHits = 0;
+    double numSamples = 0.0;
+    while (true)
+    {
+      const double t1 = getSeconds();
+      const bool firstPass = numPasses == 0;
+      new RenderJob(this,camera,scene,toneMapper,swapchain,firstPass ? accumulate : 1,iteration,(firstPass && accumulate != 1) ? 0.0 : deadline);
+      const double t2 = getSeconds();
+      swapchain->expandSaturatedAccu();
+      iteration++; numPasses++;
+      numRays += jobRays;
+      numOccluderTests += jobOccluderTests;
+      numOccluderHits += jobOccluderHits;
+      numSamples += double(spp)*jobCoverage;
+
+      /*! update throughput estimate from complete passes only */
+      if (jobCoverage < 1.0) break;
+      raysPerPass = jobRays;
+      raysPerSecond = double(jobRays)/max(t2-t1,1E-6);
+      if (t2 + (t2-t1) > deadline) break;
+    }
+    samplesAccumulated += numSamples;
+    if (denoiser) denoiser->denoise(swapchain,toneMapper);
+    if (reproject) reprojector->end(swapchain,camera);
+    double dt = getSeconds()-t0;
+
+    /*! print fps, render time, rays per second, and accumulated samples */
+    std::ostringstream stream;
+    stream << "render  ";
+    stream.setf(std::ios::fixed, std::ios::floatfield);
+    stream.precision(2);
+    stream << 1.0f/dt << " fps, ";
+    stream.precision(0);
+    stream << dt*1000.0f << " ms, ";
+    stream.precision(3);
+    stream << numRays/dt*1E-6 << " mrps, ";
+    stream << numPasses << " passes, ";
+    stream.precision(2);
+    stream << numSamples << " spp (" << samplesAccumulated << " spp accumulated)";
+    if (numOccluderTests) stream << ", " << 100.0*double(numOccluderHits)/double(numOccluderTests) << "% occluder cache hits";
+    std::cout << stream.str() << std::endl;
+    if (pathStatistics) printPathStatistics();
+  }
+
+  void IntegratorRenderer::printPathStatistics() const
+  {
+    static const char* reasons[NUM_PATH_TERMINATIONS] = { "escaped", "absorbed", "max depth", "min contribution", "roulette", "cached" };
+    size_t numPaths = 0, numBounces = 0;
+    for (size_t i=0; i<PATH_LENGTH_BINS; i++) {
+      numPaths += pathLengths[i];
+      numBounces += i*size_t(pathLengths[i]);
+    }
+    if (numPaths == 0) return;
+    const double rcpPaths = 100.0/double(numPaths);
+
+    /*! print number of paths, mean length, and termination reasons */
+    std::ostringstream stream;
+    stream.setf(std::ios::fixed, std::ios::floatfield);
+    stream.precision(2);
+    stream << "paths   " << numPaths << " paths, " << double(numBounces)/double(numPaths) << " bounces on average";
+    for (size_t i=0; i<NUM_PATH_TERMINATIONS; i++) 
+      if (pathTerminations[i]) stream << ", " << reasons[i] << " " << double(size_t(pathTerminations[i]))*rcpPaths << "%";
+    stream << std::endl;
+
+    /*! print histogram of bounces, the last bin includes all longer paths */
+    stream << "bounces";
+    for (size_t i=0; i<PATH_LENGTH_BINS; i++) 
+      if (pathLengths[i]) stream << " " << i << (i == PATH_LENGTH_BINS-1 ? "+:" : ":") << double(size_t(pathLengths[i]))*rcpPaths << "%";
+    std::cout << stream.str() << std::endl;
+  }
+
+  void IntegratorRenderer::cropWindow(const Ref<SwapChain>& swapchain, Vec2i& start, Vec2i& end) const
+  {
+    /*! rounding up both corners lets adjacent windows share no pixel */
+    const float width = float(swapchain->getWidth()), height = float(swapchain->getHeight());
+    start = Vec2i(int(ceilf(cropMin.x*width)),int(ceilf(cropMin.y*height)));
+    end   = Vec2i(int(ceilf(cropMax.x*width)),int(ceilf(cropMax.y*height)));
   }
 
   IntegratorRenderer::RenderJob::RenderJob (Ref<IntegratorRenderer> renderer, const Ref<Camera>& camera, const Ref<BackendScene>& scene, 
-                                            const Ref<ToneMapper>& toneMapper, Ref<SwapChain > swapchain, int accumulate, int iteration)
+                                            const Ref<ToneMapper>& toneMapper, Ref<SwapChain > swapchain, int accumulate, int iteration, double deadline)
     : renderer(renderer), camera(camera), scene(scene), toneMapper(toneMapper), swapchain(swapchain), 
-      accumulate(accumulate), iteration(iteration), tileID(0), atomicNumRays(0)
+      accumulate(accumulate), iteration(iteration), deadline(deadline), tileID(0), atomicNumRays(0), atomicNumTiles(0), atomicOccluderTests(0), atomicOccluderHits(0)
   {
-    numTilesX = ((int)swapchain->getWidth() +TILE_SIZE-1)/TILE_SIZE;
-    numTilesY = ((int)swapchain->getHeight()+TILE_SIZE-1)/TILE_SIZE;
+    renderer->cropWindow(swapchain,cropStart,cropEnd);
+    numTilesX = (cropEnd.x-cropStart.x+TILE_SIZE-1)/TILE_SIZE;
+    numTilesY = (cropEnd.y-cropStart.y+TILE_SIZE-1)/TILE_SIZE;
     rcpWidth  = rcp(float(swapchain->getWidth()));
     rcpHeight = rcp(float(swapchain->getHeight()));
+    step = accumulate != 1 ? renderer->subsample : 1;
+    tileTime = 0.0;
+    if (renderer->raysPerSecond > 0.0) 
+      tileTime = double(renderer->raysPerPass)/renderer->raysPerSecond*double(TaskScheduler::getNumThreads())/double(numTilesX*numTilesY);
     this->framebuffer = swapchain->buffer();
-    this->framebuffer->startRendering(numTilesX*numTilesY);
+    if (renderer->aovs || renderer->denoiser || renderer->reproject) swapchain->enableAOVs();
+
+    /*! the denoiser finishes the tiles of the full frame */
+    if (renderer->denoiser) 
+      this->framebuffer->startRendering(((swapchain->getWidth()+TILE_SIZE-1)/TILE_SIZE)*((swapchain->getHeight()+TILE_SIZE-1)/TILE_SIZE));
+    else
+      this->framebuffer->startRendering(numTilesX*numTilesY);
     if (renderer->showProgress) new (&progress) Progress(numTilesX*numTilesY);
 
     if (renderer->showProgress) progress.start();
+    renderer->integrator->beginPass(this->scene);
     renderer->samplers->reset();
     renderer->integrator->requestSamples(renderer->samplers, scene);
     renderer->samplers->init(iteration,renderer->filter);
@@ -94,7 +244,18 @@ namespace embree
   void IntegratorRenderer::RenderJob::finish(size_t threadIndex, size_t threadCount, TaskScheduler::Event* event)
   {
     if (renderer->showProgress) progress.end();
+    renderer->integrator->endPass(scene);
     double dt = getSeconds()-t0;
+    renderer->jobRays = atomicNumRays;
+    renderer->jobOccluderTests = atomicOccluderTests;
+    renderer->jobOccluderHits = atomicOccluderHits;
+    renderer->jobCoverage = numTilesX*numTilesY != 0 ? double(size_t(atomicNumTiles))/double(numTilesX*numTilesY) : 1.0;
+
+    /*! time budgeted rendering prints statistics for the entire frame */
+    if (renderer->timeBudget > 0.0f) {
+      delete this;
+      return;
+    }
 
      /*! print fps, render time, and rays per second */
     std::ostringstream stream;
@@ -106,6 +267,10 @@ namespace embree
     stream << dt*1000.0f << " ms, ";
     stream.precision(3);
     stream << atomicNumRays/dt*1E-6 << " mrps";
+    if (atomicOccluderTests) {
+      stream.precision(2);
+      stream << ", " << 100.0*double(size_t(atomicOccluderHits))/double(size_t(atomicOccluderTests)) << "% occluder cache hits";
+    }
     std::cout << stream.str() << std::endl;
 
     rtcDebug();
@@ -118,6 +283,11 @@ namespace embree
     /*! create a new sampler */
     IntegratorState state;
     if (taskIndex == taskCount-1) t0 = getSeconds();
+    AOVBuffer* aovs = swapchain->aovs().ptr;
+
+    /*! the additional samples are generated per pixel sample into buffers of this thread */
+    float* samples1D = new float[renderer->samplers->numSamples1D];
+    Vec2f* samples2D = new Vec2f[renderer->samplers->numSamples2D];
     
     /*! tile pick loop */
     while (true)
@@ -126,11 +296,17 @@ namespace embree
       size_t tile = tileID++;
       if (tile >= numTilesX*numTilesY) break;
 
+      /*! skip tiles that would not finish before the deadline */
+      if (deadline > 0.0 && getSeconds()+tileTime > deadline) {
+        if (renderer->showProgress) progress.next();
+        if (!renderer->denoiser) framebuffer->finishTile();
+        continue;
+      }
+
       /*! process all tile samples */
-      const int tile_x = (tile%numTilesX)*TILE_SIZE;
-      const int tile_y = (tile/numTilesX)*TILE_SIZE;
-      Random randomNumberGenerator(tile_x * 91711 + tile_y * 81551 + 3433*swapchain->firstActiveLine());
-      
+      const int tile_x = cropStart.x+(tile%numTilesX)*TILE_SIZE;
+      const int tile_y = cropStart.y+(tile/numTilesX)*TILE_SIZE;
+
       //#define PRE_INIT_SETS
 #if defined(PRE_INIT_SETS)
       int sets[TILE_SIZE][TILE_SIZE];
@@ -138,7 +314,7 @@ namespace embree
       for (size_t dy=0; dy<TILE_SIZE; dy++)
       {
         size_t y = tile_y+dy;
-        if (y >= swapchain->getHeight()) continue;
+        if (y >= size_t(cropEnd.y)) continue;
 
         if (!swapchain->activeLine(y)) continue;
         size_t _y = swapchain->raster2buffer(y);
@@ -146,9 +322,9 @@ namespace embree
         for (size_t dx=0; dx<TILE_SIZE; dx++)
         {
           size_t x = tile_x+dx;
-          if (x >= swapchain->getWidth()) continue;
+          if (x >= size_t(cropEnd.x)) continue;
 
-          sets[dy][dx] = randomNumberGenerator.getInt(renderer->samplers->sampleSets);
+          sets[dy][dx] = randomHash(uint32(x),uint32(y),0u) % renderer->samplers->sampleSets;
         }
       }
 #endif
@@ -156,39 +332,95 @@ namespace embree
       for (size_t dy=0; dy<TILE_SIZE; dy++)
       {
         size_t y = tile_y+dy;
-        if (y >= swapchain->getHeight()) continue;
+        if (y >= size_t(cropEnd.y)) continue;
 
         if (!swapchain->activeLine(y)) continue;
         size_t _y = swapchain->raster2buffer(y);
+
+        /*! subsampled frames trace the first pixel of each block inside the crop window */
+        const size_t by = y/step*step;
+        if (y != max(by,size_t(cropStart.y))) continue;
         
         for (size_t dx=0; dx<TILE_SIZE; dx++)
         {
           size_t x = tile_x+dx;
-          if (x >= swapchain->getWidth()) continue;
+          if (x >= size_t(cropEnd.x)) continue;
+
+          const size_t bx = x/step*step;
+          if (x != max(bx,size_t(cropStart.x))) continue;
 
 #if !defined(PRE_INIT_SETS)
-          const int set = randomNumberGenerator.getInt(renderer->samplers->sampleSets);          
+          /*! the sample set is a hash of the pixel, thus independent of the tile order */
+          const int set = randomHash(uint32(x),uint32(y),0u) % renderer->samplers->sampleSets;
 #else
           const int set = sets[dy][dx];
 #endif
           Color L = zero;
+          AOVSample aovSum;
+          Ray primary0;
           size_t spp = renderer->samplers->samplesPerPixel;
           for (size_t s=0; s<spp; s++)
           {
-            PrecomputedSample& sample = renderer->samplers->samples[set][s];
+            PrecomputedSample sample = renderer->samplers->samples[set][s];
+            sample.samples1D = samples1D;
+            sample.samples2D = samples2D;
+            renderer->samplers->generate(sample,sampleKey(Vec2i(int(x),int(y)),int(iteration*spp+s)));
             const float fx = (float(x) + sample.pixel.x)*rcpWidth;
             const float fy = (float(y) + sample.pixel.y)*rcpHeight;
 
             Ray primary; camera->ray(Vec2f(fx,fy), sample.getLens(), primary);
             primary.time = sample.getTime();
+            if (s == 0) primary0 = primary;
+
+            /*! rays through the neighbouring pixels estimate the footprint for texture filtering */
+            Ray primaryX; camera->ray(Vec2f(fx+float(step)*rcpWidth,fy), sample.getLens(), primaryX);
+            Ray primaryY; camera->ray(Vec2f(fx,fy+float(step)*rcpHeight), sample.getLens(), primaryY);
             
+            AOVSample aov;
             state.sample = &sample;
+            state.differentials = RayDifferentials(primary,primaryX,primaryY);
             state.pixel = Vec2f(fx,fy);
+            state.aov = aovs ? &aov : NULL;
             L += renderer->integrator->Li(primary, scene, state);
+
+            /*! sum up auxiliary outputs, depth and primitive ID come from the first sample */
+            if (aovs) {
+              aovSum.albedo += aov.albedo;
+              aovSum.normal += aov.normal;
+              aovSum.direct += aov.direct;
+              if (s == 0) { aovSum.depth = aov.depth; aovSum.primID = aov.primID; }
+            }
+          }
+          if (aovs) aovs->update(x, _y, aovSum, L, float(spp), accumulate == 1);
+
+          /*! add the history of the previous frame warped into the new view */
+          Vec4f history = zero;
+          if (accumulate == 2 && aovs) history = renderer->reprojector->lookup(swapchain,primary0,aovSum);
+          const Color L0 = swapchain->update(x, _y, L+Color(history.x,history.y,history.z), float(spp)+history.w, accumulate == 1);
+
+          /*! the denoiser writes the framebuffer after all tiles are accumulated */
+          if (!renderer->denoiser) {
+            const Color L1 = toneMapper->eval(L0,x,y,swapchain);
+            framebuffer->set(x, _y, L1);
+          }
+          if (step == 1) continue;
+
+          /*! copy the pixel to the rest of its block with a small weight,
+           *  thus the first full resolution pass replaces the copies */
+          const float w = 1E-3f, scale = w*rcp(float(spp));
+          AOVSample fill = aovSum;
+          fill.albedo *= scale; fill.normal *= scale; fill.direct *= scale;
+          for (size_t yy=y; yy<min(by+step,size_t(cropEnd.y)); yy++) 
+          {
+            const size_t _yy = swapchain->raster2buffer(yy);
+            for (size_t xx=x; xx<min(bx+step,size_t(cropEnd.x)); xx++) 
+            {
+              if (xx == x && yy == y) continue;
+              swapchain->accu()->set(xx, _yy, Vec4f(L0.r*w,L0.g*w,L0.b*w,w));
+              if (aovs) aovs->update(xx, _yy, fill, L*scale, w, false);
+              if (!renderer->denoiser) framebuffer->set(xx, _yy, toneMapper->eval(L0,int(xx),int(yy),swapchain));
+            }
           }
-          const Color L0 = swapchain->update(x, _y, L, spp, accumulate);
-          const Color L1 = toneMapper->eval(L0,x,y,swapchain);
-          framebuffer->set(x, _y, L1);
         }
       }
       
@@ -196,10 +428,20 @@ namespace embree
       if (renderer->showProgress) progress.next();
 
       /*! mark one more tile as finished */
-      framebuffer->finishTile();
+      if (!renderer->denoiser) framebuffer->finishTile();
+      atomicNumTiles++;
     }
 
-    /*! we access the atomic ray counter only once per tile */
+    delete[] samples1D;
+    delete[] samples2D;
+
+    /*! we access the atomic ray counters only once per tile */
     atomicNumRays += state.numRays;
+    atomicOccluderTests += state.numOccluderTests;
+    atomicOccluderHits += state.numOccluderHits;
+    for (size_t i=0; i<PATH_LENGTH_BINS; i++) 
+      if (state.pathLengths[i]) renderer->pathLengths[i] += state.pathLengths[i];
+    for (size_t i=0; i<NUM_PATH_TERMINATIONS; i++) 
+      if (state.pathTerminations[i]) renderer->pathTerminations[i] += state.pathTerminations[i];
   }
 }
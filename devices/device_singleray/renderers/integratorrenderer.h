@@ -22,6 +22,8 @@
 #include "../samplers/sampler.h"
 #include "../filters/filter.h"
 #include "../renderers/progress.h"
+#include "../renderers/denoiser.h"
+#include "../renderers/reprojector.h"
 #include "common/sys/taskscheduler.h"
 
 namespace embree
@@ -35,16 +37,24 @@ namespace embree
     /*! Construction from parameters. */
     IntegratorRenderer (const Parms& parms);
 
-    /*! Renders a single frame. */
+    /*! Renders a single frame. Accumulation mode 0 restarts,
+     *  mode 1 accumulates, and mode 2 restarts from the accumulated
+     *  image of the previous frame reprojected into the new camera. */
     void renderFrame(const Ref<Camera>& camera, const Ref<BackendScene>& scene, const Ref<ToneMapper>& toneMapper, Ref<SwapChain > film, int accumulate);
 
+    /*! Computes the pixel range [start,end) covered by the crop window. */
+    void cropWindow(const Ref<SwapChain>& swapchain, Vec2i& start, Vec2i& end) const;
+
+    /*! Prints the path length and termination histograms of the frame. */
+    void printPathStatistics() const;
+
   private:
 
     class RenderJob
     {
     public:
       RenderJob (Ref<IntegratorRenderer> renderer, const Ref<Camera>& camera, const Ref<BackendScene>& scene, 
-                 const Ref<ToneMapper>& toneMapper, Ref<SwapChain > swapchain, int accumulate, int iteration);
+                 const Ref<ToneMapper>& toneMapper, Ref<SwapChain > swapchain, int accumulate, int iteration, double deadline);
        
     private:
 
@@ -64,6 +74,7 @@ namespace embree
       Ref<SwapChain > swapchain;   //!< Swapchain to render into
       int accumulate;                //!< Accumulation mode
       int iteration;
+      double deadline;               //!< No tiles are started after this time, 0 disables the deadline
 
       /*! Precomputations. */
     private:
@@ -71,11 +82,18 @@ namespace embree
       float rcpHeight;               //!< Reciprocal height of framebuffer.
       size_t numTilesX;              //!< Number of tiles in x direction.
       size_t numTilesY;              //!< Number of tiles in y direction.
+      Vec2i cropStart;               //!< First pixel of the crop window.
+      Vec2i cropEnd;                 //!< Pixel after the last pixel of the crop window.
+      size_t step;                   //!< Size of the pixel blocks sharing a single traced pixel.
+      double tileTime;               //!< Estimated time a thread spends on one tile.
       
     private:
       double t0;                     //!< start time of rendering
       Atomic tileID;                 //!< ID of current tile
       Atomic atomicNumRays;          //!< for counting number of shoot rays
+      Atomic atomicNumTiles;         //!< for counting number of rendered tiles
+      Atomic atomicOccluderTests;    //!< for counting shadow rays tested against a cached blocker
+      Atomic atomicOccluderHits;     //!< for counting shadow rays blocked by the cached blocker
       Progress progress;             //!< Progress printer
       TaskScheduler::Task task;
     };
@@ -84,15 +102,34 @@ namespace embree
   private:
     int maxDepth;                  //!< Maximal recursion depth.
     float gamma;                   //!< Gamma to use for framebuffer writeback.
+    bool aovs;                     //!< Renders auxiliary channels into the swapchain.
+    bool compactAccu;              //!< Accumulates the first AccuBuffer::MAX_COMPACT_WEIGHT samples in half precision with a separate weight plane.
+    float timeBudget;              //!< Time budget per frame in seconds, 0 renders a single pass.
+    Vec2f cropMin;                 //!< Lower corner of the crop window in normalized raster coordinates.
+    Vec2f cropMax;                 //!< Upper corner of the crop window in normalized raster coordinates.
+    size_t subsample;              //!< Block size of frames that restart accumulation, 1 renders full resolution.
     
   private:
     Ref<Integrator> integrator;    //!< Integrator to use.
     Ref<SamplerFactory> samplers;  //!< Sampler to use.
     Ref<Filter> filter;            //!< Pixel filter to use.
+    Ref<Denoiser> denoiser;        //!< Denoiser applied before tonemapping, NULL if disabled.
+    Ref<Reprojector> reprojector;  //!< Warps the previous frame into the new camera.
+    bool reproject;                //!< Set once reprojection got requested, keeps auxiliary channels enabled.
 
   private:
     int iteration;
+    double raysPerSecond;          //!< Measured ray throughput of the last complete pass.
+    size_t raysPerPass;            //!< Number of rays shot by the last complete pass.
+    double samplesAccumulated;     //!< Samples per pixel accumulated since the last reset.
+    size_t jobRays;                //!< Number of rays shot by the last render job.
+    double jobCoverage;            //!< Fraction of tiles rendered by the last render job.
+    size_t jobOccluderTests;       //!< Number of shadow rays of the last render job tested against a cached blocker.
+    size_t jobOccluderHits;        //!< Number of shadow rays of the last render job blocked by the cached blocker.
     bool showProgress;             //!< Set to true if user wants rendering progress shown
+    bool pathStatistics;           //!< Prints path length and termination histograms after each frame.
+    Atomic pathLengths[PATH_LENGTH_BINS];            //!< Histogram of the bounces of the paths of the frame.
+    Atomic pathTerminations[NUM_PATH_TERMINATIONS];  //!< Histogram of the termination reasons of the paths of the frame.
   };
 }
 
@@ -52,6 +52,26 @@ namespace embree
     int id1;           //!< 2nd primitive ID
   };
 
+  /*! Derivatives of ray origin and direction with respect to the
+   *  raster position, used to estimate texture footprints. */
+  struct RayDifferentials
+  {
+    /*! Default construction marks the differentials as unknown. */
+    __forceinline RayDifferentials()
+      : dOdx(zero), dOdy(zero), dDdx(zero), dDdy(zero), valid(false) {}
+
+    /*! Constructs differentials from rays offset by one pixel in x and y. */
+    __forceinline RayDifferentials(const Ray& ray, const Ray& rx, const Ray& ry)
+      : dOdx(rx.org-ray.org), dOdy(ry.org-ray.org), dDdx(rx.dir-ray.dir), dDdy(ry.dir-ray.dir), valid(true) {}
+
+  public:
+    Vector3f dOdx;     //!< Change of the origin for a step of one pixel in x
+    Vector3f dOdy;     //!< Change of the origin for a step of one pixel in y
+    Vector3f dDdx;     //!< Change of the direction for a step of one pixel in x
+    Vector3f dDdy;     //!< Change of the direction for a step of one pixel in y
+    bool valid;        //!< False if the differentials are unknown
+  };
+
   /*! Outputs ray to stream. */
   inline std::ostream& operator<<(std::ostream& cout, const Ray& ray) {
     return cout << "{ " << 
@@ -0,0 +1,102 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#include "renderers/reprojector.h"
+
+namespace embree
+{
+  /*! distance at which primary rays that miss the scene are projected */
+  static const float missDistance = 1E6f;
+
+  Reprojector::Reprojector (const Parms& parms)
+    : width(0), height(0), color(NULL), depth(NULL), normal(NULL), swapchain(null), valid(false)
+  {
+    decay          = clamp(parms.getFloat("reproject.decay",0.8f),0.0f,1.0f);
+    depthTolerance = parms.getFloat("reproject.depthTolerance",0.05f);
+    minNormalCos   = parms.getFloat("reproject.minNormalCos",0.9f);
+  }
+
+  Reprojector::~Reprojector ()
+  {
+    delete[] color;  color  = NULL;
+    delete[] depth;  depth  = NULL;
+    delete[] normal; normal = NULL;
+  }
+
+  void Reprojector::begin(Ref<SwapChain> swapchain)
+  {
+    /*! the history is only usable for the swapchain and camera of the last frame */
+    Ref<AccuBuffer>& accu = swapchain->accu();
+    Ref<AOVBuffer>& aovs = swapchain->aovs();
+    valid = camera && aovs && swapchain == this->swapchain;
+    if (!valid) return;
+
+    if (width != accu->getWidth() || height != accu->getHeight()) {
+      delete[] color;  color  = NULL;
+      delete[] depth;  depth  = NULL;
+      delete[] normal; normal = NULL;
+      width  = accu->getWidth();
+      height = accu->getHeight();
+      color  = new Vec4f[width*height];
+      depth  = new float[width*height];
+      normal = new Vector3f[width*height];
+    }
+
+    for (size_t y=0; y<height; y++) {
+      for (size_t x=0; x<width; x++) {
+        color [y*width+x] = accu->getSum(x,y);
+        const Vector3f N = aovs->get(AOVBuffer::NORMAL,x,y);
+        depth [y*width+x] = aovs->getDepth(x,y);
+        normal[y*width+x] = dot(N,N) > 0.0f ? normalize(N) : Vector3f(zero);
+      }
+    }
+  }
+
+  void Reprojector::end(Ref<SwapChain> swapchain, const Ref<Camera>& camera)
+  {
+    this->swapchain = swapchain;
+    this->camera = camera;
+  }
+
+  Vec4f Reprojector::lookup(Ref<SwapChain> swapchain, const Ray& ray, const AOVSample& aov) const
+  {
+    if (!valid) return Vec4f(zero);
+
+    /*! project the primary hit into the previous camera */
+    const bool miss = aov.depth == float(inf);
+    const Vector3f p = ray.org + (miss ? missDistance : aov.depth)*ray.dir;
+    Vec2f pixel; float dist;
+    if (!camera->project(p,pixel,dist)) return Vec4f(zero);
+    const float fx = pixel.x*float(swapchain->getWidth());
+    const float fy = pixel.y*float(swapchain->getHeight());
+    if (fx < 0.0f || fy < 0.0f || fx >= float(swapchain->getWidth()) || fy >= float(swapchain->getHeight())) return Vec4f(zero);
+    const size_t x = size_t(fx), y = size_t(fy);
+    if (!swapchain->activeLine(int(y))) return Vec4f(zero);
+    const size_t i = swapchain->raster2buffer(y)*width+x;
+
+    /*! reject disocclusions by depth and normal tests */
+    if (miss || depth[i] == float(inf)) {
+      if (!miss || depth[i] != float(inf)) return Vec4f(zero);
+    }
+    else {
+      if (abs(dist-depth[i]) > depthTolerance*depth[i]) return Vec4f(zero);
+      const Vector3f N = dot(aov.normal,aov.normal) > 0.0f ? normalize(aov.normal) : Vector3f(zero);
+      if (dot(N,normal[i]) < minNormalCos) return Vec4f(zero);
+    }
+    return decay*color[i];
+  }
+}
@@ -0,0 +1,74 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#ifndef __EMBREE_REPROJECTOR_H__
+#define __EMBREE_REPROJECTOR_H__
+
+#include "../renderers/renderer.h"
+#include "../cameras/camera.h"
+
+namespace embree
+{
+  /*! Warps the accumulated radiance of the previous frame into the
+   *  view of a moved camera. The primary hit of a new pixel is
+   *  projected into the previous camera, and the history of the pixel
+   *  it lands on is reused if depth and normal agree. Disoccluded
+   *  pixels restart from the new samples. The weight of the history
+   *  decays with every reprojection, so that errors of the warp fade
+   *  out. */
+  class Reprojector : public RefCount
+  {
+  public:
+
+    /*! Construction from parameters. */
+    Reprojector (const Parms& parms);
+
+    /*! Destruction. */
+    ~Reprojector ();
+
+    /*! Copies the accumulated radiance, depth, and normal of the
+     *  swapchain as history before the swapchain gets overwritten. */
+    void begin(Ref<SwapChain> swapchain);
+
+    /*! Records the camera the swapchain was rendered with. */
+    void end(Ref<SwapChain> swapchain, const Ref<Camera>& camera);
+
+    /*! Returns the reprojected history of a pixel as radiance sum and
+     *  weight, or zero if it was rejected. \param ray is the primary
+     *  ray and \param aov the auxiliary outputs of its sample. */
+    Vec4f lookup(Ref<SwapChain> swapchain, const Ray& ray, const AOVSample& aov) const;
+
+    /*! Configuration */
+  private:
+    float decay;                   //!< Factor applied to the history weight per reprojection.
+    float depthTolerance;          //!< Maximal relative depth difference of accepted history.
+    float minNormalCos;            //!< Minimal cosine between normals of accepted history.
+
+    /*! History of the previous frame. */
+  private:
+    size_t width;                  //!< Width of the history buffers.
+    size_t height;                 //!< Height of the history buffers.
+    Vec4f* color;                  //!< Accumulated radiance and weight.
+    float* depth;                  //!< Distance to the primary hit.
+    Vector3f* normal;              //!< Normalized shading normal at the primary hit.
+    Ref<SwapChain> swapchain;      //!< Swapchain the history belongs to, kept alive so that its address cannot be reused.
+    Ref<Camera> camera;            //!< Camera of the last frame rendered into that swapchain.
+    bool valid;                    //!< True if the history matches the camera.
+  };
+}
+
+#endif
@@ -0,0 +1,100 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "aliastable2d.h"
+
+namespace embree
+{
+  AliasTable2D::AliasTable2D(const float** f, const size_t width, const size_t height)
+    : width(width), height(height), f(f)
+  {
+    yTable = new Entry[height];
+    xTable = new Entry[height*width];
+    rowSums = new float[height];
+
+    /*! build the row tables in parallel */
+    const size_t numTasks = min(height,4*TaskScheduler::getNumThreads());
+    TaskScheduler::EventSync event;
+    TaskScheduler::Task task(&event,_buildRows,this,numTasks,NULL,NULL,"alias::rows");
+    TaskScheduler::addTask(-1,TaskScheduler::GLOBAL_BACK,&task);
+    event.sync();
+
+    /*! build the table to select rows */
+    int* work = new int[height];
+    float sum; build(rowSums,height,yTable,work,sum);
+    delete[] work;
+    delete[] rowSums; rowSums = NULL;
+    this->f = NULL;
+  }
+
+  AliasTable2D::~AliasTable2D() {
+    delete[] yTable; yTable = NULL;
+    delete[] xTable; xTable = NULL;
+  }
+
+  void AliasTable2D::buildRows(size_t threadIndex, size_t threadCount, size_t taskIndex, size_t taskCount, TaskScheduler::Event* event)
+  {
+    const size_t y0 = (taskIndex+0)*height/taskCount;
+    const size_t y1 = (taskIndex+1)*height/taskCount;
+    int* work = new int[width];
+    for (size_t y=y0; y<y1; y++)
+      build(f[y],width,xTable+y*width,work,rowSums[y]);
+    delete[] work;
+  }
+
+  void AliasTable2D::build(const float* f, const size_t size, Entry* table, int* work, float& sum)
+  {
+    /*! accumulate the function f */
+    double dsum = 0.0;
+    for (size_t i=0; i<size; i++) dsum += f[i];
+    sum = float(dsum);
+
+    /*! zero function, select every entry with zero density */
+    if (dsum == 0.0) {
+      for (size_t i=0; i<size; i++) {
+        table[i].prob = 1.0f; table[i].alias = int(i); table[i].pdf = 0.0f;
+      }
+      return;
+    }
+
+    /*! scale to an average of 1 and split into small and large
+     *  entries, the small ones are stacked at the front of the work
+     *  array and the large ones at the back */
+    const float scale = float(double(size)/dsum);
+    size_t numSmall = 0, numLarge = 0;
+    for (size_t i=0; i<size; i++) {
+      table[i].pdf = table[i].prob = f[i]*scale;
+      table[i].alias = int(i);
+      if (table[i].prob < 1.0f) work[numSmall++] = int(i);
+      else                      work[size-1-numLarge++] = int(i);
+    }
+
+    /*! fill each small entry with the excess of a large one */
+    while (numSmall && numLarge)
+    {
+      const int s = work[--numSmall];
+      const int l = work[size-numLarge--];
+      table[s].alias = l;
+      table[l].prob = (table[l].prob + table[s].prob) - 1.0f;
+      if (table[l].prob < 1.0f) work[numSmall++] = l;
+      else                      work[size-1-numLarge++] = l;
+    }
+
+    /*! remaining entries are full up to rounding errors */
+    while (numSmall) table[work[--numSmall]].prob = 1.0f;
+    while (numLarge) table[work[size-numLarge--]].prob = 1.0f;
+  }
+}
@@ -0,0 +1,106 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#ifndef __EMBREE_ALIAS_TABLE_2D_H__
+#define __EMBREE_ALIAS_TABLE_2D_H__
+
+#include "../default.h"
+#include "sys/taskscheduler.h"
+
+namespace embree
+{
+  /*! 2D probability distribution sampled with the alias method. A
+   *  row is selected with an alias table over the row sums, and a
+   *  column with the alias table of that row, so drawing a sample
+   *  costs two table lookups independent of the resolution. The
+   *  per-row tables are built in parallel. */
+  class AliasTable2D : public RefCount
+  {
+    /*! Entry of an alias table. */
+    struct Entry {
+      float prob;  //!< Probability to keep this entry instead of the alias
+      int   alias; //!< Entry to select otherwise
+      float pdf;   //!< Normalized density of this entry (average of 1)
+    };
+
+  public:
+
+    /*! Construction from 2D distribution array f. */
+    AliasTable2D(const float** f, const size_t width, const size_t height);
+
+    /*! Destruction. */
+    ~AliasTable2D();
+
+  public:
+
+    /*! Draws a sample from the distribution. \param u is a pair of
+     *  random numbers to use for sampling. Returns the continuous
+     *  position in [0,width)x[0,height) and the density with respect
+     *  to the unit square. */
+    __forceinline Sample2f sample(const Vec2f& u) const
+    {
+      float fy; const Entry& ey = sample(yTable,height,u.y,fy);
+      const int y = int(&ey-yTable);
+      float fx; const Entry& ex = sample(xTable+y*width,width,u.x,fx);
+      const int x = int(&ex-xTable)-y*int(width);
+      return Sample2f(Vec2f(float(x)+fx,float(y)+fy),ex.pdf*ey.pdf);
+    }
+
+    /*! Returns the probability density a sample would be drawn from
+     *  location p in the unit square. */
+    __forceinline float pdf(const Vec2f& p) const {
+      const size_t x = clamp(ssize_t(p.x*width ),ssize_t(0),ssize_t(width -1));
+      const size_t y = clamp(ssize_t(p.y*height),ssize_t(0),ssize_t(height-1));
+      return pdf(x,y);
+    }
+
+    /*! Returns the probability density of element (x,y). */
+    __forceinline float pdf(const size_t x, const size_t y) const {
+      return xTable[y*width+x].pdf * yTable[y].pdf;
+    }
+
+  private:
+
+    /*! Selects an entry of a 1D table and returns the remapped
+     *  fraction of u inside the selected entry. */
+    static __forceinline const Entry& sample(const Entry* table, const size_t size, const float u, float& frac)
+    {
+      const float s = u*float(size);
+      const size_t i = min(size_t(max(s,0.0f)),size-1);
+      const float r = min(s-float(i),0.99999994f); // largest float below 1
+      const Entry& e = table[i];
+      if (r < e.prob) { frac = r*rcp(e.prob); return e; }
+      frac = min((r-e.prob)*rcp(1.0f-e.prob),0.99999994f);
+      return table[e.alias];
+    }
+
+    /*! Builds a 1D alias table using Vose's method. */
+    static void build(const float* f, const size_t size, Entry* table, int* work, float& sum);
+
+    /*! Builds the alias tables of a range of rows. */
+    TASK_RUN_FUNCTION(AliasTable2D,buildRows);
+
+  private:
+    size_t width;        //!< Number of elements in x direction
+    size_t height;       //!< Number of elements in y direction
+    Entry* yTable;       //!< Alias table to select between rows
+    Entry* xTable;       //!< One alias table per row
+    const float** f;     //!< Input function, only valid during construction
+    float* rowSums;      //!< Row sums, only valid during construction
+  };
+}
+
+#endif
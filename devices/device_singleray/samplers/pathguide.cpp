@@ -0,0 +1,233 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "pathguide.h"
+
+namespace embree
+{
+  /*! maximal depth of the quadtrees */
+  #define GUIDE_MAX_DTREE_DEPTH 20
+
+  /*! maximal depth of the spatial tree */
+  #define GUIDE_MAX_STREE_DEPTH 24
+
+  /*! quadrants holding more than this fraction of the energy get subdivided */
+  #define GUIDE_DTREE_THRESHOLD 0.01f
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Directional Quadtree
+  ////////////////////////////////////////////////////////////////////////////////
+
+  PathGuide::DTree::Node::Node () {
+    for (size_t i=0; i<4; i++) { sum[i] = 0.0f; child[i] = 0; }
+  }
+
+  Vec2f PathGuide::DTree::sample(Vec2f u, float& pdf) const
+  {
+    Vec2f origin(0.0f,0.0f);
+    float size = 1.0f; pdf = 1.0f;
+    for (int n=0;;)
+    {
+      const Node& node = nodes[n];
+      const float total = node.sum[0]+node.sum[1]+node.sum[2]+node.sum[3];
+      if (total <= 0.0f) return origin + u*size;
+
+      /*! select the column proportional to its energy, then the quadrant inside the column */
+      const float pl = (node.sum[0]+node.sum[2])*rcp(total);
+      int qx = 0; if (u.x < pl) u.x = u.x*rcp(pl); else { qx = 1; u.x = (u.x-pl)*rcp(1.0f-pl); }
+      const float pt = node.sum[qx]*rcp(node.sum[qx]+node.sum[qx+2]);
+      int qy = 0; if (u.y < pt) u.y = u.y*rcp(pt); else { qy = 1; u.y = (u.y-pt)*rcp(1.0f-pt); }
+      u = Vec2f(min(u.x,0.99999994f),min(u.y,0.99999994f));
+
+      const int q = qx+2*qy;
+      pdf *= 4.0f*node.sum[q]*rcp(total);
+      size *= 0.5f;
+      origin += Vec2f(float(qx),float(qy))*size;
+      if (!node.child[q]) return origin + u*size;
+      n = node.child[q];
+    }
+  }
+
+  float PathGuide::DTree::pdf(Vec2f p) const
+  {
+    float pdf = 1.0f;
+    for (int n=0;;)
+    {
+      const Node& node = nodes[n];
+      const float total = node.sum[0]+node.sum[1]+node.sum[2]+node.sum[3];
+      if (total <= 0.0f) return n ? pdf : 0.0f;
+      const int qx = p.x >= 0.5f, qy = p.y >= 0.5f, q = qx+2*qy;
+      pdf *= 4.0f*node.sum[q]*rcp(total);
+      if (!node.child[q]) return pdf;
+      p = Vec2f(2.0f*p.x-float(qx),2.0f*p.y-float(qy));
+      n = node.child[q];
+    }
+  }
+
+  void PathGuide::DTree::record(Vec2f p, const float value)
+  {
+    for (int n=0;;)
+    {
+      Node& node = nodes[n];
+      const int qx = p.x >= 0.5f, qy = p.y >= 0.5f, q = qx+2*qy;
+      atomic_add_float(&node.sum[q],value);
+      if (!node.child[q]) return;
+      p = Vec2f(2.0f*p.x-float(qx),2.0f*p.y-float(qy));
+      n = node.child[q];
+    }
+  }
+
+  /*! node of a refined tree together with the corresponding node of
+   *  the source tree, if any, and the energy of its quadrants */
+  struct RefineItem {
+    int node, src; size_t depth; float energy[4];
+  };
+
+  PathGuide::DTree PathGuide::DTree::refined(const float threshold, const size_t maxDepth) const
+  {
+    DTree tree;
+    const float total = this->total();
+    RefineItem root; root.node = 0; root.src = 0; root.depth = 1;
+    for (size_t q=0; q<4; q++) root.energy[q] = nodes[0].sum[q];
+    std::vector<RefineItem> stack(1,root);
+
+    while (!stack.empty())
+    {
+      const RefineItem item = stack.back(); stack.pop_back();
+      if (item.depth >= maxDepth) continue;
+      for (size_t q=0; q<4; q++)
+      {
+        /*! without recorded energy the structure is kept */
+        const int srcChild = item.src >= 0 ? nodes[item.src].child[q] : 0;
+        const bool split = total > 0.0f ? item.energy[q] > threshold*total : srcChild != 0;
+        if (!split) continue;
+
+        /*! the energy of new quadrants is assumed to be uniform */
+        RefineItem child; child.node = int(tree.nodes.size()); child.src = srcChild ? srcChild : -1; child.depth = item.depth+1;
+        for (size_t i=0; i<4; i++) child.energy[i] = srcChild ? nodes[srcChild].sum[i] : 0.25f*item.energy[q];
+        tree.nodes.push_back(Node());
+        tree.nodes[item.node].child[q] = child.node;
+        stack.push_back(child);
+      }
+    }
+    return tree;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+  /// Spatial Tree
+  ////////////////////////////////////////////////////////////////////////////////
+
+  PathGuide::PathGuide (const float spatialThreshold, const size_t rounds)
+    : spatialThreshold(spatialThreshold), rounds(rounds), round(0), passes(0), bounds(empty), recordedBounds(empty)
+  {
+    nodes.push_back(Node(0));
+    regions.resize(1);
+  }
+
+  size_t PathGuide::region(const Vector3f& P) const
+  {
+    if (nodes[0].region >= 0) return nodes[0].region;
+    const Vector3f d = size(bounds);
+    Vector3f p = (P-bounds.lower)/d;
+    p = Vector3f(clamp(p.x,0.0f,1.0f),clamp(p.y,0.0f,1.0f),clamp(p.z,0.0f,1.0f));
+    int n = 0;
+    for (size_t depth=0; nodes[n].region < 0; depth++)
+    {
+      float& x = p[depth%3];
+      if (x < 0.5f) { x = 2.0f*x;        n = nodes[n].child[0]; }
+      else          { x = 2.0f*x - 1.0f; n = nodes[n].child[1]; }
+    }
+    return nodes[n].region;
+  }
+
+  Sample3f PathGuide::sample(const size_t region, const Vec2f& u) const
+  {
+    const DTree& tree = regions[region].sampling;
+    if (tree.total() <= 0.0f) return Sample3f(zero,0.0f);
+    float pdf; const Vec2f p = tree.sample(u,pdf);
+    return Sample3f(square2dir(p),pdf*float(one_over_four_pi));
+  }
+
+  float PathGuide::pdf(const size_t region, const Vector3f& wi) const {
+    return regions[region].sampling.pdf(dir2square(wi))*float(one_over_four_pi);
+  }
+
+  void PathGuide::record(const size_t region, const Vector3f& P, const Vector3f& wi, const float value)
+  {
+    Region& r = regions[region];
+    atomic_add(&r.numSamples,1);
+    if (value > 0.0f && finite(value)) r.building.record(dir2square(wi),value);
+
+    /*! the box of the spatial tree is fixed at the end of the first round with samples */
+    if (isEmpty(bounds)) {
+      atomic_min_float(&recordedBounds.lower.x,P.x); atomic_max_float(&recordedBounds.upper.x,P.x);
+      atomic_min_float(&recordedBounds.lower.y,P.y); atomic_max_float(&recordedBounds.upper.y,P.y);
+      atomic_min_float(&recordedBounds.lower.z,P.z); atomic_max_float(&recordedBounds.upper.z,P.z);
+    }
+  }
+
+  void PathGuide::endPass()
+  {
+    if (!training()) return;
+    if (++passes < (size_t(1) << round)) return;
+    update();
+    passes = 0;
+  }
+
+  void PathGuide::update()
+  {
+    /*! the box of the spatial tree is slightly enlarged to keep all recorded points inside */
+    if (isEmpty(bounds) && !isEmpty(recordedBounds)) {
+      const Vector3f d = max(size(recordedBounds)*0.01f,Vector3f(1E-3f));
+      bounds = BBox3f(recordedBounds.lower-d,recordedBounds.upper+d);
+    }
+
+    /*! the recorded distributions get sampled in the next round */
+    for (size_t i=0; i<regions.size(); i++) {
+      regions[i].sampling = regions[i].building;
+      regions[i].building = regions[i].building.refined(GUIDE_DTREE_THRESHOLD,GUIDE_MAX_DTREE_DEPTH);
+    }
+
+    /*! split spatial leaves that received many samples, the samples
+     *  get distributed evenly to the children */
+    const float threshold = spatialThreshold*sqrtf(float(size_t(1) << round));
+    std::vector<std::pair<int,size_t> > stack(1,std::pair<int,size_t>(0,0));
+    while (!isEmpty(bounds) && !stack.empty())
+    {
+      const int n = stack.back().first;
+      const size_t depth = stack.back().second;
+      stack.pop_back();
+
+      const int r = nodes[n].region;
+      if (r >= 0) {
+        if (depth >= GUIDE_MAX_STREE_DEPTH || float(regions[r].numSamples) <= threshold) continue;
+        regions[r].numSamples /= 2;
+        const int r1 = int(regions.size());
+        const Region copy = regions[r];
+        regions.push_back(copy);
+        nodes[n].child[0] = int(nodes.size()); nodes.push_back(Node(r));
+        nodes[n].child[1] = int(nodes.size()); nodes.push_back(Node(r1));
+        nodes[n].region = -1;
+      }
+      stack.push_back(std::pair<int,size_t>(nodes[n].child[0],depth+1));
+      stack.push_back(std::pair<int,size_t>(nodes[n].child[1],depth+1));
+    }
+
+    for (size_t i=0; i<regions.size(); i++) 
+      regions[i].numSamples = 0;
+    round++;
+  }
+}
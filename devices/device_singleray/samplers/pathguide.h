@@ -0,0 +1,154 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#ifndef __EMBREE_PATH_GUIDE_H__
+#define __EMBREE_PATH_GUIDE_H__
+
+#include "../default.h"
+#include "math/bbox.h"
+
+#include <vector>
+
+namespace embree
+{
+  /*! Learned distribution of the incident radiance used for path
+   *  guiding. A binary spatial tree over the scene bounds stores a
+   *  quadtree over the sphere of directions in each leaf (SD-tree).
+   *  Paths record their incident radiance into the building
+   *  quadtrees, while directions are sampled from the sampling
+   *  quadtrees of the previous training round. After 1, 2, 4,
+   *  ... passes the building trees replace the sampling trees and get
+   *  refined to the recorded energy, and spatial leaves that received
+   *  many samples are split. */
+  class PathGuide : public RefCount
+  {
+    /*! Quadtree over the cylindrical mapping of the sphere, which
+     *  preserves area, thus densities differ by a factor of 4*pi. */
+    class DTree
+    {
+      /*! Node of the quadtree. */
+      struct Node {
+        Node ();
+        float sum[4];   //!< Energy recorded in each quadrant.
+        int child[4];   //!< Child node of each quadrant, 0 for leaves.
+      };
+
+    public:
+
+      /*! Default construction of a single node. */
+      DTree () : nodes(1) {}
+
+      /*! Returns the energy recorded in the tree. */
+      __forceinline float total() const {
+        return nodes[0].sum[0]+nodes[0].sum[1]+nodes[0].sum[2]+nodes[0].sum[3];
+      }
+
+      /*! Samples a point in the unit square proportional to the recorded energy. */
+      Vec2f sample(Vec2f u, float& pdf) const;
+
+      /*! Returns the density of a point in the unit square. */
+      float pdf(Vec2f p) const;
+
+      /*! Records energy at a point of the unit square, can be called concurrently. */
+      void record(Vec2f p, const float value);
+
+      /*! Returns a tree with zero energy that subdivides each
+       *  quadrant holding more than the fraction threshold of the
+       *  recorded energy. */
+      DTree refined(const float threshold, const size_t maxDepth) const;
+
+    private:
+      std::vector<Node> nodes;
+    };
+
+    /*! Leaf of the spatial tree. */
+    struct Region {
+      Region () : numSamples(0) {}
+      DTree sampling;              //!< Distribution of the previous training round.
+      DTree building;              //!< Distribution recorded in the current training round.
+      volatile int32 numSamples;   //!< Number of samples recorded in the current training round.
+    };
+
+    /*! Node of the spatial tree, splits its box in the middle along
+     *  the axis of its depth modulo 3. */
+    struct Node {
+      Node (int region) : region(region) { child[0] = child[1] = 0; }
+      int child[2];                //!< Children of inner nodes.
+      int region;                  //!< Region of leaves, -1 for inner nodes.
+    };
+
+  public:
+
+    /*! Construction. \param spatialThreshold is the number of samples
+     *  of a spatial leaf that cause a split, \param rounds the number
+     *  of training rounds after which the guide is kept fixed. */
+    PathGuide (const float spatialThreshold, const size_t rounds);
+
+    /*! Returns true if a distribution got learned that can be sampled. */
+    __forceinline bool ready() const { return round > 0; }
+
+    /*! Returns true if the paths should record their incident radiance. */
+    __forceinline bool training() const { return round < rounds; }
+
+    /*! Returns the region containing the point P. */
+    size_t region(const Vector3f& P) const;
+
+    /*! Returns true if a distribution got learned in a region. */
+    __forceinline bool learned(const size_t region) const { return regions[region].sampling.total() > 0.0f; }
+
+    /*! Samples an incident direction in a region. Returns a zero pdf if nothing got learned there. */
+    Sample3f sample(const size_t region, const Vec2f& u) const;
+
+    /*! Returns the solid angle density of sampling direction wi in a region. */
+    float pdf(const size_t region, const Vector3f& wi) const;
+
+    /*! Records the radiance arriving at P from direction wi, divided
+     *  by the density that sampled wi. Can be called concurrently. */
+    void record(const size_t region, const Vector3f& P, const Vector3f& wi, const float value);
+
+    /*! Called after each render pass, ends a training round after 1, 2, 4, ... passes. */
+    void endPass();
+
+  private:
+
+    /*! Ends a training round. */
+    void update();
+
+    /*! Maps directions to the unit square and back. */
+    static __forceinline Vec2f dir2square(const Vector3f& wi) {
+      float phi = atan2f(wi.y,wi.x);
+      if (phi < 0.0f) phi += float(two_pi);
+      return Vec2f(clamp(0.5f*(wi.z+1.0f),0.0f,1.0f),clamp(phi*float(one_over_two_pi),0.0f,1.0f));
+    }
+    static __forceinline Vector3f square2dir(const Vec2f& p) {
+      const float cost = 2.0f*p.x-1.0f, sint = sqrtf(max(0.0f,1.0f-cost*cost));
+      const float phi = float(two_pi)*p.y;
+      return Vector3f(sint*cosf(phi),sint*sinf(phi),cost);
+    }
+
+  private:
+    float spatialThreshold;        //!< Number of samples of a spatial leaf that cause a split.
+    size_t rounds;                 //!< Number of training rounds.
+    size_t round;                  //!< Current training round.
+    size_t passes;                 //!< Number of passes of the current training round.
+    BBox3f bounds;                 //!< Box of the spatial tree.
+    BBox3f recordedBounds;         //!< Bounds of the recorded points, determines the box at the first update.
+    std::vector<Node> nodes;       //!< Nodes of the spatial tree, the first one is the root.
+    std::vector<Region> regions;   //!< Leaves of the spatial tree.
+  };
+}
+
+#endif
@@ -20,6 +20,16 @@
 
 namespace embree
 {
+  /*! Generates num additional samples from dimension dim on, SIMD_WIDTH at a time. */
+  static __forceinline void generateDimensions(float* samples, const size_t num, const uint32 key, const uint32 dim)
+  {
+    for (size_t i=0; i<num; i+=SIMD_WIDTH) {
+      const simdi h = randomHash(simdi(int32(key)) ^ (simdi(int32(dim+i)) + simdi(step)));
+      const simdf f = simdf(srl(h,8)) * simdf(1.0f/16777216.0f);
+      for (size_t j=0; j<min(size_t(SIMD_WIDTH),num-i); j++) samples[i+j] = f[j];
+    }
+  }
+
   SamplerFactory::SamplerFactory(const Parms& parms)
     : numSamples1D(0), numSamples2D(0), numLightSamples(0),
       samplesPerPixel(1), sampleSets(64), samples(NULL)
@@ -67,11 +77,8 @@ namespace embree
   {
     if (samples) {
       for (int set = 0; set < sampleSets; set++) {
-        for (int s = 0; s < samplesPerPixel; s++) {
-          delete[] samples[set][s].samples1D;
-          delete[] samples[set][s].samples2D;
+        for (int s = 0; s < samplesPerPixel; s++)
           delete[] samples[set][s].lightSamples;
-        }
         delete[] samples[set];
       }
       delete[] samples;
@@ -98,8 +105,6 @@ namespace embree
     Vec2f* pixel = new Vec2f[chunkSize];
     float* time = new float[chunkSize];
     Vec2f* lens = new Vec2f[chunkSize];
-    float* samples1D = new float[chunkSize];
-    Vec2f* samples2D = new Vec2f[chunkSize];
 
     for (int set = 0; set < sampleSets; set++)
     {
@@ -116,33 +121,20 @@ namespace embree
         if (filter) {
           samples[set][s].pixel = filter->sample(samples[set][s].pixel) + Vec2f(0.5f, 0.5f);
         }
-        samples[set][s].samples1D = new float[SamplerFactory::numSamples1D];
-        samples[set][s].samples2D = new Vec2f[SamplerFactory::numSamples2D];
+        samples[set][s].samples1D = NULL;
+        samples[set][s].samples2D = NULL;
         samples[set][s].lightSamples = new LightSample[SamplerFactory::numLightSamples];
       }
 
-      /*! Generate requested 1D samples. */
-      for (int d = 0; d < SamplerFactory::numSamples1D; d++) {
-        jittered(samples1D, chunkSize, rng);
-        for (int s = 0; s < samplesPerPixel; s++) {
-          samples[set][s].samples1D[d] = samples1D[offset + s];
-        }
-      }
-
-      /*! Generate 2D samples. */
-      for (int d = 0; d < SamplerFactory::numSamples2D; d++) {
-        multiJittered(samples2D, chunkSize, rng);
-        for (int s = 0; s < samplesPerPixel; s++) {
-          samples[set][s].samples2D[d] = samples2D[offset + s];
-        }
-      }
-
-      /*! Generate light samples. */
+      /*! Generate light samples. The additional samples of a set are
+       *  keyed like the pixels of row -1, which is never rendered. */
       for (int d = 0; d < SamplerFactory::numLightSamples; d++) {
         for (int s = 0; s < samplesPerPixel; s++) {
+          const uint32 key = sampleKey(Vec2i(set,-1),iteration*samplesPerPixel+s);
+          const uint32 dim = SAMPLE_DIM_2D+2*lightBaseSamples[d];
           LightSample ls;
           DifferentialGeometry dg;
-          ls.L = lights[d]->sample(dg, ls.wi, ls.tMax, samples[set][s].samples2D[lightBaseSamples[d]]);
+          ls.L = lights[d]->sample(dg, ls.wi, ls.tMax, Vec2f(sampleDimension(key,dim),sampleDimension(key,dim+1)));
           samples[set][s].lightSamples[d] = ls;
         }
       }
@@ -151,14 +143,26 @@ namespace embree
     delete[] pixel;
     delete[] time;
     delete[] lens;
-    delete[] samples1D;
-    delete[] samples2D;
   }
 
   Sampler* SamplerFactory::create() {
     return new Sampler(this);
   }
 
+  void SamplerFactory::generate(PrecomputedSample& sample, const uint32 key) const
+  {
+    generateDimensions(sample.samples1D, numSamples1D, key, 0);
+    generateDimensions((float*)sample.samples2D, 2*numSamples2D, key, SAMPLE_DIM_2D);
+  }
+
+  Sampler::Sampler(const Ref<SamplerFactory>& factory)
+    : factory(factory), samples1D(new float[factory->numSamples1D]), samples2D(new Vec2f[factory->numSamples2D]) {}
+
+  Sampler::~Sampler() {
+    delete[] samples1D;
+    delete[] samples2D;
+  }
+
   void Sampler::init(const Vec2i& imageSize, const Vec2i& tileBegin,
                      const Vec2i& tileEnd, int iteration)
   {
@@ -167,10 +171,9 @@ namespace embree
     this->tileEnd = tileEnd;
     this->iteration = iteration;
     done = false;
-    randomNumberGenerator.setSeed(tileBegin.x * 91711 + tileBegin.y * 81551);
     currentPixel = tileBegin;
     currentSample = 0;
-    currentSet = randomNumberGenerator.getInt(factory->sampleSets);
+    currentSet = randomHash(uint32(currentPixel.x),uint32(currentPixel.y),0u) % factory->sampleSets;
   }
 
   void Sampler::proceed(PrecomputedSample& sample)
@@ -180,11 +183,13 @@ namespace embree
     sample.raster.x = currentPixel.x + sample.pixel.x;
     sample.raster.y = currentPixel.y + sample.pixel.y;
     sample.imageSize = imageSize;
+    sample.samples1D = samples1D;
+    sample.samples2D = samples2D;
+    factory->generate(sample,sampleKey(currentPixel,iteration*factory->samplesPerPixel+currentSample));
 
     ++currentSample;
     if (currentSample == factory->samplesPerPixel) {
       currentSample = 0;
-      currentSet = randomNumberGenerator.getInt(factory->sampleSets);
       ++currentPixel.x;
       if (currentPixel.x > tileEnd.x) {
         currentPixel.x = tileBegin.x;
@@ -193,6 +198,7 @@ namespace embree
           done = true;
         }
       }
+      currentSet = randomHash(uint32(currentPixel.x),uint32(currentPixel.y),0u) % factory->sampleSets;
     }
   }
 }
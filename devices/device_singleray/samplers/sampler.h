@@ -34,6 +34,22 @@ namespace embree
     Color L;     //!< The importance weighted radiance for this sample.
   };
 
+  /*! The additional 1D and 2D samples of a pixel sample are counter
+   *  based random numbers, the hash of a key of the pixel sample and
+   *  the dimension. The components of the 2D samples use the
+   *  dimensions from SAMPLE_DIM_2D on. */
+  enum { SAMPLE_DIM_2D = 0x40000000 };
+
+  /*! Returns the key of the additional samples of the given sample of a pixel. */
+  __forceinline uint32 sampleKey(const Vec2i& pixel, const int sample) {
+    return randomHash(uint32(pixel.x),uint32(pixel.y),uint32(sample));
+  }
+
+  /*! Returns the additional sample of the given dimension. */
+  __forceinline float sampleDimension(const uint32 key, const uint32 dim) {
+    return randomFloat(randomHash(key ^ dim));
+  }
+
   /*! A complete high-dimensional sample, attached to one sample in the image plane. */
   struct PrecomputedSample 
   {
@@ -80,7 +96,10 @@ namespace embree
   {
   public:
     /*! Create a sampler using the specified sampler factory. */
-    Sampler(const Ref<SamplerFactory>& factory) : factory(factory) {}
+    Sampler(const Ref<SamplerFactory>& factory);
+
+    /*! Destructor */
+    ~Sampler();
 
     /*! Initialize the sampler for a given tile. */
     void init(const Vec2i& imageSize, const Vec2i& tileBegin,
@@ -107,12 +126,13 @@ namespace embree
     Vec2i tileEnd;   //!< Coordinates of last pixel in current tile.
     int iteration;   //!< Current iteration.
 
-    Random randomNumberGenerator; //!< Random number generated used by this sampler thread.
     Ref<SamplerFactory> factory;  //!< A reference to the sampler factory shared by all threads.
     bool done;                    //!< Has the tile been sampled completely?
     Vec2i currentPixel;           //!< Coordinates of the currently sampled pixel.
     int currentSample;            //!< Index of current sample in current pixel.
-    int currentSet;               //!< Index of the precomputed sample set that is used for current pixel.
+    int currentSet;               //!< Index of the precomputed sample set that is used for current pixel, a hash of the pixel.
+    float* samples1D;             //!< Additional 1D samples of the current sample.
+    Vec2f* samples2D;             //!< Additional 2D samples of the current sample.
   };
 
   /*! The sampler factory precomputes samples for usage by multiple samlper threads. */
@@ -148,6 +168,10 @@ namespace embree
     /*! Create a sampler thread using this factory. */
     Sampler* create();
 
+    /*! Generates the additional samples of a pixel sample with the
+     *  given key into the arrays the sample points to. */
+    void generate(PrecomputedSample& sample, const uint32 key) const;
+
   public:
     int numSamples1D;                  //!< Number of additional 1D samples per pixel sample.
     int numSamples2D;                  //!< Number of additional 2D samples per pixel sample.
@@ -157,7 +181,7 @@ namespace embree
 
     int samplesPerPixel;               //!< Number of samples per pixel.
     int sampleSets;                    //!< Number of precomputed sample sets.
-    PrecomputedSample** samples;       //!< All precomputed samples.
+    PrecomputedSample** samples;       //!< All precomputed samples, without the additional samples.
     int iteration;                     //!< Current iteration.
   };
 }
@@ -18,6 +18,7 @@
 #define __EMBREE_DIFFERENTIAL_GEOMETRY_H__
 
 #include "default.h" 
+#include "renderers/ray.h"
 
 namespace embree
 {
@@ -28,7 +29,33 @@ namespace embree
   {
     /*! Default construction. */
     __forceinline DifferentialGeometry()
-      : material(NULL), light(NULL) {}
+      : material(NULL), light(NULL), dPds(zero), dPdt(zero), dPdx(zero), dPdy(zero), dstdx(zero), dstdy(zero) {}
+
+    /*! Computes the derivatives of the hit location and surface
+     *  parameters with respect to the raster position. The offset rays
+     *  described by the differentials are intersected with the tangent
+     *  plane, and the resulting offsets are expressed in the basis
+     *  dPds, dPdt in the least squares sense. */
+    __forceinline void computeDifferentials(const Vector3f& org, const Vector3f& dir, const RayDifferentials& rd)
+    {
+      if (!rd.valid) return;
+      const float d = dot(Ng,P);
+      const Vector3f ox = org+rd.dOdx, dx = dir+rd.dDdx;
+      const Vector3f oy = org+rd.dOdy, dy = dir+rd.dDdy;
+      const float nx = dot(Ng,dx), ny = dot(Ng,dy);
+      if (nx == 0.0f || ny == 0.0f) return;
+      dPdx = ox + ((d-dot(Ng,ox))*rcp(nx))*dx - P;
+      dPdy = oy + ((d-dot(Ng,oy))*rcp(ny))*dy - P;
+
+      const float a = dot(dPds,dPds), b = dot(dPds,dPdt), c = dot(dPdt,dPdt);
+      const float det = a*c-b*b;
+      if (det <= 1E-20f*a*c) return;
+      const float rcpDet = rcp(det);
+      const float sx = dot(dPds,dPdx), tx = dot(dPdt,dPdx);
+      const float sy = dot(dPds,dPdy), ty = dot(dPdt,dPdy);
+      dstdx = Vec2f((c*sx-b*tx)*rcpDet,(a*tx-b*sx)*rcpDet);
+      dstdy = Vec2f((c*sy-b*ty)*rcpDet,(a*ty-b*sy)*rcpDet);
+    }
 
   public:
     class Material*  material; //!< pointer to material of hit shape instance
@@ -41,6 +68,12 @@ namespace embree
     Vector3f Ng;               //!< Normalized geometry normal.
     mutable Vector3f Ns;       //!< Normalized shading normal.
     Vec2f st;                  //!< Hit location in surface parameter space.
+    Vector3f dPds;             //!< Derivative of the hit location with respect to s.
+    Vector3f dPdt;             //!< Derivative of the hit location with respect to t.
+    Vector3f dPdx;             //!< Change of the hit location for a step of one pixel in x.
+    Vector3f dPdy;             //!< Change of the hit location for a step of one pixel in y.
+    Vec2f dstdx;               //!< Change of the surface parameters for a step of one pixel in x.
+    Vec2f dstdy;               //!< Change of the surface parameters for a step of one pixel in y.
     float error;               //!< Intersection error factor.
     light_mask_t illumMask;    //!< bit mask which light we're interested in
     light_mask_t shadowMask;   //!< bit mask which light we're interested in
@@ -107,6 +107,31 @@ namespace embree
     /*! Performs interpolation of shading vertex parameters. */
     virtual void postIntersect(const Ray& ray, DifferentialGeometry& dg) const = 0;
 
+    /*! Tests if the ray segment is blocked by the primitive with
+     *  index id1. Shapes without a cheap primitive test return false. */
+    virtual bool occluded(const Ray& ray, size_t id1) const { return false; }
+
+  protected:
+
+    /*! Moeller-Trumbore test of the ray segment against a triangle. */
+    static __forceinline bool occludedTriangle(const Ray& ray, const Vector3f& p0, const Vector3f& p1, const Vector3f& p2)
+    {
+      const Vector3f dir = ray.dir;
+      const Vector3f e1 = p1-p0, e2 = p2-p0;
+      const Vector3f pvec = cross(dir,e2);
+      const float det = dot(e1,pvec);
+      if (det == 0.0f) return false;
+      const float rcpDet = 1.0f/det;
+      const Vector3f tvec = Vector3f(ray.org)-p0;
+      const float u = dot(tvec,pvec)*rcpDet;
+      if (u < 0.0f || u > 1.0f) return false;
+      const Vector3f qvec = cross(tvec,e1);
+      const float v = dot(dir,qvec)*rcpDet;
+      if (v < 0.0f || u+v > 1.0f) return false;
+      const float t = dot(e2,qvec)*rcpDet;
+      return t > ray.tnear && t < ray.tfar;
+    }
+
   public:
     AccelType ty;
     //RTCGeometry* accel;            //!< acceleration structure for the shape
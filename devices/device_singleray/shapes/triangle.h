@@ -78,9 +78,16 @@ namespace embree
       dg.Ng = this->Ng;
       dg.Ns = this->Ng;
       dg.st = Vec2f(ray.u,ray.v);
+      dg.dPds = v1-v0;
+      dg.dPdt = v2-v0;
       dg.error = max(abs(ray.tfar),reduce_max(abs(dg.P)));
     }
 
+    /*! Tests if the ray segment is blocked by the triangle. */
+    bool occluded(const Ray& ray, size_t id1) const {
+      return occludedTriangle(ray,v0,v1,v2);
+    }
+
   public:
     Vector3f v0;   //!< 1st vertex of triangle.
     Vector3f v1;   //!< 2nd vertex of triangle.
@@ -33,8 +33,9 @@ namespace embree
       bool hasNormals   = parms.getData("normals");
       bool hasTangents  = parms.getData("tangent_x") | parms.getData("tangent_y");
       bool hasTexCoords = parms.getData("texcoords") | parms.getData("texcoords0");
+      bool compact      = parms.getInt("compact",0) != 0;
 
-      if (hasPositions && !hasMotions && hasNormals && !hasTangents && !hasTexCoords)
+      if (hasPositions && !hasMotions && hasNormals && !hasTangents && !hasTexCoords && !compact)
         return new TriangleMeshWithNormals(parms);
       else
         return new TriangleMeshFull(parms);
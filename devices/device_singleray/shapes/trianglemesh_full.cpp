@@ -18,8 +18,67 @@
 
 namespace embree
 {
+  /*! Encodes a direction into 2x16 bits by mapping the sphere to an octahedron unfolded into the unit square. */
+  static __forceinline uint32 encodeOctahedral(const Vector3f& d)
+  {
+    const float l1 = abs(d.x)+abs(d.y)+abs(d.z);
+    if (l1 == 0.0f) return 0x80008000;
+    float u = d.x/l1, v = d.y/l1;
+    if (d.z < 0.0f) {
+      const float u0 = u;
+      u = (1.0f-abs(v))*sign(u0);
+      v = (1.0f-abs(u0))*sign(v);
+    }
+    const uint32 qu = uint32(clamp(u*0.5f+0.5f,0.0f,1.0f)*65535.0f+0.5f);
+    const uint32 qv = uint32(clamp(v*0.5f+0.5f,0.0f,1.0f)*65535.0f+0.5f);
+    return qu | (qv << 16);
+  }
+
+  /*! Decodes an octahedral encoded direction. */
+  static __forceinline Vector3f decodeOctahedral(const uint32 e)
+  {
+    float u = float(e & 0xffff)*(2.0f/65535.0f)-1.0f;
+    float v = float(e >> 16   )*(2.0f/65535.0f)-1.0f;
+    const float z = 1.0f-abs(u)-abs(v);
+    if (z < 0.0f) {
+      const float u0 = u;
+      u = (1.0f-abs(v))*sign(u0);
+      v = (1.0f-abs(u0))*sign(v);
+    }
+    return normalize(Vector3f(u,v,z));
+  }
+
+  /*! Returns a direction from either the full or the octahedral encoded array. */
+  static __forceinline Vector3f getDirection(const vector_t<Vec3fa>& full, const vector_t<uint32>& encoded, size_t i) {
+    if (encoded.size()) return decodeOctahedral(encoded[i]);
+    return full[i];
+  }
+
+  /*! Returns a tangent from either the full or the octahedral encoded array with its length. */
+  static __forceinline Vector3f getTangent(const vector_t<Vec3fa>& full, const vector_t<uint32>& encoded, const vector_t<half>& lengths, size_t i) {
+    if (encoded.size()) return decodeOctahedral(encoded[i])*half_to_float(lengths[i]);
+    return full[i];
+  }
+
+  /*! Encodes tangents as octahedral directions and half precision
+   *  lengths. Keeps the full tangents if a length exceeds the half
+   *  range. */
+  static void compactTangents(vector_t<Vec3fa>& full, vector_t<uint32>& encoded, vector_t<half>& lengths)
+  {
+    for (size_t i=0; i<full.size(); i++)
+      if (!(length(Vector3f(full[i])) <= 65504.0f)) return;
+
+    encoded.resize(full.size());
+    lengths.resize(full.size());
+    for (size_t i=0; i<full.size(); i++) {
+      encoded[i] = encodeOctahedral(full[i]);
+      lengths[i] = float_to_half(length(Vector3f(full[i])));
+    }
+    full.clear();
+  }
+
   TriangleMeshFull::TriangleMeshFull (const Parms& parms)
-    : Shape(parms)
+    : Shape(parms), texcoordMin(zero), texcoordScale(zero)
   {
     if (Variant v = parms.getData("positions")) {
       if (!v.data || v.type != Variant::FLOAT3) throw std::runtime_error("wrong position format");
@@ -61,6 +120,52 @@ namespace embree
       triangles.resize(v.data->size());
       for (size_t i=0; i<v.data->size(); i++) triangles[i] = v.data->getVector3i(i);
     }
+    if (parms.getInt("compact",0)) compact();
+  }
+
+  void TriangleMeshFull::compact()
+  {
+    if (isCompact()) return;
+
+    normal16.resize(normal.size());
+    for (size_t i=0; i<normal.size(); i++) normal16[i] = encodeOctahedral(normal[i]);
+    normal.clear();
+
+    compactTangents(tangent_x,tangent_x16,tangent_x_length);
+    compactTangents(tangent_y,tangent_y16,tangent_y_length);
+
+    /*! quantize texture coordinates inside their bounds */
+    if (texcoord.size()) 
+    {
+      Vec2f lower(pos_inf), upper(neg_inf);
+      for (size_t i=0; i<texcoord.size(); i++) {
+        lower = min(lower,texcoord[i]);
+        upper = max(upper,texcoord[i]);
+      }
+      texcoordMin = lower;
+      texcoordScale = (upper-lower)*(1.0f/65535.0f);
+      const Vec2f scale(upper.x > lower.x ? 65535.0f/(upper.x-lower.x) : 0.0f,
+                        upper.y > lower.y ? 65535.0f/(upper.y-lower.y) : 0.0f);
+      texcoord16.resize(texcoord.size());
+      for (size_t i=0; i<texcoord.size(); i++) {
+        const uint32 s = uint32(clamp((texcoord[i].x-lower.x)*scale.x,0.0f,65535.0f)+0.5f);
+        const uint32 t = uint32(clamp((texcoord[i].y-lower.y)*scale.y,0.0f,65535.0f)+0.5f);
+        texcoord16[i] = s | (t << 16);
+      }
+      texcoord.clear();
+    }
+
+    /*! use 16 bit indices if all vertices are addressable */
+    if (triangles.size() && position.size() <= 0x10000) 
+    {
+      triangles16.resize(3*triangles.size());
+      for (size_t i=0; i<triangles.size(); i++) {
+        triangles16[3*i+0] = (uint16) triangles[i].v0;
+        triangles16[3*i+1] = (uint16) triangles[i].v1;
+        triangles16[3*i+2] = (uint16) triangles[i].v2;
+      }
+      triangles.clear();
+    }
   }
 
   Ref<Shape> TriangleMeshFull::transform(const AffineSpace3f& xfm) const
@@ -75,19 +180,22 @@ namespace embree
     for (size_t i=0; i<position.size(); i++) mesh->position[i] = xfmPoint(xfm,position[i]);
     mesh->motion.resize(motion.size());
     for (size_t i=0; i<motion.size(); i++) mesh->motion[i] = xfmVector(xfm,motion[i]);
-    mesh->normal.resize(normal.size()  );
-    for (size_t i=0; i<normal.size(); i++) mesh->normal[i] = xfmNormal(xfm,normal[i]);
-    mesh->tangent_x.resize(tangent_x.size()  );
-    for (size_t i=0; i<tangent_x.size(); i++) mesh->tangent_x[i] = xfmVector(xfm,tangent_x[i]);
-    mesh->tangent_y.resize(tangent_y.size()  );
-    for (size_t i=0; i<tangent_y.size(); i++) mesh->tangent_y[i] = xfmVector(xfm,tangent_y[i]);
-    mesh->texcoord  = texcoord;
-    mesh->triangles = triangles;
+    mesh->normal.resize(normal.size()+normal16.size());
+    for (size_t i=0; i<mesh->normal.size(); i++) mesh->normal[i] = xfmNormal(xfm,getDirection(normal,normal16,i));
+    mesh->tangent_x.resize(tangent_x.size()+tangent_x16.size());
+    for (size_t i=0; i<mesh->tangent_x.size(); i++) mesh->tangent_x[i] = xfmVector(xfm,getTangent(tangent_x,tangent_x16,tangent_x_length,i));
+    mesh->tangent_y.resize(tangent_y.size()+tangent_y16.size());
+    for (size_t i=0; i<mesh->tangent_y.size(); i++) mesh->tangent_y[i] = xfmVector(xfm,getTangent(tangent_y,tangent_y16,tangent_y_length,i));
+    mesh->texcoord.resize(texcoord.size()+texcoord16.size());
+    for (size_t i=0; i<mesh->texcoord.size(); i++) mesh->texcoord[i] = getTexCoord(i);
+    mesh->triangles.resize(numTriangles());
+    for (size_t i=0; i<mesh->triangles.size(); i++) mesh->triangles[i] = getTriangle(i);
+    if (isCompact()) mesh->compact();
     return mesh;
   }
 
   size_t TriangleMeshFull::numTriangles() const {
-    return triangles.size();
+    return triangles.size() + triangles16.size()/3;
   }
 
   size_t TriangleMeshFull::numVertices() const {
@@ -98,13 +206,13 @@ namespace embree
   {
     BBox3f bounds = empty;
     size_t numTimeSteps = motion.size() ? 2 : 1;
-    unsigned mesh = rtcNewTriangleMesh (scene, RTC_GEOMETRY_STATIC, triangles.size(), position.size(), numTimeSteps);
+    unsigned mesh = rtcNewTriangleMesh (scene, RTC_GEOMETRY_STATIC, numTriangles(), position.size(), numTimeSteps);
     //if (mesh != id) throw std::runtime_error("ID does not match");
 
     /* copy indices */
     RTCTriangle* triangles_o = (RTCTriangle*) rtcMapBuffer(scene,mesh,RTC_INDEX_BUFFER);
-    for (size_t j=0; j<triangles.size(); j++) {
-      const TriangleMeshFull::Triangle& tri = triangles[j];
+    for (size_t j=0; j<numTriangles(); j++) {
+      const TriangleMeshFull::Triangle tri = getTriangle(j);
       triangles_o[j].v0 = tri.v0;
       triangles_o[j].v1 = tri.v1;
       triangles_o[j].v2 = tri.v2;
@@ -145,9 +253,21 @@ namespace embree
     return mesh;
   }
 
+  bool TriangleMeshFull::occluded(const Ray& ray, size_t id1) const
+  {
+    const Triangle tri = getTriangle(id1);
+    Vector3f p0 = position[tri.v0], p1 = position[tri.v1], p2 = position[tri.v2];
+    if (unlikely(motion.size())) {
+      p0 += ray.time * motion[tri.v0];
+      p1 += ray.time * motion[tri.v1];
+      p2 += ray.time * motion[tri.v2];
+    }
+    return occludedTriangle(ray,p0,p1,p2);
+  }
+
   void TriangleMeshFull::postIntersect(const Ray& ray, DifferentialGeometry& dg) const
   {
-    const Triangle& tri = triangles[ray.id1];
+    const Triangle tri = getTriangle(ray.id1);
     Vector3f p0 = position[tri.v0], p1 = position[tri.v1], p2 = position[tri.v2];
     if (unlikely(motion.size())) {
       p0 += ray.time * motion[tri.v0];
@@ -163,10 +283,10 @@ namespace embree
     /* interpolate texture coordinates */
     float dsdu, dtdu;
     float dsdv, dtdv;
-    if (texcoord.size()) {
-      const Vec2f st0 = texcoord[tri.v0];
-      const Vec2f st1 = texcoord[tri.v1];
-      const Vec2f st2 = texcoord[tri.v2];
+    if (texcoord.size() || texcoord16.size()) {
+      const Vec2f st0 = getTexCoord(tri.v0);
+      const Vec2f st1 = getTexCoord(tri.v1);
+      const Vec2f st2 = getTexCoord(tri.v2);
       dg.st = st0*w + st1*u + st2*v;
       dsdu = st1.x-st0.x; dtdu = st1.y-st0.y;
       dsdv = st2.x-st0.x; dtdv = st2.y-st0.y;
@@ -177,10 +297,20 @@ namespace embree
       dsdv = 0; dtdv = 1;
     }
 
+    /* derivatives of the hit location with respect to the texture coordinates */
+    const float det = dsdu*dtdv - dsdv*dtdu;
+    if (det != 0.0f) {
+      const float rcpDet = rcp(det);
+      dg.dPds = (dPdu*dtdv - dPdv*dtdu)*rcpDet;
+      dg.dPdt = (dPdv*dsdu - dPdu*dsdv)*rcpDet;
+    }
+
     /* interpolate shading normal */
-    if (normal.size())
+    if (normal.size() || normal16.size())
     {
-      const Vector3f n0 = normal[tri.v0], n1 = normal[tri.v1], n2 = normal[tri.v2];
+      const Vector3f n0 = getDirection(normal,normal16,tri.v0);
+      const Vector3f n1 = getDirection(normal,normal16,tri.v1);
+      const Vector3f n2 = getDirection(normal,normal16,tri.v2);
       Vector3f Ns = w*n0 + u*n1 + v*n2;
       float len2 = dot(Ns,Ns);
       Ns = len2 > 0 ? Ns*rsqrt(len2) : Vector3f(dg.Ng);
@@ -191,8 +321,10 @@ namespace embree
       dg.Ns = dg.Ng;
 
     /* interpolate x tangent direction */
-    if (tangent_x.size()) { 
-      const Vector3f t0 = tangent_x[tri.v0], t1 = tangent_x[tri.v1], t2 = tangent_x[tri.v2];
+    if (tangent_x.size() || tangent_x16.size()) { 
+      const Vector3f t0 = getTangent(tangent_x,tangent_x16,tangent_x_length,tri.v0);
+      const Vector3f t1 = getTangent(tangent_x,tangent_x16,tangent_x_length,tri.v1);
+      const Vector3f t2 = getTangent(tangent_x,tangent_x16,tangent_x_length,tri.v2);
       dg.Tx = w*t0 + u*t1 + v*t2;
     }
     else {
@@ -201,8 +333,10 @@ namespace embree
     }
 
     /* interpolate y tangent direction */
-    if (tangent_y.size()) {
-      const Vector3f t0 = tangent_y[tri.v0], t1 = tangent_y[tri.v1], t2 = tangent_y[tri.v2];
+    if (tangent_y.size() || tangent_y16.size()) {
+      const Vector3f t0 = getTangent(tangent_y,tangent_y16,tangent_y_length,tri.v0);
+      const Vector3f t1 = getTangent(tangent_y,tangent_y16,tangent_y_length,tri.v1);
+      const Vector3f t2 = getTangent(tangent_y,tangent_y16,tangent_y_length,tri.v2);
       dg.Ty = w*t0 + u*t1 + v*t2;
     } else {
       const Vector3f dPdt = normalize(dPdv*dsdu - dPdu*dsdv);
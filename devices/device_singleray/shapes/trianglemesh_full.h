@@ -18,11 +18,14 @@
 #define __EMBREE_TRIANGLE_MESH_FULL_H__
 
 #include "../shapes/shape.h"
+#include "math/half.h"
 
 namespace embree
 {
   /*! Implements a triangle mesh. The mesh supports optional
-   *  vertex normals and texture coordinates. */
+   *  vertex normals and texture coordinates. The shading attributes
+   *  and indices can optionally be stored in a compact representation
+   *  that is decoded on the fly. */
   class TriangleMeshFull : public Shape
   {
   public:
@@ -41,7 +44,7 @@ namespace embree
 
     /*! Construction from acceleration structure type. */
     TriangleMeshFull (const AccelType& ty)
-      : Shape(ty) {}
+      : Shape(ty), texcoordMin(zero), texcoordScale(zero) {}
 
     /*! Construction from parameter container. */
     TriangleMeshFull (const Parms& parms);
@@ -52,6 +55,35 @@ namespace embree
     size_t numVertices () const;
     int extract(RTCScene scene, size_t id) const;
     void postIntersect(const Ray& ray, DifferentialGeometry& dg) const;
+    bool occluded(const Ray& ray, size_t id1) const;
+
+    /*! Converts normals and tangents to 16 bit octahedral
+     *  encodings, texture coordinates to 16 bit per component, and
+     *  indices to 16 bit if all vertices are addressable. The
+     *  lengths of the tangents are kept as half precision floats. */
+    void compact();
+
+    /*! Returns true if the compact representation is used. */
+    __forceinline bool isCompact() const { 
+      return normal16.size() || tangent_x16.size() || tangent_y16.size() || texcoord16.size() || triangles16.size();
+    }
+
+  private:
+
+    /*! Returns the vertex indices of a triangle. */
+    __forceinline Triangle getTriangle(size_t i) const {
+      if (triangles16.size()) return Triangle(triangles16[3*i+0],triangles16[3*i+1],triangles16[3*i+2]);
+      return triangles[i];
+    }
+
+    /*! Returns the texture coordinates of a vertex. */
+    __forceinline Vec2f getTexCoord(size_t i) const {
+      if (texcoord16.size()) {
+        const uint32 st = texcoord16[i];
+        return Vec2f(texcoordMin.x+float(st & 0xffff)*texcoordScale.x,texcoordMin.y+float(st >> 16)*texcoordScale.y);
+      }
+      return texcoord[i];
+    }
 
   public:
     vector_t<Vec3fa> position;      //!< Position array.
@@ -61,6 +93,17 @@ namespace embree
     vector_t<Vec3fa> tangent_y;     //!< Tangent array for y-direction (can be empty).
     vector_t<Vec2f> texcoord;      //!< Texture coordinates array (can be empty).
     vector_t<Triangle> triangles;  //!< Triangle indices array.
+
+  public:
+    vector_t<uint32> normal16;      //!< Octahedral encoded normals of compact representation (can be empty).
+    vector_t<uint32> tangent_x16;   //!< Octahedral encoded x-tangents of compact representation (can be empty).
+    vector_t<uint32> tangent_y16;   //!< Octahedral encoded y-tangents of compact representation (can be empty).
+    vector_t<half> tangent_x_length;//!< Lengths of the encoded x-tangents.
+    vector_t<half> tangent_y_length;//!< Lengths of the encoded y-tangents.
+    vector_t<uint32> texcoord16;    //!< Quantized texture coordinates of compact representation (can be empty).
+    vector_t<uint16> triangles16;   //!< 16 bit triangle indices of compact representation (can be empty).
+    Vec2f texcoordMin;              //!< Smallest texture coordinate of the mesh.
+    Vec2f texcoordScale;            //!< Texture coordinate step of one quantization level.
   };
 }
 
@@ -88,6 +88,12 @@ namespace embree
     return mesh;
   }
 
+  bool TriangleMeshWithNormals::occluded(const Ray& ray, size_t id1) const
+  {
+    const Triangle& tri = triangles[id1];
+    return occludedTriangle(ray,vertices[tri.v0].p,vertices[tri.v1].p,vertices[tri.v2].p);
+  }
+
   void TriangleMeshWithNormals::postIntersect(const Ray& ray, DifferentialGeometry& dg) const
   {
     const Triangle& tri = triangles[ray.id1];
@@ -99,6 +105,8 @@ namespace embree
     dg.P = ray.org+t*ray.dir;
     dg.Ng = normalize(ray.Ng);
     dg.st = Vec2f(u,v);
+    dg.dPds = dPdu;
+    dg.dPdt = dPdv;
     Vector3f Ns = w*v0.n + u*v1.n + v*v2.n;
     float len2 = dot(Ns,Ns);
     Ns = len2 > 0 ? Ns*rsqrt(len2) : Vector3f(dg.Ng);
@@ -57,6 +57,7 @@ namespace embree
     size_t numVertices () const;
     int extract(RTCScene scene, size_t id) const;
     void postIntersect(const Ray& ray, DifferentialGeometry& dg) const;
+    bool occluded(const Ray& ray, size_t id1) const;
 
   public:
     vector_t<Vertex> vertices;     //!< Vertex array (positions and normals).
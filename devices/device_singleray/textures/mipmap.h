@@ -0,0 +1,129 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#ifndef __EMBREE_MIPMAP_H__
+#define __EMBREE_MIPMAP_H__
+
+#include "image/image.h"
+#include "image/tiled.h"
+#include "image/compressed.h"
+#include "../textures/texture.h"
+
+namespace embree
+{
+  /*! Implements an image mapped texture with a mip pyramid. The
+   *  pyramid is built by 2x2 box filtering when the texture is
+   *  created. Lookups with a footprint blend bilinear samples of the
+   *  two closest levels, lookups without footprint are bilinear in
+   *  the full resolution image. */
+  class MipMap : public Texture
+  {
+  public:
+
+    /*! Construction from image. */
+    MipMap (const Ref<Image>& image) {
+      build(image);
+    }
+
+    /*! Construction from parameters. */
+    MipMap (const Parms& parms) {
+      build(parms.getImage("image"));
+    }
+
+    Color4 get(const Vec2f& p) const {
+      return bilinear(levels[0],p);
+    }
+
+    Color4 get(const Vec2f& p, const Vec2f& dpdx, const Vec2f& dpdy) const
+    {
+      /*! width of the footprint in texels of the finest level */
+      const float w = float(levels[0]->width), h = float(levels[0]->height);
+      const float fx = length(Vec2f(dpdx.x*w,dpdx.y*h));
+      const float fy = length(Vec2f(dpdy.x*w,dpdy.y*h));
+      const float width = max(fx,fy);
+      if (!(width > 1.0f)) return bilinear(levels[0],p);
+
+      const float l = min(log(width)*1.442695041f,float(levels.size()-1));
+      const size_t l0 = min(size_t(l),levels.size()-1);
+      if (l0+1 >= levels.size()) return bilinear(levels[l0],p);
+      const float f = l-float(l0);
+      const Color4 c0 = bilinear(levels[l0],p), c1 = bilinear(levels[l0+1],p);
+      return Color4((1.0f-f)*c0.r+f*c1.r,(1.0f-f)*c0.g+f*c1.g,(1.0f-f)*c0.b+f*c1.b,(1.0f-f)*c0.a+f*c1.a);
+    }
+
+  private:
+
+    /*! Builds the pyramid down to a single texel. Levels of 8 bit
+     *  images are stored with 8 bits per channel, all others as float.
+     *  Levels of compressed images are compressed again, and tiled
+     *  images already store their pyramid on disk. */
+    void build(const Ref<Image>& image)
+    {
+      if (TiledImage* tiled = dynamic_cast<TiledImage*>(image.ptr)) {
+        levels.push_back(image);
+        for (size_t i=1; i<tiled->numLevels(); i++) levels.push_back(tiled->getLevel(i));
+        return;
+      }
+
+      const bool compressed = dynamic_cast<ImageBC1*>(image.ptr) || dynamic_cast<ImageBC3*>(image.ptr) || dynamic_cast<ImageBCH*>(image.ptr);
+      const bool ldr = dynamic_cast<Image3c*>(image.ptr) || dynamic_cast<Image4c*>(image.ptr)
+        || dynamic_cast<ImageBC1*>(image.ptr) || dynamic_cast<ImageBC3*>(image.ptr);
+      levels.push_back(image);
+      while (levels.back()->width > 1 || levels.back()->height > 1)
+      {
+        const Ref<Image> src = levels.back();
+        const size_t width = max(size_t(1),src->width/2), height = max(size_t(1),src->height/2);
+        Ref<Image> dst = ldr ? (Image*) new Image4c(width,height,src->name) : (Image*) new Image4f(width,height,src->name);
+        for (size_t y=0; y<height; y++) {
+          const size_t y0 = min(2*y,src->height-1), y1 = min(2*y+1,src->height-1);
+          for (size_t x=0; x<width; x++) {
+            const size_t x0 = min(2*x,src->width-1), x1 = min(2*x+1,src->width-1);
+            const Color4 c00 = src->get(x0,y0), c01 = src->get(x1,y0);
+            const Color4 c10 = src->get(x0,y1), c11 = src->get(x1,y1);
+            dst->set(x,y,Color4(0.25f*(c00.r+c01.r+c10.r+c11.r),0.25f*(c00.g+c01.g+c10.g+c11.g),
+                                0.25f*(c00.b+c01.b+c10.b+c11.b),0.25f*(c00.a+c01.a+c10.a+c11.a)));
+          }
+        }
+        levels.push_back(compressed ? compressImage(dst) : dst);
+      }
+    }
+
+    /*! Bilinear lookup with wrap around addressing. */
+    static Color4 bilinear(const Ref<Image>& image, const Vec2f& p)
+    {
+      const float s = (p.x-floor(p.x))*float(image->width)-0.5f;
+      const float t = (p.y-floor(p.y))*float(image->height)-0.5f;
+      const float fs = floor(s), ft = floor(t);
+      const float u = s-fs, v = t-ft;
+      const int w = int(image->width), h = int(image->height);
+      const int x0 = (int(fs)+w)%w, x1 = (x0+1)%w;
+      const int y0 = (int(ft)+h)%h, y1 = (y0+1)%h;
+      const Color4 c00 = image->get(x0,y0), c01 = image->get(x1,y0);
+      const Color4 c10 = image->get(x0,y1), c11 = image->get(x1,y1);
+      const float w00 = (1.0f-u)*(1.0f-v), w01 = u*(1.0f-v), w10 = (1.0f-u)*v, w11 = u*v;
+      return Color4(w00*c00.r+w01*c01.r+w10*c10.r+w11*c11.r,
+                    w00*c00.g+w01*c01.g+w10*c10.g+w11*c11.g,
+                    w00*c00.b+w01*c01.b+w10*c10.b+w11*c11.b,
+                    w00*c00.a+w01*c01.a+w10*c10.a+w11*c11.a);
+    }
+
+  protected:
+    std::vector<Ref<Image> > levels; //!< Mip levels, the first one is the image mapped to the surface.
+  };
+}
+
+#endif
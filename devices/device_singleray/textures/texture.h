@@ -33,6 +33,11 @@ namespace embree
     /*! Returns the color for a surface point p. \param p is the
      *  location to query the color for. The range is 0 to 1. */
     virtual Color4 get(const Vec2f& p) const = 0;
+
+    /*! Returns the color for a surface point p filtered over the
+     *  footprint spanned by the derivatives dpdx and dpdy. Textures
+     *  without filtering ignore the footprint. */
+    virtual Color4 get(const Vec2f& p, const Vec2f& dpdx, const Vec2f& dpdy) const { return get(p); }
   };
 }
 
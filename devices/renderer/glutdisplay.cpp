@@ -16,6 +16,7 @@
 
 #include "sys/platform.h"
 #include "sys/stl/string.h"
+#include "math/half.h"
 #include "glutdisplay.h"
 #include "regression.h"
 
@@ -55,6 +56,7 @@ namespace embree
   
   /* output settings */
   extern int g_refine;  
+  extern bool g_reproject;
   extern bool g_fullscreen;
   extern bool g_hdrDisplay;
   extern size_t g_width, g_height;
@@ -72,6 +74,7 @@ namespace embree
   
   /* other stuff */
   bool g_resetAccumulation = false;
+  bool g_cameraMoved = false;
 
   /* pause mode */
   bool g_pause = false;
@@ -139,6 +142,8 @@ namespace embree
       case GLUT_KEY_PAGE_UP   : g_speed *= 1.2f; std::cout << "speed = " << g_speed << std::endl; break;
       case GLUT_KEY_PAGE_DOWN : g_speed /= 1.2f; std::cout << "speed = " << g_speed << std::endl; break;
       }
+      g_cameraMoved = true;
+      return;
     }
     g_resetAccumulation = true;
   }
@@ -165,7 +170,7 @@ namespace embree
           g_camLookAt = p;
           g_camPos += offset;
           g_camSpace = AffineSpace3f::lookAtPoint(g_camPos, g_camLookAt, g_camUp);
-          g_resetAccumulation = true;
+          g_cameraMoved = true;
         }
       }
       else if (button == GLUT_LEFT_BUTTON && glutGetModifiers() == (GLUT_ACTIVE_CTRL | GLUT_ACTIVE_SHIFT)) {
@@ -177,7 +182,7 @@ namespace embree
           Vector3f d = p - g_camPos;
           g_camLookAt = g_camPos + v*dot(d,v);
           g_camSpace = AffineSpace3f::lookAtPoint(g_camPos, g_camLookAt, g_camUp);
-          g_resetAccumulation = true;
+          g_cameraMoved = true;
         }
       }
     }
@@ -276,7 +281,7 @@ namespace embree
     }
 
     g_camSpace = AffineSpace3f::lookAtPoint(g_camPos, g_camLookAt, g_camUp);
-    g_resetAccumulation = true;
+    g_cameraMoved = true;
 
   }
 
@@ -299,9 +304,11 @@ namespace embree
     if (g_regression)
       g_render_scene = createRandomScene(g_device,1,random<int>()%100,random<int>()%1000);
 
-    /* set accumulation mode */
+    /* set accumulation mode, camera movements reproject the refined image if enabled */
     int accumulate = g_resetAccumulation ? 0 : g_refine;
+    if (g_cameraMoved && !g_resetAccumulation) accumulate = (g_refine && g_reproject) ? 2 : 0;
     g_resetAccumulation = false;
+    g_cameraMoved = false;
 
     /* render image */
     AffineSpace3f camSpace = g_camSpace;
@@ -330,6 +337,11 @@ namespace embree
       glDrawPixels((GLsizei)g_width,(GLsizei)g_height,GL_RGBA,GL_UNSIGNED_BYTE,ptr);
     else if (g_format == "RGB8")
       glDrawPixels((GLsizei)g_width,(GLsizei)g_height,GL_RGB,GL_UNSIGNED_BYTE,ptr);
+    else if (g_format == "RGBA_FLOAT16") {
+      static std::vector<float> pixels; pixels.resize(4*g_width*g_height);
+      for (size_t i=0; i<g_width*g_height; i++) half4_to_float4((half*)ptr+4*i,&pixels[4*i]);
+      glDrawPixels((GLsizei)g_width,(GLsizei)g_height,GL_RGBA,GL_FLOAT,&pixels[0]);
+    }
     else 
     throw std::runtime_error("unknown framebuffer format: "+g_format);
                                                     
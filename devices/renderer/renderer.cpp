@@ -16,6 +16,7 @@
 
 #include "sys/platform.h"
 #include "sys/filename.h"
+#include "math/half.h"
 #include "image/image.h"
 #include "lexers/streamfilters.h"
 #include "lexers/parsestream.h"
@@ -54,8 +55,10 @@ namespace embree
 
   /* output settings */
   int g_numBuffers = 2;                   //!< number of buffers of the framebuffer
+  bool g_aovs = false;                    //!< store auxiliary channels next to the output image
   bool g_rendered = false;                //!< set to true after rendering
   int g_refine = 1;                       //!< refinement mode
+  bool g_reproject = false;               //!< reproject accumulated image when the camera moves
   float g_gamma = 1.0f;
   bool g_vignetting = false;
   bool g_fullscreen = false;
@@ -111,7 +114,8 @@ namespace embree
     g_device->rtSetString(scene,"accel",g_accel.c_str());
     g_device->rtSetString(scene,"builder",g_builder.c_str());
     g_device->rtSetString(scene,"traverser",g_traverser.c_str());
-    for (size_t i=0; i<g_prims.size(); i++) g_device->rtSetPrimitive(scene,i,g_prims[i]);
+    std::vector<Device::RTPrimitive> prims(g_prims.begin(),g_prims.end());
+    if (prims.size()) g_device->rtSetPrimitives(scene,0,prims.size(),&prims[0]);
     g_device->rtCommit(scene);
     return scene;
   }
@@ -195,6 +199,31 @@ namespace embree
       else if (tag == "minContribution") g_device->rtSetFloat1(g_renderer, "minContribution", cin->getFloat());
       else if (tag == "backplate"      ) g_device->rtSetImage (g_renderer, "backplate", rtLoadImage(path + cin->getFileName()));
       else if (tag == "sampleLightForGlossy") g_device->rtSetInt1  (g_renderer, "sampleLightForGlossy"    , cin->getInt()  );
+      else if (tag == "mis"            ) g_device->rtSetInt1  (g_renderer, "mis"            , cin->getInt()  );
+      else if (tag == "denoise"        ) g_device->rtSetInt1  (g_renderer, "denoise"        , cin->getInt()  );
+      else if (tag == "aovs"           ) g_device->rtSetInt1  (g_renderer, "aovs"           , g_aovs = cin->getInt() != 0);
+      else if (tag == "timeBudget"     ) g_device->rtSetFloat1(g_renderer, "timeBudget"     , cin->getFloat());
+      else if (tag == "subsample"      ) g_device->rtSetInt1  (g_renderer, "subsample"      , cin->getInt()  );
+      else if (tag == "textureCache"   ) g_device->rtSetInt1  (g_renderer, "textureCache"   , cin->getInt()  );
+      else if (tag == "compactAccu"    ) g_device->rtSetInt1  (g_renderer, "compactAccu"    , cin->getInt()  );
+      else if (tag == "regenerate"     ) g_device->rtSetInt1  (g_renderer, "regenerate"     , cin->getInt()  );
+      else if (tag == "samples"        ) g_device->rtSetInt1  (g_renderer, "sampler.samples", cin->getInt()  );
+      else if (tag == "sets"           ) g_device->rtSetInt1  (g_renderer, "sampler.sets"   , cin->getInt()  );
+      else if (tag == "guiding"        ) g_device->rtSetInt1  (g_renderer, "guiding"        , cin->getInt()  );
+      else if (tag == "guiding.fraction") g_device->rtSetFloat1(g_renderer, "guiding.fraction", cin->getFloat());
+      else if (tag == "guiding.rounds" ) g_device->rtSetInt1  (g_renderer, "guiding.rounds" , cin->getInt()  );
+      else if (tag == "guiding.spatialThreshold") g_device->rtSetFloat1(g_renderer, "guiding.spatialThreshold", cin->getFloat());
+      else if (tag == "cache"          ) g_device->rtSetInt1  (g_renderer, "cache"          , cin->getInt()  );
+      else if (tag == "cache.depth"    ) g_device->rtSetInt1  (g_renderer, "cache.depth"    , cin->getInt()  );
+      else if (tag == "cache.minSamples") g_device->rtSetInt1 (g_renderer, "cache.minSamples", cin->getInt()  );
+      else if (tag == "cache.update"   ) g_device->rtSetFloat1(g_renderer, "cache.update"   , cin->getFloat());
+      else if (tag == "cache.scale"    ) g_device->rtSetFloat1(g_renderer, "cache.scale"    , cin->getFloat());
+      else if (tag == "cache.size"     ) g_device->rtSetInt1  (g_renderer, "cache.size"     , cin->getInt()  );
+      else if (tag == "occluderCache"  ) g_device->rtSetInt1  (g_renderer, "occluderCache"  , cin->getInt()  );
+      else if (tag == "roulette.depth" ) g_device->rtSetInt1  (g_renderer, "roulette.depth" , cin->getInt()  );
+      else if (tag == "pathStatistics" ) g_device->rtSetInt1  (g_renderer, "pathStatistics" , cin->getInt()  );
+      else if (tag == "crop.min"       ) { const Vec2f v = cin->getVec2f(); g_device->rtSetFloat2(g_renderer, "crop.min", v.x, v.y); }
+      else if (tag == "crop.max"       ) { const Vec2f v = cin->getVec2f(); g_device->rtSetFloat2(g_renderer, "crop.max", v.x, v.y); }
       else std::cout << "unknown tag \"" << tag << "\" in pathtracer parsing" << std::endl;
     }
     cin->drop();
@@ -234,9 +263,24 @@ namespace embree
     else if (g_format == "RGBA8"       )  image = new Image4c(g_width, g_height, (Col4c*)ptr);
     else if (g_format == "RGB_FLOAT32" )  image = new Image3f(g_width, g_height, (Col3f*)ptr); 
     else if (g_format == "RGBA_FLOAT32")  image = new Image4f(g_width, g_height, (Col4f*)ptr);
+    else if (g_format == "RGBA_FLOAT16") {
+      Image4f* img = new Image4f(g_width, g_height);
+      for (size_t i=0; i<g_width*g_height; i++) half4_to_float4((half*)ptr+4*i, (float*)img->ptr()+4*i);
+      image = img;
+    }
     else throw std::runtime_error("unsupported framebuffer format: "+g_format);
     storeImage(image, fileName);
     g_device->rtUnmapFrameBuffer(g_frameBuffer);
+
+    /* store auxiliary channels next to the image */
+    if (g_aovs) {
+      const char* channels[] = { "albedo", "normal", "direct", "indirect" };
+      for (size_t i=0; i<sizeof(channels)/sizeof(channels[0]); i++) {
+        void* ptr = g_device->rtMapFrameBuffer(g_frameBuffer, -1, channels[i]);
+        storeImage(new Image3f(g_width, g_height, (Col3f*)ptr), fileName.dropExt().str() + "." + channels[i] + "." + fileName.ext());
+        g_device->rtUnmapFrameBuffer(g_frameBuffer);
+      }
+    }
     g_rendered = true;
   }
 
@@ -285,7 +329,7 @@ namespace embree
     if (tag == "-connect") {
       cin->getString();
       clearGlobalObjects();
-      if (g_format != "RGBA8") g_format = "RGB8";
+      if (g_format != "RGBA8" && g_format != "RGBA_FLOAT16") g_format = "RGB8";
       g_numBuffers = 2;
       std::string type = "network "+parseList(cin);
       g_device = Device::rtCreateDevice(type.c_str(),g_numThreads,g_rtcore_cfg.c_str());
@@ -510,9 +554,21 @@ namespace embree
       /* refine rendering when not moving */
       else if (tag == "-refine") g_refine = cin->getInt();
 
+      /* reproject refined image when the camera moves */
+      else if (tag == "-reproject") g_reproject = true;
+
       /* scene type to use */
       else if (tag == "-scene") g_scene = cin->getString();
       
+      /* block compress textures of scenes loaded afterwards */
+      else if (tag == "-compresstextures") g_compress_textures = true;
+
+      /* store meshes loaded afterwards in compact form */
+      else if (tag == "-compactmeshes") g_compact_meshes = true;
+
+      /* reorder meshes loaded afterwards for memory locality */
+      else if (tag == "-optimizemeshes") g_optimize_meshes = true;
+
       /* acceleration structure to use */
       else if (tag == "-accel") {
         g_accel = g_mesh_accel = cin->getString();
@@ -689,6 +745,21 @@ namespace embree
         std::cout << "-[no]refine" << std::endl;
         std::cout << "  Enables (default) or disables the refinement display mode." << std::endl;
         std::cout << std::endl;
+        std::cout << "-reproject" << std::endl;
+        std::cout << "  Reuses the refined image after camera movements in the refinement display mode." << std::endl;
+        std::cout << std::endl;
+        std::cout << "-compresstextures" << std::endl;
+        std::cout << "  Stores textures of scenes loaded afterwards as BC1/BC3 (8 bit) or " << std::endl;
+        std::cout << "  BCH (float) compressed 4x4 blocks." << std::endl;
+        std::cout << std::endl;
+        std::cout << "-compactmeshes" << std::endl;
+        std::cout << "  Stores normals, tangents, and texture coordinates of meshes loaded " << std::endl;
+        std::cout << "  afterwards with 16 bits per component and uses 16 bit indices if possible." << std::endl;
+        std::cout << std::endl;
+        std::cout << "-optimizemeshes" << std::endl;
+        std::cout << "  Merges duplicate vertices of meshes loaded afterwards and reorders " << std::endl;
+        std::cout << "  triangles and vertices along a space filling curve." << std::endl;
+        std::cout << std::endl;
         std::cout << "-regression" << std::endl;
         std::cout << "  Runs a stress test of the system." << std::endl;
         std::cout << std::endl;
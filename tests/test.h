@@ -0,0 +1,45 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#ifndef __EMBREE_TEST_H__
+#define __EMBREE_TEST_H__
+
+#include <cstdio>
+
+namespace embree
+{
+  /*! Number of failed checks of the test program. */
+  static size_t numErrors = 0;
+
+  /*! Reports a failed check. */
+  static inline void check(bool ok, const char* what) {
+    if (ok) return;
+    printf("FAILED: %s\n",what);
+    numErrors++;
+  }
+
+  /*! Prints the summary of the test program and returns its exit code. */
+  static inline int testResult() {
+    if (numErrors) {
+      printf("%d checks failed\n",int(numErrors));
+      return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+  }
+}
+
+#endif
@@ -0,0 +1,63 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "test.h"
+#include "api/framebuffer.h"
+#include "math/random.h"
+
+#include <cmath>
+
+namespace embree
+{
+  static void testCompactAccumulation()
+  {
+    /*! accumulate the same samples in both representations, the
+     *  compact buffer gets expanded when saturated like in the renderer */
+    Ref<AccuBuffer> full = new AccuBuffer(4,1,false);
+    Ref<AccuBuffer> compact = new AccuBuffer(4,1,true);
+    Random rng(29);
+    bool saturatedAtLimit = true;
+    const size_t n = 4096;
+    for (size_t i=0; i<n; i++)
+    {
+      for (size_t x=0; x<4; x++) {
+        const Color c(rng.getFloat(),0.01f*rng.getFloat(),float(x));
+        full->update(x,0,c,1.0f,i > 0);
+        compact->update(x,0,c,1.0f,i > 0);
+      }
+      if (compact->isCompact()) saturatedAtLimit &= compact->isSaturated() == (i+1 >= AccuBuffer::MAX_COMPACT_WEIGHT);
+      if (compact->isSaturated()) compact = compact->expand();
+    }
+    check(saturatedAtLimit,"compact accumulation saturates at MAX_COMPACT_WEIGHT samples");
+    check(!compact->isCompact() && compact->isExpanded(),"saturated compact accumulation gets expanded");
+
+    /*! the expanded buffer keeps the exact weight and converges like the full one */
+    bool converges = true;
+    for (size_t x=0; x<4; x++) {
+      const Vec4f a = full->getSum(x,0), b = compact->getSum(x,0);
+      converges &= a.w == float(n) && b.w == float(n);
+      converges &= std::abs(a.x-b.x) <= 1E-3f*a.x && std::abs(a.y-b.y) <= 1E-3f*a.y && std::abs(a.z-b.z) <= 1E-3f*max(a.z,1.0f);
+      converges &= std::abs(b.x/b.w-0.5f) < 0.02f && std::abs(b.y/b.w-0.005f) < 0.0002f;
+    }
+    check(converges,"expanded compact accumulation converges");
+  }
+}
+
+int main(int argc, char** argv)
+{
+  embree::testCompactAccumulation();
+  return embree::testResult();
+}
@@ -0,0 +1,157 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "test.h"
+#include "samplers/aliastable2d.h"
+#include "lights/hdrilight.h"
+#include "math/random.h"
+
+#include <cmath>
+#include <vector>
+
+namespace embree
+{
+  static void testAliasTable()
+  {
+    /*! random function with an empty row and an empty column */
+    const size_t width = 37, height = 23;
+    std::vector<float> data(width*height);
+    std::vector<const float*> rows(height);
+    Random rng(13);
+    double sum = 0.0;
+    for (size_t y=0; y<height; y++) {
+      rows[y] = &data[y*width];
+      for (size_t x=0; x<width; x++) {
+        data[y*width+x] = (y == 5 || x == 7) ? 0.0f : rng.getFloat()*rng.getFloat();
+        sum += data[y*width+x];
+      }
+    }
+    Ref<AliasTable2D> table = new AliasTable2D(&rows[0],width,height);
+
+    /*! the density is proportional to the function and integrates to one */
+    double integral = 0.0; bool proportional = true;
+    for (size_t y=0; y<height; y++) {
+      for (size_t x=0; x<width; x++) {
+        const double expected = data[y*width+x]/sum*double(width*height);
+        proportional &= std::abs(table->pdf(x,y)-expected) <= 1E-4*max(expected,1.0);
+        integral += table->pdf(x,y);
+      }
+    }
+    check(proportional,"alias table density is proportional to the function");
+    check(std::abs(integral/double(width*height)-1.0) < 1E-5,"alias table density integrates to one");
+
+    /*! stratified samples hit each element with its probability and report the matching density */
+    const size_t n = 1024;
+    std::vector<size_t> counts(width*height,0);
+    bool pdfs = true, inside = true;
+    for (size_t j=0; j<n; j++) {
+      for (size_t i=0; i<n; i++) {
+        const Sample2f s = table->sample(Vec2f((float(i)+0.5f)/float(n),(float(j)+0.5f)/float(n)));
+        const Vec2f p = s.value;
+        inside &= p.x >= 0.0f && p.x < float(width) && p.y >= 0.0f && p.y < float(height);
+        const size_t x = min(size_t(p.x),width-1), y = min(size_t(p.y),height-1);
+        pdfs &= s.pdf > 0.0f && std::abs(s.pdf-table->pdf(x,y)) <= 1E-5f*s.pdf;
+        pdfs &= s.pdf == table->pdf(Vec2f(p.x/float(width),p.y/float(height)));
+        counts[y*width+x]++;
+      }
+    }
+    check(inside,"alias table samples lie inside the domain");
+    check(pdfs,"alias table samples report the density of their element");
+
+    double distance = 0.0;
+    for (size_t i=0; i<width*height; i++)
+      distance += std::abs(double(counts[i])/double(n*n) - data[i]/sum);
+    check(0.5*distance < 0.01,"alias table sample distribution matches the function");
+  }
+
+  /*! pixel of a direction in light space, computed with acos and atan2 */
+  static Vec2i referenceTexel(const Vector3f& wi, size_t width, size_t height, float& u, float& v)
+  {
+    float phi = atan2f(-wi.z,-wi.x);
+    if (phi < 0) phi += 2.0f*float(pi);
+    u = (1.0f - phi*float(one_over_two_pi))*float(width);
+    v = acosf(clamp(wi.y,-1.0f,1.0f))*float(one_over_pi)*float(height);
+    return Vec2i(int(clamp(ssize_t(u),ssize_t(0),ssize_t(width-1))),int(clamp(ssize_t(v),ssize_t(0),ssize_t(height-1))));
+  }
+
+  /*! exposes the pdf of a pixel */
+  class TestHDRILight : public HDRILight
+  {
+  public:
+    TestHDRILight (const Parms& parms) : HDRILight(parms) {}
+    float pdf(size_t x, size_t y) const { return distribution->pdf(x,y)*rcpSolidAngle[y]; }
+    using HDRILight::pdf;
+  };
+
+  static void testHDRILight()
+  {
+    const size_t width = 64, height = 32;
+    Ref<Image3f> image = new Image3f(width,height);
+    Random rng(17);
+    for (size_t y=0; y<height; y++)
+      for (size_t x=0; x<width; x++)
+        image->set(x,y,Color4(rng.getFloat(),rng.getFloat(),rng.getFloat(),1.0f));
+    Parms parms;
+    parms.add("image",Variant(Ref<Image>(image.ptr)));
+    Ref<TestHDRILight> light = new TestHDRILight(parms);
+    DifferentialGeometry dg;
+
+    /*! the pdf of a sampled direction matches the pdf of the sample */
+    const size_t n = 256;
+    size_t numMatches = 0;
+    for (size_t j=0; j<n; j++) {
+      for (size_t i=0; i<n; i++) {
+        Sample3f wi; float tMax;
+        light->sample(dg,wi,tMax,Vec2f((float(i)+0.5f)/float(n),(float(j)+0.5f)/float(n)));
+        numMatches += std::abs(light->pdf(dg,wi.value)-wi.pdf) <= 1E-5f*wi.pdf;
+      }
+    }
+    check(numMatches == n*n,"HDRI light pdf matches the pdf of its samples");
+
+    /*! pdf and Le of random directions match the mapping with acos and atan2 */
+    size_t numTexels = 0, numLe = 0;
+    double integral = 0.0;
+    for (size_t i=0; i<n*n; i++) {
+      const Vector3f wi = uniformSampleSphere(rng.getFloat(),rng.getFloat()).value;
+      float u, v; const Vec2i p = referenceTexel(wi,width,height,u,v);
+      const float pdf = light->pdf(dg,wi);
+      integral += pdf;
+
+      /*! directions close to a pixel boundary may round to either pixel */
+      const bool boundary = std::abs(u-floorf(u+0.5f)) < 1E-3f || std::abs(v-floorf(v+0.5f)) < 1E-3f;
+      numTexels += boundary || pdf == light->pdf(p.x,p.y);
+
+      const size_t x = p.x, xNext = (x+1)%width, y = p.y, yNext = min(y+1,height-1);
+      const float alpha = clamp(u-float(x),0.0f,1.0f), beta = clamp(v-float(y),0.0f,1.0f);
+      const Color c0 = image->get(x,y), c1 = image->get(xNext,y), c2 = image->get(xNext,yNext), c3 = image->get(x,yNext);
+      const Color Le = alpha*(beta*c2 + (1-beta)*c1) + (1-alpha)*(beta*c3 + (1-beta)*c0);
+      const Color d = light->Le(-wi) - Le;
+      numLe += boundary || max(abs(d.r),max(abs(d.g),abs(d.b))) < 1E-3f;
+    }
+    check(numTexels == n*n,"HDRI light pdf uses the pixel of the direction");
+    check(numLe == n*n,"HDRI light Le interpolates the pixels around the direction");
+    check(std::abs(integral/double(n*n)*4.0*double(pi)-1.0) < 0.01,"HDRI light pdf integrates to one");
+  }
+}
+
+int main(int argc, char** argv)
+{
+  embree::TaskScheduler::create(0);
+  embree::testAliasTable();
+  embree::testHDRILight();
+  embree::TaskScheduler::destroy();
+  return embree::testResult();
+}
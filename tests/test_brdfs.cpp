@@ -0,0 +1,203 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "test.h"
+#include "brdfs/compositedbrdf.h"
+#include "brdfs/lambertian.h"
+#include "brdfs/velvety.h"
+#include "lights/pointlight.h"
+#include "lights/trianglelight.h"
+#include "math/random.h"
+
+#include <cmath>
+
+namespace embree
+{
+  /*! Creates a triangle light from its vertices. */
+  static Ref<Light> triangleLight(const Vector3f& v0, const Vector3f& v1, const Vector3f& v2, const Color& L)
+  {
+    Parms parms;
+    parms.add("v0",Variant(v0.x,v0.y,v0.z));
+    parms.add("v1",Variant(v1.x,v1.y,v1.z));
+    parms.add("v2",Variant(v2.x,v2.y,v2.z));
+    parms.add("L",Variant(L.r,L.g,L.b));
+    return new TriangleLight(parms);
+  }
+
+  /*! Relative difference of two values. */
+  static float relError(const float a, const float b) {
+    return std::abs(a-b)*rcp(max(max(std::abs(a),std::abs(b)),1E-6f));
+  }
+
+  /*! Fills a packet with random sample locations and a mask that disables every third element. */
+  static simdb randomSamples(Random& rng, const size_t i, Vec2fN& s, simdf& ss)
+  {
+    simdi mask;
+    for (size_t k=0; k<SIMD_WIDTH; k++) {
+      s.x[k] = rng.getFloat(); s.y[k] = rng.getFloat(); ss[k] = rng.getFloat();
+      mask[k] = (i+k)%3 ? -1 : 0;
+    }
+    return mask != simdi(zero);
+  }
+
+  /*! Fills a packet with random directions on the sphere. */
+  static void randomDirections(Random& rng, Vector3fN& wi, Vector3f dirs[SIMD_WIDTH])
+  {
+    for (size_t k=0; k<SIMD_WIDTH; k++) {
+      dirs[k] = uniformSampleSphere(rng.getFloat(),rng.getFloat()).value;
+      setVector3f(wi,k,dirs[k]);
+    }
+  }
+
+  static void testPacketBRDFs()
+  {
+    DifferentialGeometry dg;
+    dg.P = Vector3f(zero);
+    dg.Ng = dg.Ns = normalize(Vector3f(0.2f,0.3f,1.0f));
+    const Vector3f wo = normalize(Vector3f(-0.4f,0.1f,0.8f));
+
+    const Lambertian lambertian(Color(0.7f,0.5f,0.3f));
+    const Velvety velvety(Color(0.2f,0.4f,0.6f),2.0f,GLOSSY_REFLECTION);
+    CompositedBRDF brdfs;
+    brdfs.add(&lambertian);
+    brdfs.add(&velvety);
+
+    /*! the packet versions match the scalar ones for active elements and are zero otherwise */
+    Random rng(17);
+    bool lambertianMatches = true, compositedMatches = true, filtered = true;
+    for (size_t i=0; i<1000; i++)
+    {
+      Vector3fN wi; Vector3f dirs[SIMD_WIDTH];
+      randomDirections(rng,wi,dirs);
+      simdi mask; for (size_t k=0; k<SIMD_WIDTH; k++) mask[k] = (i+k)%3 ? -1 : 0;
+      const simdb valid = mask != simdi(zero);
+
+      const ColorN c0 = lambertian.evalN(wo,dg,wi,valid);
+      const ColorN c1 = brdfs.evalN(wo,dg,wi,valid,ALL);
+      const ColorN c2 = brdfs.evalN(wo,dg,wi,valid,DIFFUSE_REFLECTION);
+      for (size_t k=0; k<SIMD_WIDTH; k++) {
+        const bool active = (i+k)%3 != 0;
+        const Color e0 = active ? lambertian.eval(wo,dg,dirs[k]) : Color(zero);
+        const Color e1 = active ? brdfs.eval(wo,dg,dirs[k],ALL) : Color(zero);
+        const Color e2 = active ? brdfs.eval(wo,dg,dirs[k],DIFFUSE_REFLECTION) : Color(zero);
+        lambertianMatches &= reduce_max(abs(getColor(c0,k)-e0)) <= 1E-6f;
+        compositedMatches &= reduce_max(abs(getColor(c1,k)-e1)) <= 1E-6f;
+        filtered          &= reduce_max(abs(getColor(c2,k)-e2)) <= 1E-6f;
+      }
+    }
+    check(lambertianMatches,"Lambertian::evalN matches eval");
+    check(compositedMatches,"CompositedBRDF::evalN matches eval");
+    check(filtered,"CompositedBRDF::evalN respects the BRDF type");
+
+    /*! the sampling density integrates to one over the sphere, and
+     *  the Lambertian reflects its albedo */
+    const size_t n = 512;
+    double pdfIntegral = 0.0; Color albedo(zero);
+    for (size_t j=0; j<n; j++) {
+      for (size_t i=0; i<n; i++) {
+        const Sample3f s = uniformSampleSphere((float(i)+0.5f)/float(n),(float(j)+0.5f)/float(n));
+        pdfIntegral += brdfs.pdf(wo,dg,s.value,ALL)/s.pdf;
+        albedo += lambertian.eval(wo,dg,s.value)*rcp(s.pdf);
+      }
+    }
+    pdfIntegral /= double(n*n);
+    albedo *= 1.0f/float(n*n);
+    check(std::abs(pdfIntegral-1.0) < 1E-3,"CompositedBRDF::pdf integrates to one");
+    check(reduce_max(abs(albedo-Color(0.7f,0.5f,0.3f))) < 1E-3f,"Lambertian reflects its albedo");
+  }
+
+  static void testPacketSampling()
+  {
+    DifferentialGeometry dg;
+    dg.P = Vector3f(0.1f,-0.2f,0.3f);
+    dg.Ng = dg.Ns = normalize(Vector3f(0.2f,0.3f,1.0f));
+    const Vector3f wo = normalize(Vector3f(-0.4f,0.1f,0.8f));
+
+    const Lambertian lambertian(Color(0.7f,0.5f,0.3f));
+    const Velvety velvety(Color(0.2f,0.4f,0.6f),2.0f,GLOSSY_REFLECTION);
+    CompositedBRDF brdfs;
+    brdfs.add(&lambertian);
+    brdfs.add(&velvety);
+
+    Parms parms;
+    parms.add("P",Variant(1.0f,2.0f,3.0f));
+    parms.add("I",Variant(4.0f,5.0f,6.0f));
+    const Ref<Light> point = new PointLight(parms);
+    const Ref<Light> triangle = triangleLight(Vector3f(-1.0f,-1.0f,2.0f),Vector3f(1.0f,-1.0f,2.0f),Vector3f(0.0f,1.0f,2.0f),Color(1.0f,2.0f,3.0f));
+    const Ref<Light> backside = triangleLight(Vector3f(-1.0f,-1.0f,2.0f),Vector3f(0.0f,1.0f,2.0f),Vector3f(1.0f,-1.0f,2.0f),Color(1.0f,2.0f,3.0f));
+
+    /*! the packet versions sample the same directions as the scalar
+     *  ones for active elements and return zero otherwise */
+    Random rng(23);
+    bool brdfMatches = true, compositedMatches = true, pointMatches = true, triangleMatches = true, backsideMatches = true;
+    for (size_t i=0; i<1000; i++)
+    {
+      Vec2fN s; simdf ss;
+      const simdb valid = randomSamples(rng,i,s,ss);
+
+      Vector3fN wi0, wi1; simdf pdf0, pdf1; BRDFType types[SIMD_WIDTH];
+      const ColorN c0 = velvety.sampleN(wo,dg,wi0,pdf0,s,valid);
+      const ColorN c1 = brdfs.sampleN(wo,dg,wi1,pdf1,types,s,ss,valid,ALL);
+
+      Vector3fN wl0, wl1, wl2; simdf lpdf0, lpdf1, lpdf2, tMax0, tMax1, tMax2;
+      const ColorN L0 = point->sampleN(dg,wl0,lpdf0,tMax0,s,valid);
+      const ColorN L1 = triangle->sampleN(dg,wl1,lpdf1,tMax1,s,valid);
+      const ColorN L2 = backside->sampleN(dg,wl2,lpdf2,tMax2,s,valid);
+
+      for (size_t k=0; k<SIMD_WIDTH; k++)
+      {
+        const Vec2f sk(s.x[k],s.y[k]);
+        if ((i+k)%3 == 0) {
+          brdfMatches       &= getColor(c0,k) == Color(zero) && pdf0[k] == 0.0f;
+          compositedMatches &= getColor(c1,k) == Color(zero) && pdf1[k] == 0.0f && types[k] == 0;
+          pointMatches      &= getColor(L0,k) == Color(zero) && lpdf0[k] == 0.0f;
+          triangleMatches   &= getColor(L1,k) == Color(zero) && lpdf1[k] == 0.0f;
+          continue;
+        }
+
+        Sample3f w0; const Color e0 = velvety.sample(wo,dg,w0,sk);
+        brdfMatches &= reduce_max(abs(getColor(c0,k)-e0)) <= 1E-5f && length(getVector3f(wi0,k)-w0.value) <= 1E-5f && relError(pdf0[k],w0.pdf) <= 1E-5f;
+
+        Sample3f w1; BRDFType t1; const Color e1 = brdfs.sample(wo,dg,w1,t1,sk,ss[k],ALL);
+        compositedMatches &= reduce_max(abs(getColor(c1,k)-e1)) <= 1E-5f && length(getVector3f(wi1,k)-w1.value) <= 1E-5f
+          && relError(pdf1[k],w1.pdf) <= 1E-5f && types[k] == t1;
+
+        Sample3f l0; float t0; const Color f0 = point->sample(dg,l0,t0,sk);
+        pointMatches &= getColor(L0,k) == f0 && length(getVector3f(wl0,k)-l0.value) <= 1E-6f && lpdf0[k] == l0.pdf && tMax0[k] == t0;
+
+        Sample3f l1; float tl1; const Color f1 = triangle->sample(dg,l1,tl1,sk);
+        triangleMatches &= getColor(L1,k) == f1 && length(getVector3f(wl1,k)-l1.value) <= 1E-5f
+          && relError(lpdf1[k],l1.pdf) <= 1E-4f && relError(tMax1[k],tl1) <= 1E-5f;
+
+        Sample3f l2; float tl2; const Color f2 = backside->sample(dg,l2,tl2,sk);
+        backsideMatches &= f2 == Color(zero) && getColor(L2,k) == Color(zero) && lpdf2[k] == 0.0f;
+      }
+    }
+    check(brdfMatches,"BRDF::sampleN matches sample");
+    check(compositedMatches,"CompositedBRDF::sampleN matches sample");
+    check(pointMatches,"Light::sampleN matches sample");
+    check(triangleMatches,"TriangleLight::sampleN matches sample");
+    check(backsideMatches,"TriangleLight::sampleN is zero from the back");
+  }
+}
+
+
+int main(int argc, char** argv)
+{
+  embree::testPacketBRDFs();
+  embree::testPacketSampling();
+  return embree::testResult();
+}
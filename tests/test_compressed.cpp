@@ -0,0 +1,126 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "test.h"
+#include "math/vec3.h"
+#include "image/compressed.h"
+
+#include <cmath>
+
+namespace embree
+{
+  /*! Largest absolute difference of two colors including alpha. */
+  static float maxError(const Color4& a, const Color4& b) {
+    return max(max(std::abs(a.r-b.r),std::abs(a.g-b.g)),max(std::abs(a.b-b.b),std::abs(a.a-b.a)));
+  }
+
+  static void testBC1()
+  {
+    /*! texels on the palette of two RGB565 endpoints are encoded without error */
+    const Vec3f e0(31.0f/31.0f,20.0f/63.0f,4.0f/31.0f), e1(2.0f/31.0f,50.0f/63.0f,29.0f/31.0f);
+    Color4 texels[16];
+    for (size_t i=0; i<16; i++) {
+      const float t = float(i%4)/3.0f;
+      const Vec3f c = (1.0f-t)*e0 + t*e1;
+      texels[i] = Color4(c.x,c.y,c.z,1.0f);
+    }
+    BlockBC1 block; block.encode(texels);
+    float err = 0.0f;
+    for (size_t i=0; i<16; i++) err = max(err,maxError(block.decode(i),texels[i]));
+    check(err < 1E-5f,"BC1 encodes palette colors exactly");
+
+    /*! a constant block only suffers from RGB565 quantization */
+    for (size_t i=0; i<16; i++) texels[i] = Color4(0.3f,0.6f,0.9f,1.0f);
+    block.encode(texels);
+    err = 0.0f;
+    for (size_t i=0; i<16; i++) err = max(err,maxError(block.decode(i),texels[i]));
+    check(err <= 0.5f/31.0f+1E-6f,"BC1 constant block");
+  }
+
+  static void testBC3()
+  {
+    /*! alpha values on the 8 value palette between the endpoints are encoded exactly */
+    Color4 texels[16];
+    for (size_t i=0; i<16; i++) {
+      const float a = float(i%8)/7.0f;
+      texels[i] = Color4(0.5f,0.5f,0.5f,a);
+    }
+    BlockBC3 block; block.encode(texels);
+    float err = 0.0f;
+    for (size_t i=0; i<16; i++) err = max(err,std::abs(block.decode(i).a-texels[i].a));
+    check(err < 1E-5f,"BC3 encodes palette alpha values exactly");
+
+    /*! constant alpha uses a single value */
+    for (size_t i=0; i<16; i++) texels[i].a = 0.25f;
+    block.encode(texels);
+    err = 0.0f;
+    for (size_t i=0; i<16; i++) err = max(err,std::abs(block.decode(i).a-texels[i].a));
+    check(err <= 0.5f/255.0f+1E-6f,"BC3 constant alpha");
+  }
+
+  static void testBCH()
+  {
+    /*! HDR gradients keep a relative error in the order of the 9 bit mantissas and 16 steps */
+    Color4 texels[16];
+    for (size_t i=0; i<16; i++) {
+      const float t = float(i)/15.0f;
+      texels[i] = Color4(100.0f*(1.0f-t)+0.5f*t,20.0f,3.0f*t,1.0f);
+    }
+    BlockBCH block; block.encode(texels);
+    float err = 0.0f;
+    for (size_t i=0; i<16; i++) err = max(err,maxError(block.decode(i),texels[i]));
+    check(err <= 100.0f/256.0f,"BCH gradient");
+
+    /*! colors above 1 are kept */
+    for (size_t i=0; i<16; i++) texels[i] = Color4(1000.0f,1.0f,0.0f,1.0f);
+    block.encode(texels);
+    err = 0.0f;
+    for (size_t i=0; i<16; i++) err = max(err,maxError(block.decode(i),texels[i]));
+    check(err <= 1000.0f/512.0f,"BCH constant HDR block");
+  }
+
+  static void testCompressedImage()
+  {
+    /*! compressing a gradient of odd size reproduces it closely, including the border blocks */
+    const size_t width = 13, height = 7;
+    Ref<Image> image = new Image4c(width,height);
+    for (size_t y=0; y<height; y++)
+      for (size_t x=0; x<width; x++)
+        image->set(x,y,Color4(float(x)/float(width),1.0f-float(x)/float(width),0.5f,1.0f));
+
+    Ref<Image> compressed = compressImage(image);
+    check(dynamic_cast<ImageBC1*>(compressed.ptr) != NULL,"opaque 8 bit images compress to BC1");
+    float err = 0.0f;
+    for (size_t y=0; y<height; y++)
+      for (size_t x=0; x<width; x++)
+        err = max(err,maxError(compressed->get(x,y),image->get(x,y)));
+    check(err < 0.05f,"BC1 image round trip");
+
+    image->set(3,3,Color4(0.0f,0.0f,0.0f,0.5f));
+    compressed = compressImage(image);
+    check(dynamic_cast<ImageBC3*>(compressed.ptr) != NULL,"8 bit images with alpha compress to BC3");
+    check(std::abs(compressed->get(3,3).a-0.5f) < 1.0f/255.0f,"BC3 image keeps alpha");
+  }
+}
+
+int main(int argc, char** argv)
+{
+  embree::testBC1();
+  embree::testBC3();
+  embree::testBCH();
+  embree::testCompressedImage();
+  return embree::testResult();
+}
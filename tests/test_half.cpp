@@ -0,0 +1,74 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "test.h"
+#include "math/half.h"
+#include "math/random.h"
+
+#include <cmath>
+
+namespace embree
+{
+  static void testHalf()
+  {
+    /*! every half except NaNs survives the round trip through float */
+    bool roundTrip = true, nan = true;
+    for (size_t i=0; i<65536; i++) {
+      const half h = (half) i;
+      const float f = half_to_float(h);
+      if ((h & 0x7c00) == 0x7c00 && (h & 0x3ff)) nan &= f != f;
+      else roundTrip &= float_to_half(f) == h;
+    }
+    check(roundTrip,"half -> float -> half round trip");
+    check(nan,"half NaNs convert to float NaNs");
+
+    /*! known values, including rounding to nearest even and overflow */
+    check(float_to_half(1.0f) == 0x3c00,"float_to_half(1)");
+    check(float_to_half(-2.0f) == 0xc000,"float_to_half(-2)");
+    check(float_to_half(65504.0f) == 0x7bff,"float_to_half(max half)");
+    check(float_to_half(1E6f) == 0x7c00,"float_to_half overflows to infinity");
+    check(float_to_half(1.0f+1.0f/2048.0f) == 0x3c00,"float_to_half ties round to even");
+    check(float_to_half(1.0f+3.0f/2048.0f) == 0x3c02,"float_to_half ties round to even (odd)");
+    check(half_to_float(0x0001) == ldexpf(1.0f,-24),"half_to_float(smallest denormal)");
+
+    /*! floats in the normal half range are rounded with a relative error of at most 2^-11 */
+    Random rng(7);
+    bool relative = true;
+    for (size_t i=0; i<100000; i++) {
+      const float f = ldexpf(rng.getFloat()+1.0f,int(rng.getInt(30))-14) * (rng.getInt(2) ? 1.0f : -1.0f);
+      if (std::abs(f) > 65504.0f) continue;
+      relative &= std::abs(half_to_float(float_to_half(f))-f) <= ldexpf(std::abs(f),-11);
+    }
+    check(relative,"float -> half rounding error");
+
+    /*! the 4 wide versions match the scalar ones */
+    bool wide = true;
+    for (size_t i=0; i<1000; i++) {
+      float in[4], out[4]; half h[4];
+      for (size_t k=0; k<4; k++) in[k] = 100.0f*(rng.getFloat()-0.5f);
+      float4_to_half4(in,h);
+      half4_to_float4(h,out);
+      for (size_t k=0; k<4; k++) wide &= h[k] == float_to_half(in[k]) && out[k] == half_to_float(h[k]);
+    }
+    check(wide,"float4_to_half4/half4_to_float4 match the scalar conversions");
+  }
+}
+
+int main(int argc, char** argv)
+{
+  embree::testHalf();
+  return embree::testResult();
+}
@@ -0,0 +1,100 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "test.h"
+#include "math/random.h"
+#include "samplers/sampler.h"
+
+#include <cmath>
+
+namespace embree
+{
+  /*! the SIMD versions of randomHash hash each lane like the scalar one */
+  static void testRandomHash()
+  {
+    bool sse = true;
+    for (uint32 i=0; i<4096; i+=4) {
+      const ssei a(int32(i)+0,int32(i)+1,int32(i)+2,int32(i)+3), b(int32(7*i)), c(int32(i ^ 0xdeadbeefu));
+      const ssei h = randomHash(a,b,c);
+      for (size_t k=0; k<4; k++)
+        sse &= uint32(h[k]) == randomHash(uint32(i+k),uint32(7*i),uint32(i ^ 0xdeadbeefu));
+    }
+    check(sse,"SSE randomHash matches scalar randomHash");
+
+#if defined(__AVX__)
+    bool avx = true;
+    for (uint32 i=0; i<4096; i+=8) {
+      const avxi a = avxi(int32(i)) + avxi(step), b(int32(7*i)), c(int32(i ^ 0xdeadbeefu));
+      const avxi h = randomHash(a,b,c);
+      for (size_t k=0; k<8; k++)
+        avx &= uint32(h[k]) == randomHash(uint32(i+k),uint32(7*i),uint32(i ^ 0xdeadbeefu));
+    }
+    check(avx,"AVX randomHash matches scalar randomHash");
+#endif
+  }
+
+  /*! the sampler generates the additional samples SIMD_WIDTH at a
+   *  time, each has to be the scalar hash of its key and dimension */
+  static void testSampleDimensions()
+  {
+    Ref<SamplerFactory> factory = new SamplerFactory(1,1);
+    const int dim1D = factory->request1D(13);
+    const int dim2D = factory->request2D(7);
+
+    std::vector<float> samples1D(factory->numSamples1D);
+    std::vector<Vec2f> samples2D(factory->numSamples2D);
+    PrecomputedSample sample;
+    sample.samples1D = &samples1D[0];
+    sample.samples2D = &samples2D[0];
+
+    bool match = true, range = true;
+    double sum = 0.0; size_t num = 0;
+    for (int y=0; y<16; y++) {
+      for (int x=0; x<16; x++) {
+        for (int s=0; s<4; s++) {
+          const uint32 key = sampleKey(Vec2i(x,y),s);
+          factory->generate(sample,key);
+          for (int d=0; d<13; d++) {
+            const float f = sample.getFloat(dim1D+d);
+            match &= f == sampleDimension(key,uint32(d));
+            range &= f >= 0.0f && f < 1.0f;
+            sum += f; num++;
+          }
+          for (int d=0; d<7; d++) {
+            const Vec2f f = sample.getVec2f(dim2D+d);
+            match &= f.x == sampleDimension(key,SAMPLE_DIM_2D+2*d+0);
+            match &= f.y == sampleDimension(key,SAMPLE_DIM_2D+2*d+1);
+            range &= f.x >= 0.0f && f.x < 1.0f && f.y >= 0.0f && f.y < 1.0f;
+            sum += f.x + f.y; num += 2;
+          }
+        }
+      }
+    }
+    check(match,"generated samples match the scalar sampleDimension");
+    check(range,"generated samples are in [0,1)");
+    check(std::abs(sum/double(num)-0.5) < 0.01,"generated samples have mean 1/2");
+
+    /*! different pixels and samples get different keys */
+    check(sampleKey(Vec2i(1,0),0) != sampleKey(Vec2i(0,1),0) && sampleKey(Vec2i(0,0),1) != sampleKey(Vec2i(0,0),0),"sample keys differ");
+  }
+}
+
+int main(int argc, char** argv)
+{
+  embree::testRandomHash();
+  embree::testSampleDimensions();
+  return embree::testResult();
+}
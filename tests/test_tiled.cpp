@@ -0,0 +1,151 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "test.h"
+#include "image/image.h"
+#include "image/tiled.h"
+#include "math/random.h"
+#include "sys/thread.h"
+
+#include <cmath>
+
+namespace embree
+{
+  /*! largest difference of the texels of two images */
+  static float maxDifference(const Ref<Image>& a, const Ref<Image>& b)
+  {
+    if (a->width != b->width || a->height != b->height) return 1E10f;
+    float d = 0.0f;
+    for (size_t y=0; y<a->height; y++) {
+      for (size_t x=0; x<a->width; x++) {
+        const Color4 ca = a->get(x,y), cb = b->get(x,y);
+        d = max(d,std::abs(ca.r-cb.r),std::abs(ca.g-cb.g));
+        d = max(d,std::abs(ca.b-cb.b),std::abs(ca.a-cb.a));
+      }
+    }
+    return d;
+  }
+
+  /*! next level of a mip pyramid computed in memory */
+  static Ref<Image> downsample(const Ref<Image>& src)
+  {
+    const size_t width = max(src->width/2,size_t(1)), height = max(src->height/2,size_t(1));
+    Ref<Image> dst = new Image4f(width,height,src->name);
+    for (size_t y=0; y<height; y++) {
+      const size_t y0 = min(2*y,src->height-1), y1 = min(2*y+1,src->height-1);
+      for (size_t x=0; x<width; x++) {
+        const size_t x0 = min(2*x,src->width-1), x1 = min(2*x+1,src->width-1);
+        const Color4 c00 = src->get(x0,y0), c01 = src->get(x1,y0);
+        const Color4 c10 = src->get(x0,y1), c11 = src->get(x1,y1);
+        dst->set(x,y,Color4(0.25f*(c00.r+c01.r+c10.r+c11.r),0.25f*(c00.g+c01.g+c10.g+c11.g),
+                            0.25f*(c00.b+c01.b+c10.b+c11.b),0.25f*(c00.a+c01.a+c10.a+c11.a)));
+      }
+    }
+    return dst;
+  }
+
+  static void testPagedPFM()
+  {
+    Random rng(5);
+    Ref<Image> img = new Image3f(200,131,"test");
+    for (size_t y=0; y<img->height; y++)
+      for (size_t x=0; x<img->width; x++)
+        img->set(x,y,Color4(4.0f*rng.getFloat(),rng.getFloat(),rng.getFloat(),1.0f));
+    storePFM(img,"test_tiled.pfm");
+
+    /*! texels paged from the rows of the file match the loaded file */
+    Ref<Image> paged = loadTiled("test_tiled.pfm");
+    check(dynamic_cast<TiledImage*>(paged.ptr) && ((TiledImage*)paged.ptr)->numLevels() == 1,"PFM is paged with a single level");
+    check(maxDifference(paged,loadPFM("test_tiled.pfm")) == 0.0f,"paged PFM texels");
+
+    /*! the levels streamed to the tiled file match a pyramid computed in memory */
+    storeTiled(paged,"test_tiled.tiled");
+    Ref<Image> tiled = loadTiled("test_tiled.tiled");
+    TiledImage* pyramid = (TiledImage*) tiled.ptr;
+    check(pyramid->hdr() && pyramid->numLevels() == 8,"PFM pyramid levels");
+    Ref<Image> level = img;
+    bool levels = true;
+    for (size_t l=0; l<pyramid->numLevels(); l++) {
+      levels &= maxDifference(pyramid->getLevel(l),level) < 1E-5f;
+      level = downsample(level);
+    }
+    check(levels,"streamed pyramid levels");
+
+    paged = null; tiled = null;
+    remove("test_tiled.pfm");
+    remove("test_tiled.tiled");
+  }
+
+  static void testPagedPPM()
+  {
+    Random rng(9);
+    Ref<Image> img = new Image4c(77,300,"test");
+    for (size_t y=0; y<img->height; y++)
+      for (size_t x=0; x<img->width; x++)
+        img->set(x,y,Color4(rng.getFloat(),rng.getFloat(),rng.getFloat(),1.0f));
+    storePPM(img,"test_tiled.ppm");
+
+    Ref<Image> paged = loadTiled("test_tiled.ppm");
+    check(!((TiledImage*)paged.ptr)->hdr(),"PPM is paged with 8 bit texels");
+    check(maxDifference(paged,loadPPM("test_tiled.ppm")) == 0.0f,"paged PPM texels");
+
+    paged = null;
+    remove("test_tiled.ppm");
+  }
+
+  struct PinnedThread
+  {
+    Ref<Image> image;
+    size_t pinned;
+  };
+
+  static void readTexels(void* ptr)
+  {
+    PinnedThread* t = (PinnedThread*) ptr;
+    for (size_t y=0; y<t->image->height; y+=16)
+      for (size_t x=0; x<t->image->width; x+=16)
+        t->image->get(x,y);
+    t->pinned = TileCache::instance().pinnedBytes();
+  }
+
+  static void testPinnedTiles()
+  {
+    Ref<Image> img = new Image3f(512,512,"test");
+    for (size_t y=0; y<img->height; y++)
+      for (size_t x=0; x<img->width; x++)
+        img->set(x,y,Color4(float(x),float(y),0.0f,1.0f));
+    storePFM(img,"test_tiled.pfm");
+
+    /*! the tiles a thread keeps are pinned in the cache until the thread exits */
+    const size_t pinned = TileCache::instance().pinnedBytes();
+    PinnedThread t; t.image = loadTiled("test_tiled.pfm"); t.pinned = 0;
+    thread_t thread = createThread(readTexels,&t);
+    join(thread);
+    check(t.pinned == pinned+16*64*64*sizeof(Col4f),"thread pins its last tiles");
+    check(TileCache::instance().pinnedBytes() == pinned,"tiles are released at thread exit");
+
+    t.image = null;
+    remove("test_tiled.pfm");
+  }
+}
+
+int main()
+{
+  embree::testPagedPFM();
+  embree::testPagedPPM();
+  embree::testPinnedTiles();
+  return embree::testResult();
+}
@@ -0,0 +1,50 @@
+// ======================================================================== //
+// Copyright 2009-2013 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "image/image.h"
+#include "sys/stl/string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+
+/*! Converts an image to a tiled mip pyramid. The renderer pages the
+ *  tiles of <image>.tiled in on demand instead of loading <image>.
+ *  Uncompressed PFM and PPM files are converted tile by tile, other
+ *  formats are loaded completely. */
+int main(int argc, char **argv)
+{
+  /*! all file names must be specified on the command line */
+  if (argc != 3) printf("  USAGE:  imgtile <infile> <outfile.tiled>\n"), exit(1);
+
+  try {
+    const embree::FileName inFile = argv[1];
+    const std::string ext = std::strlwr(inFile.ext());
+    embree::Ref<embree::Image> image;
+    if (ext == "pfm" || ext == "ppm" || ext == "tiled") {
+      try { image = embree::loadTiled(inFile); }
+      catch (const std::exception&) { image = embree::loadImage(inFile); }
+    }
+    else image = embree::loadImage(inFile);
+    if (!image) return 1;
+    embree::storeTiled(image,argv[2]);
+  }
+  catch (const std::exception& e) {
+    std::cout << "cannot convert " << argv[1] << ": " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}